@@ -1,4 +1,4 @@
-QT += quick core qml widgets core-private quickcontrols2 multimedia
+QT += quick core qml widgets core-private quickcontrols2 multimedia network websockets
 
 android:{
     QT += core-private
@@ -24,19 +24,58 @@ SOURCES += \
         main.cpp \
         qmlapp.cpp \
         tunerengine.cpp \
+        config/autoconfig.cpp \
+        audio/capturefile.cpp \
+        audio/capturereplay.cpp \
+        audio/audioinputsink.cpp \
+        audio/samplering.cpp \
+        audio/syntheticsource.cpp \
+        audio/tonegenerator.cpp \
+        net/resultrecord.cpp \
+        net/resultserver.cpp \
+        net/resultclient.cpp \
+        session/sessionlog.cpp \
+        ui/spectrumitem.cpp \
         tools/crashReportTool.cpp \
         tools/appinfo.cpp \
+        tools/startupProfile.cpp \
+        tools/latencyHistogram.cpp \
         test/suite.cpp \
         testMain.cpp \
 
 HEADERS += \
         qmlapp.h \
         tunerengine.h \
+        config/autoconfig.h \
+        audio/capturefile.h \
+        audio/capturereplay.h \
+        audio/audioinputsink.h \
+        audio/samplering.h \
+        audio/syntheticsource.h \
+        audio/tonegenerator.h \
+        net/resultrecord.h \
+        net/resultserver.h \
+        net/resultclient.h \
+        session/sessionlog.h \
+        ui/spectrumitem.h \
         tools/debug_Info.h \
         tools/crashReportTool.h \
         tools/appinfo.h \
+        tools/startupProfile.h \
+        tools/latencyHistogram.h \
         test/suite.hpp \
 
+include(dsp/dsp.pri)
+
+# qmake CONFIG+=testing builds the QtTest suite in place of the app, make check runs it
+testing {
+    QT += testlib
+    CONFIG += testcase
+    DEFINES += TESTING
+    SOURCES -= main.cpp
+    include(test/test.pri)
+}
+
 RESOURCES += qml.qrc \
 
 # Additional import path used to resolve QML modules in Qt Creator's code model
@@ -0,0 +1,20 @@
+#include "audioinputsink.h"
+#include "../tunerengine.h"
+
+AudioInputSink::AudioInputSink(TunerEngine *engine, QObject *parent)
+    : QIODevice(parent)
+    , m_engine(engine)
+{
+}
+
+qint64 AudioInputSink::readData(char *, qint64)
+{
+    return -1;
+}
+
+qint64 AudioInputSink::writeData(const char *data, qint64 size)
+{
+    // The source is opened for mono int16, backends write whole frames
+    m_engine->ingestDeviceAudio(data, size);
+    return size;
+}
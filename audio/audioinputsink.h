@@ -0,0 +1,29 @@
+#ifndef AUDIOINPUTSINK_H
+#define AUDIOINPUTSINK_H
+
+#include <QIODevice>
+
+class TunerEngine;
+
+// Push-mode target for QAudioSource::start(QIODevice*): the backend writes
+// each period here and it goes straight into the engine's sample ring, the
+// only copy between the driver buffer and the analysis. Nothing is buffered
+// in the device itself and nothing can be read back.
+class AudioInputSink : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit AudioInputSink(TunerEngine *engine, QObject *parent = nullptr);
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 size) override;
+
+private:
+    TunerEngine *m_engine;
+};
+
+#endif // AUDIOINPUTSINK_H
@@ -0,0 +1,142 @@
+#include "capturefile.h"
+#include <QDebug>
+
+namespace {
+constexpr quint32 CAPTURE_MAGIC = 0x50435443; // "CTCP"
+constexpr quint16 CAPTURE_VERSION = 1;
+}
+
+bool CaptureWriter::open(const QString &path)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Cannot open capture file" << path << m_file.errorString();
+        return false;
+    }
+    m_stream.setDevice(&m_file);
+    m_stream.setByteOrder(QDataStream::LittleEndian);
+    m_stream.setVersion(QDataStream::Qt_6_0);
+    m_stream << CAPTURE_MAGIC << CAPTURE_VERSION;
+    return true;
+}
+
+void CaptureWriter::close()
+{
+    if (m_file.isOpen()) {
+        m_stream.setDevice(nullptr);
+        m_file.close();
+    }
+}
+
+void CaptureWriter::writeAudio(qint64 arrivalUSecs, const QByteArray &chunk)
+{
+    writeRecord(CaptureRecord::Audio, arrivalUSecs, chunk);
+}
+
+void CaptureWriter::writeSettings(qint64 arrivalUSecs, const CaptureSettings &settings)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << qint32(settings.sampleRate) << qint32(settings.bufferSize) << qint32(settings.fftPadding)
+        << settings.detectionMethod << settings.dbThreshold << settings.adaptiveWindow
+        << qint32(settings.maxPeaks) << settings.referenceA
+        << settings.temperament << qint32(settings.temperamentRoot) << settings.customCents
+        << settings.strobeMode << settings.powerSave << settings.idleDelay
+        << settings.instrument << qint32(settings.targetString)
+        << settings.fixedPoint
+        << settings.backlogPolicy;
+    writeRecord(CaptureRecord::Settings, arrivalUSecs, payload);
+}
+
+void CaptureWriter::writeRecord(CaptureRecord::Type type, qint64 arrivalUSecs, const QByteArray &payload)
+{
+    if (!m_file.isOpen()) return;
+    m_stream << quint8(type) << arrivalUSecs << quint32(payload.size());
+    m_stream.writeRawData(payload.constData(), payload.size());
+}
+
+bool CaptureReader::open(const QString &path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot open capture file" << path << m_file.errorString();
+        return false;
+    }
+    m_stream.setDevice(&m_file);
+    m_stream.setByteOrder(QDataStream::LittleEndian);
+    m_stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    m_stream >> magic >> version;
+    if (magic != CAPTURE_MAGIC || version != CAPTURE_VERSION) {
+        qWarning() << "Not a supported capture file:" << path;
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool CaptureReader::readNext(CaptureRecord &record)
+{
+    if (!m_file.isOpen() || m_stream.atEnd()) return false;
+
+    quint8 type = 0;
+    quint32 length = 0;
+    m_stream >> type >> record.arrivalUSecs >> length;
+    if (m_stream.status() != QDataStream::Ok) return false;
+
+    QByteArray payload(length, Qt::Uninitialized);
+    if (m_stream.readRawData(payload.data(), length) != static_cast<int>(length)) {
+        return false;
+    }
+
+    if (type == CaptureRecord::Audio) {
+        record.type = CaptureRecord::Audio;
+        record.audio = payload;
+        return true;
+    }
+    if (type != CaptureRecord::Settings) {
+        // Unknown record from a newer writer, skip it
+        return readNext(record);
+    }
+
+    record.type = CaptureRecord::Settings;
+
+    QDataStream in(payload);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setVersion(QDataStream::Qt_6_0);
+    qint32 sampleRate, bufferSize, fftPadding, maxPeaks;
+    CaptureSettings &settings = record.settings;
+    in >> sampleRate >> bufferSize >> fftPadding >> settings.detectionMethod
+       >> settings.dbThreshold >> settings.adaptiveWindow >> maxPeaks >> settings.referenceA;
+    settings.sampleRate = sampleRate;
+    settings.bufferSize = bufferSize;
+    settings.fftPadding = fftPadding;
+    settings.maxPeaks = maxPeaks;
+
+    // Fields appended after the first release of the format
+    if (!in.atEnd()) {
+        qint32 temperamentRoot;
+        in >> settings.temperament >> temperamentRoot >> settings.customCents;
+        settings.temperamentRoot = temperamentRoot;
+    }
+    if (!in.atEnd()) {
+        in >> settings.strobeMode >> settings.powerSave >> settings.idleDelay;
+    }
+    if (!in.atEnd()) {
+        qint32 targetString;
+        in >> settings.instrument >> targetString;
+        settings.targetString = targetString;
+    }
+    if (!in.atEnd()) {
+        in >> settings.fixedPoint;
+    }
+    if (!in.atEnd()) {
+        in >> settings.backlogPolicy;
+    }
+    return in.status() == QDataStream::Ok;
+}
@@ -0,0 +1,81 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+// Raw input capture format (little endian):
+//   header : magic "CTCP", quint16 version
+//   records: quint8 type, qint64 arrival time (us, monotonic), quint32 length, payload
+// Audio records hold the exact int16 bytes processAudioInput received,
+// settings records hold the analysis settings active from that point on.
+
+struct CaptureSettings {
+    int sampleRate = 0;
+    int bufferSize = 0;
+    int fftPadding = 0;
+    QString detectionMethod;
+    double dbThreshold = 0.0;
+    bool adaptiveWindow = false;
+    int maxPeaks = 0;
+    double referenceA = 0.0;
+    QString temperament = "Equal";
+    int temperamentRoot = 9;
+    QList<double> customCents;
+    bool strobeMode = false;
+    bool powerSave = true;
+    double idleDelay = 10.0;
+    QString instrument = "Cello";
+    int targetString = -1;
+    bool fixedPoint = false;
+    QString backlogPolicy = "Process all";
+};
+
+struct CaptureRecord {
+    enum Type : quint8 {
+        Audio = 1,
+        Settings = 2
+    };
+
+    Type type = Audio;
+    qint64 arrivalUSecs = 0;
+    QByteArray audio;
+    CaptureSettings settings;
+};
+
+class CaptureWriter
+{
+public:
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString path() const { return m_file.fileName(); }
+
+    void writeAudio(qint64 arrivalUSecs, const QByteArray &chunk);
+    void writeSettings(qint64 arrivalUSecs, const CaptureSettings &settings);
+
+private:
+    void writeRecord(CaptureRecord::Type type, qint64 arrivalUSecs, const QByteArray &payload);
+
+    QFile m_file;
+    QDataStream m_stream;
+};
+
+class CaptureReader
+{
+public:
+    bool open(const QString &path);
+    void close() { m_file.close(); }
+
+    // Returns false at end of file or on a truncated record
+    bool readNext(CaptureRecord &record);
+
+private:
+    QFile m_file;
+    QDataStream m_stream;
+};
+
+#endif // CAPTUREFILE_H
@@ -0,0 +1,123 @@
+#include "capturereplay.h"
+#include "../tunerengine.h"
+#include <QDebug>
+#include <QTimer>
+#include <algorithm>
+
+CaptureReplay::CaptureReplay(QObject *parent)
+    : QObject(parent)
+{
+}
+
+bool CaptureReplay::open(const QString &path)
+{
+    if (!m_reader.open(path)) return false;
+    m_hasPending = m_reader.readNext(m_pending);
+    return true;
+}
+
+void CaptureReplay::start(TunerEngine *engine, Mode mode)
+{
+    m_engine = engine;
+    m_mode = mode;
+    m_digest.reset();
+    m_chunkCount = 0;
+    m_resultCount = 0;
+
+    // The engine must not pull from a live device while replaying
+    m_engine->stop();
+    connect(m_engine, &TunerEngine::noteDetected, this, &CaptureReplay::recordResult);
+    connect(m_engine, qOverload<double>(&TunerEngine::signalLevel), this, &CaptureReplay::recordLevel);
+
+    m_timer.start();
+    QTimer::singleShot(0, this, &CaptureReplay::replayNext);
+}
+
+void CaptureReplay::replayNext()
+{
+    if (m_mode == AsFastAsPossible) {
+        while (m_hasPending) {
+            feed(m_pending);
+            m_hasPending = m_reader.readNext(m_pending);
+        }
+        finish();
+        return;
+    }
+
+    if (!m_hasPending) {
+        finish();
+        return;
+    }
+
+    CaptureRecord current = m_pending;
+    feed(current);
+    m_hasPending = m_reader.readNext(m_pending);
+    if (!m_hasPending) {
+        finish();
+        return;
+    }
+
+    // Keep the original spacing between readyRead arrivals
+    qint64 delayMs = std::max<qint64>(0, (m_pending.arrivalUSecs - current.arrivalUSecs) / 1000);
+    QTimer::singleShot(static_cast<int>(delayMs), Qt::PreciseTimer, this, &CaptureReplay::replayNext);
+}
+
+bool CaptureReplay::feed(const CaptureRecord &record)
+{
+    if (record.type == CaptureRecord::Settings) {
+        applySettings(record.settings);
+        return true;
+    }
+    ++m_chunkCount;
+    m_engine->ingestAudio(record.audio, record.arrivalUSecs);
+    return true;
+}
+
+void CaptureReplay::finish()
+{
+    disconnect(m_engine, nullptr, this, nullptr);
+    m_reader.close();
+    qint64 elapsedMs = m_timer.elapsed();
+    qDebug() << "Replay finished:" << m_chunkCount << "chunks," << m_resultCount << "results in"
+             << elapsedMs << "ms, digest" << resultDigest();
+    emit finished(resultDigest(), elapsedMs);
+}
+
+void CaptureReplay::applySettings(const CaptureSettings &settings)
+{
+    m_engine->beginConfiguration();
+    m_engine->setSampleRate(settings.sampleRate);
+    m_engine->setBufferSize(settings.bufferSize);
+    m_engine->setFftPadding(settings.fftPadding);
+    m_engine->setDetectionMethod(settings.detectionMethod);
+    m_engine->setDbThreshold(settings.dbThreshold);
+    m_engine->setAdaptiveWindow(settings.adaptiveWindow);
+    m_engine->setMaxPeaks(settings.maxPeaks);
+    m_engine->setReferenceA(settings.referenceA);
+    m_engine->setTemperament(settings.temperament);
+    m_engine->setTemperamentRoot(settings.temperamentRoot);
+    QVariantList customCents;
+    for (double cents : settings.customCents) customCents.append(cents);
+    m_engine->setCustomCents(customCents);
+    m_engine->setInstrument(settings.instrument);
+    m_engine->setTargetString(settings.targetString);
+    m_engine->setStrobeMode(settings.strobeMode);
+    m_engine->setPowerSave(settings.powerSave);
+    m_engine->setIdleDelay(settings.idleDelay);
+    m_engine->setFixedPoint(settings.fixedPoint);
+    m_engine->setBacklogPolicy(settings.backlogPolicy);
+    m_engine->endConfiguration();
+}
+
+void CaptureReplay::recordResult(const QString &note, double frequency, double cents)
+{
+    ++m_resultCount;
+    m_digest.addData(note.toUtf8());
+    m_digest.addData(QByteArrayView(reinterpret_cast<const char*>(&frequency), sizeof(frequency)));
+    m_digest.addData(QByteArrayView(reinterpret_cast<const char*>(&cents), sizeof(cents)));
+}
+
+void CaptureReplay::recordLevel(double dbFS)
+{
+    m_digest.addData(QByteArrayView(reinterpret_cast<const char*>(&dbFS), sizeof(dbFS)));
+}
@@ -0,0 +1,56 @@
+#ifndef CAPTUREREPLAY_H
+#define CAPTUREREPLAY_H
+
+#include <QObject>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include "capturefile.h"
+
+class TunerEngine;
+
+// Feeds a raw input capture back through a TunerEngine with the original
+// chunking, either paced by the recorded arrival times or as fast as possible.
+// Every analysis result is folded into a digest, so two builds replaying the
+// same file can be compared bit for bit.
+class CaptureReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Mode {
+        RealTime,
+        AsFastAsPossible
+    };
+
+    explicit CaptureReplay(QObject *parent = nullptr);
+
+    bool open(const QString &path);
+    void start(TunerEngine *engine, Mode mode);
+
+    QByteArray resultDigest() const { return m_digest.result().toHex(); }
+    int chunkCount() const { return m_chunkCount; }
+    int resultCount() const { return m_resultCount; }
+
+signals:
+    void finished(const QByteArray &resultDigest, qint64 elapsedMs);
+
+private:
+    void replayNext();
+    bool feed(const CaptureRecord &record);
+    void finish();
+    void applySettings(const CaptureSettings &settings);
+    void recordResult(const QString &note, double frequency, double cents);
+    void recordLevel(double dbFS);
+
+    CaptureReader m_reader;
+    TunerEngine *m_engine = nullptr;
+    Mode m_mode = RealTime;
+    CaptureRecord m_pending;
+    bool m_hasPending = false;
+    QCryptographicHash m_digest{QCryptographicHash::Sha256};
+    QElapsedTimer m_timer;
+    int m_chunkCount = 0;
+    int m_resultCount = 0;
+};
+
+#endif // CAPTUREREPLAY_H
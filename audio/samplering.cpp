@@ -0,0 +1,58 @@
+#include "samplering.h"
+#include <algorithm>
+#include <cstring>
+
+SampleRing::SampleRing(int capacity)
+{
+    setCapacity(capacity);
+}
+
+void SampleRing::setCapacity(int capacity)
+{
+    m_capacity = std::max(capacity, 0);
+    m_storage.assign(2 * static_cast<size_t>(m_capacity), 0);
+    clear();
+}
+
+int SampleRing::write(const qint16 *samples, int count)
+{
+    if (m_capacity == 0 || count <= 0) return std::max(count, 0);
+
+    // Only the newest capacity samples of an oversized block can be kept
+    int dropped = 0;
+    if (count > m_capacity) {
+        dropped = count - m_capacity;
+        samples += dropped;
+        count = m_capacity;
+    }
+    int overflow = std::max(0, m_size + count - m_capacity);
+    consume(overflow);
+    dropped += overflow;
+
+    int position = (m_read + m_size) % m_capacity;
+    int first = std::min(count, m_capacity - position);
+    copyMirrored(samples, first, position);
+    copyMirrored(samples + first, count - first, 0);
+    m_size += count;
+    return dropped;
+}
+
+void SampleRing::copyMirrored(const qint16 *samples, int count, int position)
+{
+    if (count <= 0) return;
+    std::memcpy(m_storage.data() + position, samples, count * sizeof(qint16));
+    std::memcpy(m_storage.data() + position + m_capacity, samples, count * sizeof(qint16));
+}
+
+void SampleRing::consume(int count)
+{
+    count = std::clamp(count, 0, m_size);
+    if (m_capacity > 0) m_read = (m_read + count) % m_capacity;
+    m_size -= count;
+}
+
+void SampleRing::clear()
+{
+    m_read = 0;
+    m_size = 0;
+}
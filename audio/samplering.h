@@ -0,0 +1,40 @@
+#ifndef SAMPLERING_H
+#define SAMPLERING_H
+
+#include <QtGlobal>
+#include <vector>
+
+// Fixed-capacity FIFO of int16 samples between audio input and analysis.
+// The storage is mirrored: each sample is written at its ring position and
+// again one capacity further, so everything buffered is contiguous at data()
+// and analysis windows are read in place, without a linearizing copy. Writes
+// never allocate; when the ring is full the oldest samples are dropped.
+class SampleRing
+{
+public:
+    explicit SampleRing(int capacity = 0);
+
+    // Allocates and clears, not for the audio path
+    void setCapacity(int capacity);
+    int capacity() const { return m_capacity; }
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    // Oldest buffered sample, size() samples are valid from here
+    const qint16 *data() const { return m_storage.data() + m_read; }
+
+    // Appends count samples, returns how many of the oldest were dropped to fit
+    int write(const qint16 *samples, int count);
+    void consume(int count);
+    void clear();
+
+private:
+    void copyMirrored(const qint16 *samples, int count, int position);
+
+    std::vector<qint16> m_storage;  // 2 * capacity
+    int m_capacity = 0;
+    int m_read = 0;
+    int m_size = 0;
+};
+
+#endif // SAMPLERING_H
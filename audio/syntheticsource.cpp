@@ -0,0 +1,68 @@
+#include "syntheticsource.h"
+#include "tonegenerator.h"
+#include "../tunerengine.h"
+#include <QtMath>
+#include <cmath>
+
+SyntheticSource::SyntheticSource(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &SyntheticSource::onTimer);
+}
+
+void SyntheticSource::start(TunerEngine *engine)
+{
+    m_engine = engine;
+    m_timer.start(std::max(1, m_chunkSize * 1000 / m_sampleRate));
+}
+
+void SyntheticSource::stop()
+{
+    m_timer.stop();
+    m_engine = nullptr;
+}
+
+void SyntheticSource::pump(TunerEngine *engine, int chunks)
+{
+    for (int i = 0; i < chunks; ++i) {
+        QByteArray chunk = nextChunk();
+        engine->ingestAudio(chunk, elapsedUSecs());
+    }
+}
+
+void SyntheticSource::onTimer()
+{
+    if (!m_engine) return;
+    QByteArray chunk = nextChunk();
+    m_engine->ingestAudio(chunk, elapsedUSecs());
+}
+
+QByteArray SyntheticSource::nextChunk()
+{
+    if (m_generator) {
+        QByteArray chunk(m_chunkSize * static_cast<int>(sizeof(qint16)), Qt::Uninitialized);
+        m_generator->render(reinterpret_cast<qint16*>(chunk.data()), m_chunkSize);
+        m_samplesGenerated += m_chunkSize;
+        return chunk;
+    }
+
+    double norm = 0.0;
+    for (double harmonic : m_harmonics) norm += harmonic;
+    if (norm <= 0.0) norm = 1.0;
+
+    QByteArray chunk(m_chunkSize * static_cast<int>(sizeof(qint16)), Qt::Uninitialized);
+    qint16 *samples = reinterpret_cast<qint16*>(chunk.data());
+    const double step = m_frequency / m_sampleRate;
+    for (int i = 0; i < m_chunkSize; ++i) {
+        double value = 0.0;
+        for (int h = 0; h < m_harmonics.size(); ++h) {
+            value += m_harmonics[h] * std::sin(2 * M_PI * (h + 1) * m_phase);
+        }
+        samples[i] = static_cast<qint16>(qBound(-32768.0, 32767.0 * m_amplitude * value / norm, 32767.0));
+        m_phase += step;
+        m_phase -= std::floor(m_phase);
+    }
+    m_samplesGenerated += m_chunkSize;
+    return chunk;
+}
@@ -0,0 +1,60 @@
+#ifndef SYNTHETICSOURCE_H
+#define SYNTHETICSOURCE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QTimer>
+#include <QVector>
+
+class TunerEngine;
+class ToneGenerator;
+
+// Synthetic audio backend: renders a harmonic tone as int16 chunks and feeds
+// them to a TunerEngine through ingestAudio(), either paced by a timer like a
+// real device or synchronously with pump(). Timestamps come from the sample
+// count, so runs are deterministic.
+class SyntheticSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SyntheticSource(QObject *parent = nullptr);
+
+    double frequency() const { return m_frequency; }
+    void setFrequency(double frequency) { m_frequency = frequency; }
+    double amplitude() const { return m_amplitude; }
+    void setAmplitude(double amplitude) { m_amplitude = amplitude; }
+    int sampleRate() const { return m_sampleRate; }
+    void setSampleRate(int rate) { m_sampleRate = rate; }
+    int chunkSize() const { return m_chunkSize; }
+    void setChunkSize(int samples) { m_chunkSize = samples; }
+    // Relative amplitude of partials 1..n
+    void setHarmonics(const QVector<double> &amplitudes) { m_harmonics = amplitudes; }
+    // Loopback: chunks come from the generator instead of the built-in tone,
+    // which must run mono int16 at this source's rate
+    void setGenerator(ToneGenerator *generator) { m_generator = generator; }
+
+    void start(TunerEngine *engine);
+    void stop();
+    void pump(TunerEngine *engine, int chunks);
+
+    QByteArray nextChunk();
+    qint64 elapsedUSecs() const { return m_samplesGenerated * 1000000 / m_sampleRate; }
+
+private slots:
+    void onTimer();
+
+private:
+    TunerEngine *m_engine = nullptr;
+    QTimer m_timer;
+    double m_frequency = 220.0;
+    double m_amplitude = 0.3;
+    int m_sampleRate = 48000;
+    int m_chunkSize = 1024;
+    QVector<double> m_harmonics = {1.0, 0.5, 0.33, 0.25};
+    ToneGenerator *m_generator = nullptr;
+    double m_phase = 0.0;  // Fundamental phase in cycles
+    qint64 m_samplesGenerated = 0;
+};
+
+#endif // SYNTHETICSOURCE_H
@@ -0,0 +1,65 @@
+#include "tonegenerator.h"
+#include <algorithm>
+#include <cstring>
+
+ToneGenerator::ToneGenerator(QObject *parent)
+    : QIODevice(parent)
+{
+}
+
+void ToneGenerator::setFormat(const QAudioFormat &format)
+{
+    m_format = format;
+    m_oscillator.prepare(format.sampleRate());
+}
+
+void ToneGenerator::render(qint16 *samples, int count)
+{
+    float block[RENDER_BLOCK];
+    while (count > 0) {
+        const int frames = std::min(count, RENDER_BLOCK);
+        m_oscillator.render(block, frames);
+        for (int i = 0; i < frames; ++i) {
+            samples[i] = static_cast<qint16>(std::clamp(block[i] * 32767.0f, -32768.0f, 32767.0f));
+        }
+        samples += frames;
+        count -= frames;
+    }
+}
+
+qint64 ToneGenerator::bytesAvailable() const
+{
+    return std::max<qint64>(m_format.bytesForFrames(RENDER_BLOCK), 0) + QIODevice::bytesAvailable();
+}
+
+qint64 ToneGenerator::readData(char *data, qint64 maxSize)
+{
+    const int frameBytes = m_format.bytesPerFrame();
+    const int channels = m_format.channelCount();
+    const bool isFloat = m_format.sampleFormat() == QAudioFormat::Float;
+    if (frameBytes <= 0 || (!isFloat && m_format.sampleFormat() != QAudioFormat::Int16)) return -1;
+
+    // Whole frames only, the backend asks again for the rest
+    qint64 frames = maxSize / frameBytes;
+    float block[RENDER_BLOCK];
+    char *out = data;
+    while (frames > 0) {
+        const int count = static_cast<int>(std::min<qint64>(frames, RENDER_BLOCK));
+        m_oscillator.render(block, count);
+        for (int i = 0; i < count; ++i) {
+            if (isFloat) {
+                for (int c = 0; c < channels; ++c, out += sizeof(float)) std::memcpy(out, &block[i], sizeof(float));
+            } else {
+                qint16 value = static_cast<qint16>(std::clamp(block[i] * 32767.0f, -32768.0f, 32767.0f));
+                for (int c = 0; c < channels; ++c, out += sizeof(qint16)) std::memcpy(out, &value, sizeof(qint16));
+            }
+        }
+        frames -= count;
+    }
+    return out - data;
+}
+
+qint64 ToneGenerator::writeData(const char *, qint64)
+{
+    return -1;
+}
@@ -0,0 +1,43 @@
+#ifndef TONEGENERATOR_H
+#define TONEGENERATOR_H
+
+#include <QAudioFormat>
+#include <QIODevice>
+#include "../dsp/wavetableoscillator.h"
+
+// Pull-mode source for QAudioSink::start(QIODevice*): every read renders the
+// oscillator straight into the backend's buffer, converting to the sink's
+// sample format and copying the mono signal to each channel. readData()
+// works on a fixed stack block and the oscillator's atomics, no locks and no
+// allocations, so it is safe on a real-time audio thread.
+class ToneGenerator : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    static constexpr int RENDER_BLOCK = 256;  // Frames per oscillator call
+
+    explicit ToneGenerator(QObject *parent = nullptr);
+
+    // Float or Int16; rebuilds the wavetables, not while a sink is pulling
+    void setFormat(const QAudioFormat &format);
+    QAudioFormat format() const { return m_format; }
+    WavetableOscillator &oscillator() { return m_oscillator; }
+
+    // Mono int16 at the format's rate, for feeding the tone back in as input
+    void render(qint16 *samples, int count);
+
+    bool isSequential() const override { return true; }
+    // A tone never runs out, the sink may always pull a full buffer
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 size) override;
+
+private:
+    QAudioFormat m_format;
+    WavetableOscillator m_oscillator;
+};
+
+#endif // TONEGENERATOR_H
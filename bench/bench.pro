@@ -0,0 +1,31 @@
+# Benchmarks and diagnostic clients, built apart from the app: qmake bench/bench.pro
+TEMPLATE = app
+TARGET = tunerbench
+
+QT -= gui
+QT += core network websockets
+CONFIG += console c++20
+CONFIG -= app_bundle
+
+include(../dsp/dsp.pri)
+
+SOURCES += \
+        main.cpp \
+        fftBenchTool.cpp \
+        fixedPointBenchTool.cpp \
+        resultBenchTool.cpp \
+        sessionLogTool.cpp \
+        ../net/resultclient.cpp \
+        ../net/resultrecord.cpp \
+        ../net/resultserver.cpp \
+        ../session/sessionlog.cpp \
+
+HEADERS += \
+        fftBenchTool.h \
+        fixedPointBenchTool.h \
+        resultBenchTool.h \
+        sessionLogTool.h \
+        ../net/resultclient.h \
+        ../net/resultrecord.h \
+        ../net/resultserver.h \
+        ../session/sessionlog.h \
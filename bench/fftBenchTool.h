@@ -0,0 +1,11 @@
+#ifndef FFTBENCHTOOL_H
+#define FFTBENCHTOOL_H
+
+// Compile-time FFT kernels against the generic plan: for every specialized
+// size prints the plan build time (the work a first analysis at that size
+// no longer does) and the time per transform of both, on the same noise.
+// FftPlanTest checks the kernels; this still returns 1 when the two
+// transforms differ by more than rounding.
+int runFftBenchmark();
+
+#endif // FFTBENCHTOOL_H
@@ -0,0 +1,114 @@
+#include "fixedPointBenchTool.h"
+#include "../dsp/notetable.h"
+#include "../dsp/pitchdetector.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QString>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int BENCH_SAMPLE_RATE = 48000;
+constexpr int BENCH_WINDOW_SIZE = 8112;
+constexpr double BENCH_MAX_CENTS = 1.0;
+
+struct PathTiming
+{
+    qint64 nsecs = 0;
+    int blocks = 0;
+    double microseconds() const { return blocks > 0 ? nsecs / 1000.0 / blocks : 0.0; }
+};
+
+// Four harmonics with a little noise, quantized the way the audio input delivers it
+void synthesize(double frequency, double amplitude, std::mt19937 &rng, std::vector<int16_t> &samples)
+{
+    std::normal_distribution<double> noise(0.0, 0.0003);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        double t = static_cast<double>(i) / BENCH_SAMPLE_RATE;
+        double value = amplitude * (0.6 * std::sin(2 * M_PI * frequency * t)
+                                    + 0.3 * std::sin(2 * M_PI * 2 * frequency * t + 0.5)
+                                    + 0.2 * std::sin(2 * M_PI * 3 * frequency * t + 1.0)
+                                    + 0.1 * std::sin(2 * M_PI * 4 * frequency * t))
+                + noise(rng);
+        samples[i] = static_cast<int16_t>(std::clamp(std::lround(value * 32767), -32768L, 32767L));
+    }
+}
+
+}
+
+int runFixedPointBenchmark()
+{
+    NoteTable noteTable;
+    noteTable.build(440.0, Temperament::Equal, 9, {});
+    std::mt19937 rng(1);
+
+    std::vector<int16_t> quantized(BENCH_WINDOW_SIZE);
+    std::vector<double> samples(BENCH_WINDOW_SIZE);
+
+    bool ok = true;
+    for (int padding : {1, 2, 4}) {
+        PitchDetector::Settings settings;
+        settings.sampleRate = BENCH_SAMPLE_RATE;
+        settings.fftPadding = padding;
+        // The Q15 transform is radix-2 only, give the double path the same size
+        settings.powerOfTwoPadding = true;
+        // Parity of the two pipelines, the integer one has no partial fit
+        settings.partialFit = false;
+
+        PitchDetector floating;
+        PitchDetector fixed;
+        floating.setSettings(settings);
+        fixed.setSettings(settings);
+        floating.setNoteTable(&noteTable);
+        fixed.setNoteTable(&noteTable);
+
+        PathTiming floatTiming;
+        PathTiming fixedTiming;
+        double sumCents = 0.0;
+        double worstCents = 0.0;
+        int compared = 0;
+        int mismatches = 0;
+        QElapsedTimer timer;
+
+        for (double frequency = 60.0; frequency < 1000.0; frequency *= 1.0731) {
+            for (double amplitude : {0.5, 0.05, 0.005}) {
+                synthesize(frequency, amplitude, rng, quantized);
+                for (int i = 0; i < BENCH_WINDOW_SIZE; ++i) samples[i] = quantized[i] / 32768.0;
+
+                timer.start();
+                PitchDetector::Result reference = floating.analyze(samples.data(), BENCH_WINDOW_SIZE);
+                floatTiming.nsecs += timer.nsecsElapsed();
+                ++floatTiming.blocks;
+
+                timer.start();
+                PitchDetector::Result result = fixed.analyze(quantized.data(), BENCH_WINDOW_SIZE);
+                fixedTiming.nsecs += timer.nsecsElapsed();
+                ++fixedTiming.blocks;
+
+                if ((reference.frequency > 0) != (result.frequency > 0)) {
+                    ++mismatches;
+                    continue;
+                }
+                if (reference.frequency <= 0) continue;
+                double cents = std::abs(1200.0 * std::log2(result.frequency / reference.frequency));
+                sumCents += cents;
+                worstCents = std::max(worstCents, cents);
+                ++compared;
+            }
+        }
+
+        qInfo().noquote() << QString("padding %1: %2 frames, Q15 vs double mean %3 worst %4 cents, "
+                                     "%5 detection mismatches; %6 us double, %7 us Q15 per block")
+                             .arg(padding).arg(compared)
+                             .arg(compared > 0 ? sumCents / compared : 0.0, 0, 'f', 3)
+                             .arg(worstCents, 0, 'f', 3).arg(mismatches)
+                             .arg(floatTiming.microseconds(), 0, 'f', 0)
+                             .arg(fixedTiming.microseconds(), 0, 'f', 0);
+        ok = ok && mismatches == 0 && worstCents <= BENCH_MAX_CENTS;
+    }
+    return ok ? 0 : 1;
+}
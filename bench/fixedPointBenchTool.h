@@ -0,0 +1,10 @@
+#ifndef FIXEDPOINTBENCHTOOL_H
+#define FIXEDPOINTBENCHTOOL_H
+
+// Integer pipeline benchmark: analyzes the same quantized cello-range tones
+// with the double and the Q15 detector, prints the pitch difference in cents
+// and the time per block of each path. FixedPointTest holds the agreement
+// check; this returns 1 on the same failures so a run still flags them.
+int runFixedPointBenchmark();
+
+#endif // FIXEDPOINTBENCHTOOL_H
@@ -0,0 +1,63 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include "fftBenchTool.h"
+#include "fixedPointBenchTool.h"
+#include "resultBenchTool.h"
+#include "sessionLogTool.h"
+#include "../net/resultclient.h"
+#include "../net/resultserver.h"
+
+// Prints the results streamed by a running tuner: --result-client [host] [port] [--websocket]
+static int runResultClient(QCoreApplication &app, const QString &host, quint16 port, ResultClient::Transport transport)
+{
+    ResultClient client;
+    QObject::connect(&client, &ResultClient::resultReceived, [](const ResultRecord &record) {
+        qInfo().noquote() << QString("#%1 %2 us  %3 Hz  note %4  %5 cents  %6 dBFS  %7 peaks%8")
+                             .arg(record.sequence).arg(record.timestampUSecs)
+                             .arg(record.frequency, 0, 'f', 2).arg(record.midiNote)
+                             .arg(record.cents, 0, 'f', 1).arg(record.levelDb, 0, 'f', 1)
+                             .arg(record.peakCount).arg(record.flags & ResultRecord::Locked ? "  locked" : "");
+    });
+    if (!client.subscribe(QHostAddress(host), port, transport)) return 1;
+    return app.exec();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const QStringList args = QCoreApplication::arguments();
+    if (args.contains("--fft-bench")) {
+        return runFftBenchmark();
+    }
+    if (args.contains("--fixed-bench")) {
+        return runFixedPointBenchmark();
+    }
+    qsizetype clientIndex = args.indexOf("--result-client");
+    if (clientIndex >= 0) {
+        const bool webSocket = args.contains("--websocket");
+        QString host = clientIndex + 1 < args.size() ? args.at(clientIndex + 1) : QString();
+        int port = clientIndex + 2 < args.size() ? args.at(clientIndex + 2).toInt() : 0;
+        if (host.isEmpty() || host.startsWith("--")) host = "127.0.0.1";
+        if (port <= 0) port = webSocket ? ResultServer::DEFAULT_WEBSOCKET_PORT : ResultServer::DEFAULT_PORT;
+        return runResultClient(app, host, port,
+                               webSocket ? ResultClient::Transport::WebSocket : ResultClient::Transport::Udp);
+    }
+    qsizetype resultIndex = args.indexOf("--result-bench");
+    if (resultIndex >= 0) {
+        int subscribers = resultIndex + 1 < args.size() ? args.at(resultIndex + 1).toInt() : 0;
+        return runResultServerBenchmark(subscribers > 0 ? subscribers : 50);
+    }
+    qsizetype sessionIndex = args.indexOf("--session-bench");
+    if (sessionIndex >= 0) {
+        int minutes = sessionIndex + 1 < args.size() ? args.at(sessionIndex + 1).toInt() : 0;
+        return runSessionLogBenchmark(minutes > 0 ? minutes : 240);
+    }
+
+    qInfo().noquote() << "usage: tunerbench --fft-bench\n"
+                         "       tunerbench --fixed-bench\n"
+                         "       tunerbench --result-bench [subscribers]\n"
+                         "       tunerbench --result-client [host] [port] [--websocket]\n"
+                         "       tunerbench --session-bench [minutes]";
+    return 2;
+}
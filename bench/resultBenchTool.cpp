@@ -0,0 +1,113 @@
+#include "resultBenchTool.h"
+#include "../net/resultclient.h"
+#include "../net/resultserver.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr int BENCH_DURATION_MS = 1000;
+constexpr int BENCH_TICK_MS = 1;
+constexpr int BENCH_RECORDS_PER_TICK = 4;
+constexpr int BENCH_SETTLE_MS = 300;
+
+void spin(int milliseconds)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < milliseconds) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+}
+
+bool runOnce(int subscribers, ResultClient::Transport transport)
+{
+    ResultServer server;
+    if (!server.start(0, QHostAddress(), 0)) return false;
+    const bool webSocket = transport == ResultClient::Transport::WebSocket;
+    if (webSocket && server.webSocketPort() == 0) return false;
+
+    QElapsedTimer clock;
+    clock.start();
+    std::vector<qint64> latencies;
+    latencies.reserve(subscribers * BENCH_DURATION_MS * BENCH_RECORDS_PER_TICK / BENCH_TICK_MS);
+
+    std::vector<std::unique_ptr<ResultClient>> clients;
+    for (int i = 0; i < subscribers; ++i) {
+        auto client = std::make_unique<ResultClient>();
+        QObject::connect(client.get(), &ResultClient::resultReceived, [&](const ResultRecord &record) {
+            latencies.push_back(clock.nsecsElapsed() / 1000 - record.timestampUSecs);
+        });
+        client->subscribe(QHostAddress::LocalHost, webSocket ? server.webSocketPort() : server.port(), transport);
+        clients.push_back(std::move(client));
+    }
+    QElapsedTimer wait;
+    wait.start();
+    while (server.subscriberCount() < subscribers && wait.elapsed() < 2000) spin(5);
+
+    // Steady stream, the same shape as a fast analysis loop
+    quint32 sequence = 0;
+    QTimer ticker;
+    ticker.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&ticker, &QTimer::timeout, [&]() {
+        for (int i = 0; i < BENCH_RECORDS_PER_TICK; ++i) {
+            ResultRecord record;
+            record.sequence = sequence++;
+            record.timestampUSecs = clock.nsecsElapsed() / 1000;
+            record.frequency = 65.41f;
+            record.midiNote = 36;
+            server.publish(record);
+        }
+    });
+    QElapsedTimer elapsed;
+    elapsed.start();
+    ticker.start(BENCH_TICK_MS);
+    spin(BENCH_DURATION_MS);
+    ticker.stop();
+    double seconds = elapsed.nsecsElapsed() / 1.0e9;
+    spin(BENCH_SETTLE_MS);
+
+    quint64 received = 0;
+    quint64 lost = 0;
+    for (const auto &client : clients) {
+        received += client->receivedRecords();
+        lost += client->lostRecords();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies.empty() ? 0 : latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+    };
+    qInfo().noquote() << QString("%1 subscribers %2: published %3, delivered %4 (%5 records/s), lost %6, "
+                                 "dropped %7, skipped %8, latency p50 %9 us p99 %10 us max %11 us")
+                         .arg(webSocket ? "WebSocket" : "UDP").arg(subscribers).arg(sequence).arg(received)
+                         .arg(static_cast<qint64>(received / seconds)).arg(lost)
+                         .arg(static_cast<qint64>(server.droppedRecords()))
+                         .arg(static_cast<qint64>(server.skippedRecords()))
+                         .arg(percentile(0.5)).arg(percentile(0.99)).arg(percentile(1.0));
+
+    return received > 0 && server.subscriberCount() == subscribers;
+}
+
+}
+
+int runResultServerBenchmark(int maxSubscribers)
+{
+    static const int subscriberCounts[] = {1, 2, 5, 10, 20, 50};
+
+    bool ok = true;
+    for (ResultClient::Transport transport : {ResultClient::Transport::Udp, ResultClient::Transport::WebSocket}) {
+        for (int subscribers : subscriberCounts) {
+            if (subscribers > maxSubscribers) break;
+            ok = runOnce(subscribers, transport) && ok;
+        }
+    }
+    return ok ? 0 : 1;
+}
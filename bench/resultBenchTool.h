@@ -0,0 +1,10 @@
+#ifndef RESULTBENCHTOOL_H
+#define RESULTBENCHTOOL_H
+
+// Result server benchmark over localhost: for 1 up to maxSubscribers
+// reference clients, over UDP and then over WebSocket, publishes a steady
+// stream of records and reports delivery latency percentiles, throughput
+// and loss. Returns 0 when every run delivered records to all subscribers.
+int runResultServerBenchmark(int maxSubscribers);
+
+#endif // RESULTBENCHTOOL_H
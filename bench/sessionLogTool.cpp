@@ -0,0 +1,136 @@
+#include "sessionLogTool.h"
+#include "../session/sessionlog.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QString>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr qint64 BENCH_HOP_USECS = 42667;  // 2048 samples at 48 kHz
+constexpr int BENCH_FRAMES_PER_NOTE = 500;
+constexpr double BENCH_DRIFT_CENTS_PER_MINUTE = 0.5;
+constexpr int BENCH_QUERIES = 20;
+
+struct NoteTotals
+{
+    int frames = 0;
+    double seconds = 0.0;
+    double inTuneSeconds = 0.0;
+    double sumCents = 0.0;
+};
+
+// What the summaries must add up to, from every frame in [from, to)
+std::array<NoteTotals, SessionLogFormat::NOTE_COUNT> scan(const std::vector<SessionFrame> &frames,
+                                                          qint64 fromUSecs, qint64 toUSecs)
+{
+    std::array<NoteTotals, SessionLogFormat::NOTE_COUNT> totals{};
+    qint64 previous = -1;
+    for (const SessionFrame &frame : frames) {
+        if (frame.timestampUSecs >= fromUSecs && frame.timestampUSecs < toUSecs) {
+            NoteTotals &note = totals[frame.midiNote];
+            double duration = previous < 0 ? 0.0 :
+                    std::min(frame.timestampUSecs - previous, SessionLogFormat::MAX_FRAME_GAP_USECS) / 1e6;
+            ++note.frames;
+            note.seconds += duration;
+            if (std::abs(frame.cents) <= SessionLogFormat::IN_TUNE_CENTS) note.inTuneSeconds += duration;
+            note.sumCents += frame.cents;
+        }
+        previous = frame.timestampUSecs;
+    }
+    return totals;
+}
+
+}
+
+int runSessionLogBenchmark(int minutes)
+{
+    const QString path = QDir::temp().filePath("session-bench.ctlog");
+    SessionLog log;
+    if (!log.start(path)) return 1;
+
+    // Notes change every few seconds with pauses between some of them, the pitch drifts slowly sharp
+    std::mt19937 rng(1);
+    std::normal_distribution<double> scatter(0.0, 4.0);
+    std::vector<SessionFrame> frames;
+    const qint64 sessionUSecs = static_cast<qint64>(minutes) * 60 * 1000000;
+    qint64 timestamp = 0;
+    int midiNote = 48;
+    for (int i = 0; timestamp < sessionUSecs; ++i) {
+        timestamp += BENCH_HOP_USECS;
+        if (i % BENCH_FRAMES_PER_NOTE == 0) {
+            midiNote = 36 + static_cast<int>(rng() % 30);
+            if (rng() % 5 == 0) timestamp += 3000000;
+        }
+        SessionFrame frame;
+        frame.timestampUSecs = timestamp;
+        frame.midiNote = static_cast<qint16>(midiNote);
+        frame.cents = static_cast<float>(scatter(rng) + BENCH_DRIFT_CENTS_PER_MINUTE * timestamp / 60e6);
+        frame.frequency = 440.0f;
+        frame.levelDb = -20.0f;
+        frame.confidence = 0.9f;
+        frames.push_back(frame);
+        log.append(frame);
+
+        // Keeps the queue from overflowing, the log is written far faster than real time anyway
+        if (i % (SessionLog::QUEUE_CAPACITY / 2) == 0) log.durationUSecs();
+    }
+
+    bool ok = log.droppedFrames() == 0;
+    qInfo().noquote() << QString("%1 frames over %2 min, %3 dropped")
+                         .arg(frames.size()).arg(minutes).arg(log.droppedFrames());
+
+    QElapsedTimer timer;
+    double worstMs = 0.0;
+    for (int query = 0; query < BENCH_QUERIES; ++query) {
+        qint64 from = 0;
+        qint64 to = -1;
+        if (query > 0) {
+            from = std::uniform_int_distribution<qint64>(0, timestamp)(rng);
+            to = std::uniform_int_distribution<qint64>(from, timestamp)(rng);
+        }
+
+        timer.start();
+        std::vector<NoteIntonation> notes = log.intonation(from, to);
+        double ms = timer.nsecsElapsed() / 1e6;
+        worstMs = std::max(worstMs, ms);
+
+        const auto expected = scan(frames, from, to < 0 ? timestamp + 1 : to);
+        int expectedNotes = 0;
+        for (const NoteTotals &totals : expected) expectedNotes += totals.frames > 0;
+        double error = expectedNotes == static_cast<int>(notes.size()) ? 0.0 : 1.0;
+        for (const NoteIntonation &note : notes) {
+            const NoteTotals &totals = expected[note.midiNote];
+            error = std::max({error, std::abs(note.frames - totals.frames) * 1.0,
+                              std::abs(note.seconds - totals.seconds),
+                              std::abs(note.inTuneSeconds - totals.inTuneSeconds),
+                              totals.frames > 0 ? std::abs(note.meanCents - totals.sumCents / totals.frames) : 1.0});
+        }
+        if (error > 1e-6) ok = false;
+
+        double drift = 0.0;
+        for (const NoteIntonation &note : notes) drift += note.driftCentsPerMinute / notes.size();
+        qInfo().noquote() << QString("query %1 - %2 s: %3 notes in %4 ms, mean drift %5 cents/min, max error %6")
+                             .arg(from / 1e6, 0, 'f', 1).arg((to < 0 ? timestamp : to) / 1e6, 0, 'f', 1)
+                             .arg(notes.size()).arg(ms, 0, 'f', 3).arg(drift, 0, 'f', 2).arg(error, 0, 'g', 3);
+    }
+
+    log.stop();
+    SessionLogReader reader;
+    if (!reader.open(path) || reader.frameCount() != static_cast<qint64>(frames.size())) ok = false;
+    timer.start();
+    std::vector<NoteIntonation> reread = reader.intonation();
+    qInfo().noquote() << QString("reopened file: %1 notes in %2 ms, slowest live query %3 ms")
+                         .arg(reread.size()).arg(timer.nsecsElapsed() / 1e6, 0, 'f', 3).arg(worstMs, 0, 'f', 3);
+    reader.close();
+    QFile::remove(path);
+
+    qInfo().noquote() << (ok ? "session log OK" : "session log FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+#ifndef SESSIONLOGTOOL_H
+#define SESSIONLOGTOOL_H
+
+// Session log benchmark: records a synthetic practice session of the given
+// length through SessionLog and prints the time of intonation queries over
+// the whole session and random sub-ranges. SessionLogTest checks the results
+// on a shorter session; this still returns 1 on a mismatch or dropped frame.
+int runSessionLogBenchmark(int minutes);
+
+#endif // SESSIONLOGTOOL_H
@@ -0,0 +1,211 @@
+#include "autoconfig.h"
+#include "../dsp/notetable.h"
+#include "../dsp/pitchdetector.h"
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QSysInfo>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int TEST_TONES = 5;
+constexpr int TEST_PARTIALS = 6;
+constexpr double TEST_INHARMONICITY = 0.0002;  // Partial h sits at h * f * sqrt(1 + B h^2), like a string
+constexpr double TEST_AMPLITUDE = 0.25;
+constexpr double TEST_NOISE = 0.03;            // Roughly 20 dB below the tone
+
+constexpr int LOW_SAMPLE_RATE = 22050;
+constexpr int HIGH_SAMPLE_RATE = 48000;
+constexpr double WINDOW_SECONDS[] = {0.085, 0.17, 0.256};
+constexpr int PADDINGS[] = {1, 2, 4};
+
+struct MethodCandidate {
+    const char *name;
+    PitchDetector::Method method;
+};
+
+// Harmonic sum alone is pulled sharp by stretched partials, cepstrum and
+// autocorrelation resolve coarser than the spectral peaks, so only these compete
+constexpr MethodCandidate METHODS[] = {
+    {"FFT", PitchDetector::Method::Fft},
+    {"Ensemble", PitchDetector::Method::Ensemble}
+};
+
+struct TestSignal {
+    std::vector<std::vector<double>> tones;
+    std::vector<double> fundamentals;
+};
+
+TestSignal testSignal(const AutoConfig::Budget &budget, int sampleRate, int length)
+{
+    // Fixed seed, every device and every run hears the same tones
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, TEST_NOISE);
+
+    TestSignal signal;
+    const double low = budget.minFrequency * 1.1;
+    const double high = std::max(low, budget.maxFrequency / 2);
+    for (int tone = 0; tone < TEST_TONES; ++tone) {
+        const double frequency = low * std::pow(high / low, tone / (TEST_TONES - 1.0));
+        std::vector<double> samples(length);
+        for (int i = 0; i < length; ++i) {
+            const double t = static_cast<double>(i) / sampleRate;
+            double value = 0.0;
+            for (int h = 1; h <= TEST_PARTIALS; ++h) {
+                const double partial = h * frequency * std::sqrt(1.0 + TEST_INHARMONICITY * h * h);
+                value += std::sin(2 * M_PI * partial * t + tone * h) / h;
+            }
+            samples[i] = TEST_AMPLITUDE * value + noise(rng);
+        }
+        signal.tones.push_back(std::move(samples));
+        signal.fundamentals.push_back(frequency * std::sqrt(1.0 + TEST_INHARMONICITY));
+    }
+    return signal;
+}
+
+}
+
+AutoConfig::Result AutoConfig::run(const Budget &budget)
+{
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    NoteTable noteTable;
+    noteTable.build(440.0, Temperament::Equal, 9, {});
+
+    std::vector<int> sampleRates;
+    if (budget.maximumSampleRate > LOW_SAMPLE_RATE) sampleRates.push_back(LOW_SAMPLE_RATE);
+    sampleRates.push_back(std::min(budget.maximumSampleRate, HIGH_SAMPLE_RATE));
+
+    Result result;
+    result.candidates = static_cast<int>(sampleRates.size() * std::size(WINDOW_SECONDS) *
+                                         std::size(PADDINGS) * std::size(METHODS));
+    std::vector<Measurement> measurements;
+
+    // Roughly cheapest first, so a slow device out of time has measured what it can afford
+    for (int sampleRate : sampleRates) {
+        for (double seconds : WINDOW_SECONDS) {
+            const int bufferSize = static_cast<int>(std::lround(seconds * sampleRate / 16)) * 16;
+            const TestSignal signal = testSignal(budget, sampleRate, bufferSize);
+            const double windowMs = 1000.0 * bufferSize / sampleRate;
+
+            for (int padding : PADDINGS) {
+                for (const MethodCandidate &method : METHODS) {
+                    if (elapsed.elapsed() > budget.benchmarkMs) break;
+
+                    PitchDetector detector;
+                    PitchDetector::Settings settings;
+                    settings.sampleRate = sampleRate;
+                    settings.fftPadding = padding;
+                    settings.method = method.method;
+                    settings.minFrequency = budget.minFrequency;
+                    settings.maxFrequency = budget.maxFrequency;
+                    detector.setSettings(settings);
+                    detector.setNoteTable(&noteTable);
+
+                    // Plans and window tables are built once in the engine as well, keep them out of the timing
+                    detector.analyze(signal.tones.front().data(), bufferSize);
+
+                    Measurement measurement;
+                    measurement.sampleRate = sampleRate;
+                    measurement.bufferSize = bufferSize;
+                    measurement.fftPadding = padding;
+                    measurement.detectionMethod = QString::fromLatin1(method.name);
+
+                    qint64 nsecs = 0;
+                    double error = 0.0;
+                    for (size_t tone = 0; tone < signal.tones.size(); ++tone) {
+                        QElapsedTimer timer;
+                        timer.start();
+                        PitchDetector::Result detection = detector.analyze(signal.tones[tone].data(), bufferSize);
+                        nsecs += timer.nsecsElapsed();
+                        error += detection.frequency > 0 ?
+                                    std::min(MISS_CENTS, std::abs(1200.0 * std::log2(detection.frequency / signal.fundamentals[tone]))) :
+                                    MISS_CENTS;
+                    }
+                    measurement.blockMs = nsecs / 1e6 / signal.tones.size();
+                    measurement.cpuShare = measurement.blockMs / windowMs;
+                    measurement.latencyMs = windowMs + measurement.blockMs;
+                    measurement.errorCents = error / signal.tones.size();
+                    measurement.fits = measurement.cpuShare <= budget.cpuShare && measurement.latencyMs <= budget.latencyMs;
+                    measurements.push_back(measurement);
+                }
+            }
+        }
+    }
+    result.measured = static_cast<int>(measurements.size());
+
+    // The most accurate that fits; when nothing fits the cheapest keeps up best
+    const Measurement *chosen = nullptr;
+    for (const Measurement &measurement : measurements) {
+        if (!measurement.fits) continue;
+        if (!chosen || measurement.errorCents < chosen->errorCents - TIE_CENTS ||
+            (measurement.errorCents < chosen->errorCents + TIE_CENTS && measurement.cpuShare < chosen->cpuShare)) {
+            chosen = &measurement;
+        }
+    }
+    if (!chosen) {
+        for (const Measurement &measurement : measurements) {
+            if (!chosen || measurement.cpuShare < chosen->cpuShare) chosen = &measurement;
+        }
+    }
+    if (chosen) result.chosen = *chosen;
+    result.elapsedMs = elapsed.elapsed();
+    return result;
+}
+
+QString AutoConfig::deviceFingerprint(const QByteArray &inputDeviceId)
+{
+    // The CPU decides the block times and the input device the sample rates
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QSysInfo::machineUniqueId());
+    hash.addData(QSysInfo::currentCpuArchitecture().toUtf8());
+    hash.addData(QByteArray::number(QThread::idealThreadCount()));
+    hash.addData(inputDeviceId);
+    return QString::fromLatin1(hash.result().toHex().left(16));
+}
+
+QVariantMap AutoConfig::toProfile(const Result &result)
+{
+    const Measurement &chosen = result.chosen;
+    QVariantMap profile;
+    if (chosen.sampleRate == 0) return profile;
+
+    profile["version"] = VERSION;
+    profile["sampleRate"] = chosen.sampleRate;
+    profile["bufferSize"] = chosen.bufferSize;
+    profile["fftPadding"] = chosen.fftPadding;
+    profile["detectionMethod"] = chosen.detectionMethod;
+    profile["blockMs"] = chosen.blockMs;
+    profile["cpuShare"] = chosen.cpuShare;
+    profile["latencyMs"] = chosen.latencyMs;
+    profile["errorCents"] = chosen.errorCents;
+    profile["fits"] = chosen.fits;
+    // How many times faster than real time the chosen pipeline analyzes
+    profile["headroom"] = chosen.blockMs > 0 ? 1000.0 * chosen.bufferSize / chosen.sampleRate / chosen.blockMs : 0.0;
+    profile["candidates"] = result.candidates;
+    profile["measured"] = result.measured;
+    profile["benchmarkMs"] = result.elapsedMs;
+    return profile;
+}
+
+QVariantMap AutoConfig::cachedProfile(const QString &fingerprint)
+{
+    QSettings settings;
+    QVariantMap profile = settings.value("autoConfig/" + fingerprint).toMap();
+    if (profile.value("version").toInt() != VERSION) return QVariantMap();
+    return profile;
+}
+
+void AutoConfig::storeProfile(const QString &fingerprint, const QVariantMap &profile)
+{
+    if (profile.isEmpty()) return;
+    QSettings settings;
+    settings.setValue("autoConfig/" + fingerprint, profile);
+}
@@ -0,0 +1,61 @@
+#ifndef AUTOCONFIG_H
+#define AUTOCONFIG_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+
+// Picks the analysis settings for this device from a short micro-benchmark.
+// Every candidate pipeline (sample rate x window length x padding x method)
+// analyzes the same noisy, slightly inharmonic test tones spread over the
+// instrument's range; the most accurate one whose block time fits the CPU
+// share and whose window plus block time fits the latency budget wins.
+// Results are cached per device fingerprint in QSettings, a new CPU or input
+// device gets a new fingerprint and so a new benchmark.
+class AutoConfig
+{
+public:
+    struct Budget {
+        double cpuShare = 0.2;        // Of one core, analysis runs on the GUI thread
+        double latencyMs = 300.0;     // Window length plus block time
+        int maximumSampleRate = 48000;
+        double minFrequency = 60.0;   // Test tones span the instrument's band
+        double maxFrequency = 1000.0;
+        int benchmarkMs = 2000;       // Candidates still unmeasured by then are skipped
+    };
+
+    struct Measurement {
+        int sampleRate = 0;
+        int bufferSize = 0;
+        int fftPadding = 0;
+        QString detectionMethod;
+        double blockMs = 0.0;
+        double cpuShare = 0.0;
+        double latencyMs = 0.0;
+        double errorCents = 0.0;      // Mean over the test tones, a miss counts MISS_CENTS
+        bool fits = false;
+    };
+
+    struct Result {
+        Measurement chosen;
+        int candidates = 0;
+        int measured = 0;
+        qint64 elapsedMs = 0;
+    };
+
+    static constexpr int VERSION = 1;  // Bump when the candidates or the scoring change
+    static constexpr double MISS_CENTS = 100.0;
+    static constexpr double TIE_CENTS = 0.02;  // Closer than this the cheaper candidate wins
+
+    // Runs the benchmark on the calling thread, use a worker
+    static Result run(const Budget &budget);
+
+    static QString deviceFingerprint(const QByteArray &inputDeviceId);
+    // Profile keys: sampleRate, bufferSize, fftPadding, detectionMethod, blockMs, cpuShare,
+    // latencyMs, errorCents, fits, headroom, candidates, measured, benchmarkMs
+    static QVariantMap toProfile(const Result &result);
+    static QVariantMap cachedProfile(const QString &fingerprint);
+    static void storeProfile(const QString &fingerprint, const QVariantMap &profile);
+};
+
+#endif // AUTOCONFIG_H
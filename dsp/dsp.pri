@@ -0,0 +1,33 @@
+# Qt-free analysis core, shared by the app and the standalone tunerdsp library
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+        $$PWD/fftkernels.cpp \
+        $$PWD/fftplan.cpp \
+        $$PWD/fixedpoint.cpp \
+        $$PWD/idlemonitor.cpp \
+        $$PWD/notetable.cpp \
+        $$PWD/partialtracker.cpp \
+        $$PWD/peakpicker.cpp \
+        $$PWD/phasevocoder.cpp \
+        $$PWD/pitchdetector.cpp \
+        $$PWD/pitchtracker.cpp \
+        $$PWD/spectralestimators.cpp \
+        $$PWD/wavetableoscillator.cpp \
+
+HEADERS += \
+        $$PWD/fftkernels.h \
+        $$PWD/fftplan.h \
+        $$PWD/fixedpoint.h \
+        $$PWD/idlemonitor.h \
+        $$PWD/instrumentprofile.h \
+        $$PWD/notetable.h \
+        $$PWD/partialtracker.h \
+        $$PWD/peakpicker.h \
+        $$PWD/phasevocoder.h \
+        $$PWD/pitchdetector.h \
+        $$PWD/pitchtracker.h \
+        $$PWD/plancache.h \
+        $$PWD/seqlock.h \
+        $$PWD/spectralestimators.h \
+        $$PWD/wavetableoscillator.h \
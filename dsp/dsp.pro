@@ -0,0 +1,20 @@
+# Standalone shared library with the C API in tunerdsp.h, for batch and offline analysis
+TEMPLATE = lib
+TARGET = tunerdsp
+VERSION = 2.0.0
+
+CONFIG -= qt
+CONFIG += c++20 hide_symbols
+
+DEFINES += TUNERDSP_BUILD
+
+include(dsp.pri)
+
+SOURCES += \
+        tunerdsp.cpp \
+
+HEADERS += \
+        tunerdsp.h \
+
+unix:!android: target.path = /opt/tunerdsp/lib
+!isEmpty(target.path): INSTALLS += target
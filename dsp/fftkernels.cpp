@@ -0,0 +1,185 @@
+#include "fftkernels.h"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+using Complex = std::complex<double>;
+
+constexpr int QUARTER = FftKernels::LARGEST / 4;
+constexpr int SPLIT = 128;  // QUARTER = SPLIT^2, see makeQuarterWave()
+constexpr long double HALF_PI = 1.570796326794896619231321691639751442L;
+
+struct SinCos {
+    long double sin;
+    long double cos;
+};
+
+// Taylor series, the angles stay below pi/2 where 20 terms are exact to long double
+constexpr SinCos sinCos(long double x)
+{
+    SinCos result{x, 1.0L};
+    long double sinTerm = x;
+    long double cosTerm = 1.0L;
+    for (int n = 1; n < 40; n += 2) {
+        sinTerm *= -x * x / ((n + 1) * (n + 2));
+        cosTerm *= -x * x / (n * (n + 1));
+        result.sin += sinTerm;
+        result.cos += cosTerm;
+    }
+    return result;
+}
+
+// sin(pi/2 j / QUARTER) for j = 0..QUARTER. Built as sin(a + b) from SPLIT
+// coarse and SPLIT fine angles, which keeps the series evaluations (and the
+// compile time) down to a few hundred; within half an ulp of the true sine
+constexpr std::array<double, QUARTER + 1> makeQuarterWave()
+{
+    std::array<SinCos, SPLIT + 1> coarse{};
+    std::array<SinCos, SPLIT> fine{};
+    for (int i = 0; i <= SPLIT; ++i) coarse[i] = sinCos(HALF_PI * i / SPLIT);
+    for (int i = 0; i < SPLIT; ++i) fine[i] = sinCos(HALF_PI * i / QUARTER);
+
+    std::array<double, QUARTER + 1> table{};
+    for (int j = 0; j <= QUARTER; ++j) {
+        const SinCos &a = coarse[j / SPLIT];
+        const SinCos &b = fine[j % SPLIT];
+        table[j] = static_cast<double>(a.sin * b.cos + a.cos * b.sin);
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> makeByteReverse()
+{
+    std::array<uint8_t, 256> table{};
+    for (int i = 0; i < 256; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < 8; ++b) {
+            if (i & (1 << b)) reversed |= 1 << (7 - b);
+        }
+        table[i] = static_cast<uint8_t>(reversed);
+    }
+    return table;
+}
+
+constexpr std::array<double, QUARTER + 1> QUARTER_WAVE = makeQuarterWave();
+constexpr std::array<uint8_t, 256> BYTE_REVERSE = makeByteReverse();
+
+constexpr int log2Of(int n)
+{
+    int bits = 0;
+    while ((1 << bits) < n) ++bits;
+    return bits;
+}
+
+// Spelled out, std::complex's operator* adds a NaN recovery branch per product
+inline Complex multiply(Complex a, Complex b)
+{
+    return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+}
+
+inline Complex multiplyNegI(Complex value)
+{
+    return {value.imag(), -value.real()};
+}
+
+template <int N>
+void transform(Complex *data)
+{
+    static_assert(N >= 8 && (N & (N - 1)) == 0 && N <= FftKernels::LARGEST, "power of two within the table");
+    constexpr int BITS = log2Of(N);
+
+    for (int i = 0; i < N; ++i) {
+        const unsigned reversed = static_cast<unsigned>(BYTE_REVERSE[i & 0xff]) << 8 | BYTE_REVERSE[(i >> 8) & 0xff];
+        const int j = static_cast<int>(reversed >> (16 - BITS));
+        if (i < j) std::swap(data[i], data[j]);
+    }
+
+    // First stage unrolled: radix-8 for odd powers of two so the rest pair up in radix-4
+    int span;
+    if constexpr (BITS % 2 == 1) {
+        constexpr double SQRT_HALF = 0.70710678118654752440;
+        for (int start = 0; start < N; start += 8) {
+            Complex *x = data + start;
+            const Complex a0 = x[0] + x[1], a1 = x[0] - x[1];
+            const Complex a2 = x[2] + x[3], a3 = multiplyNegI(x[2] - x[3]);
+            const Complex a4 = x[4] + x[5], a5 = x[4] - x[5];
+            const Complex a6 = x[6] + x[7], a7 = multiplyNegI(x[6] - x[7]);
+            const Complex b0 = a0 + a2, b1 = a1 + a3, b2 = a0 - a2, b3 = a1 - a3;
+            const Complex b4 = a4 + a6, b5 = a5 + a7, b6 = a4 - a6, b7 = a5 - a7;
+            // b5..b7 times W8^1, W8^2 = -i and W8^3
+            const Complex c5(SQRT_HALF * (b5.real() + b5.imag()), SQRT_HALF * (b5.imag() - b5.real()));
+            const Complex c6 = multiplyNegI(b6);
+            const Complex c7(SQRT_HALF * (b7.imag() - b7.real()), -SQRT_HALF * (b7.real() + b7.imag()));
+            x[0] = b0 + b4;
+            x[4] = b0 - b4;
+            x[1] = b1 + c5;
+            x[5] = b1 - c5;
+            x[2] = b2 + c6;
+            x[6] = b2 - c6;
+            x[3] = b3 + c7;
+            x[7] = b3 - c7;
+        }
+        span = 8;
+    } else {
+        for (int start = 0; start < N; start += 4) {
+            Complex *x = data + start;
+            const Complex a0 = x[0] + x[1], a1 = x[0] - x[1];
+            const Complex a2 = x[2] + x[3], a3 = multiplyNegI(x[2] - x[3]);
+            x[0] = a0 + a2;
+            x[2] = a0 - a2;
+            x[1] = a1 + a3;
+            x[3] = a1 - a3;
+        }
+        span = 4;
+    }
+
+    // Radix-4 on bit-reversed order: two radix-2 stages in one pass, three
+    // twiddle products per four points. W^k comes from the table, W^2k and
+    // W^3k from products, which costs less than the symmetry lookups
+    for (; span < N; span *= 4) {
+        const int step = QUARTER / span;
+        for (int start = 0; start < N; start += 4 * span) {
+            Complex *x = data + start;
+            for (int k = 0; k < span; ++k) {
+                const int index = k * step;
+                const Complex w1(QUARTER_WAVE[QUARTER - index], -QUARTER_WAVE[index]);
+                const Complex w2 = multiply(w1, w1);
+                const Complex w3 = multiply(w2, w1);
+
+                const Complex a0 = x[k];
+                const Complex a1 = multiply(w2, x[k + span]);
+                const Complex a2 = multiply(w1, x[k + 2 * span]);
+                const Complex a3 = multiply(w3, x[k + 3 * span]);
+                const Complex even = a0 + a1, odd = a0 - a1;
+                const Complex sum = a2 + a3, difference = multiplyNegI(a2 - a3);
+                x[k] = even + sum;
+                x[k + 2 * span] = even - sum;
+                x[k + span] = odd + difference;
+                x[k + 3 * span] = odd - difference;
+            }
+        }
+    }
+}
+
+}
+
+FftKernels::Kernel FftKernels::forSize(int size)
+{
+    switch (size) {
+    case 4096:
+        return &transform<4096>;
+    case 8192:
+        return &transform<8192>;
+    case 16384:
+        return &transform<16384>;
+    case 32768:
+        return &transform<32768>;
+    case 65536:
+        return &transform<65536>;
+    default:
+        return nullptr;
+    }
+}
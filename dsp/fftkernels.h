@@ -0,0 +1,26 @@
+#ifndef FFTKERNELS_H
+#define FFTKERNELS_H
+
+#include <complex>
+
+// Forward FFTs compiled for one power-of-two size each, the sizes padded
+// analysis windows most often land on. Every loop bound is a constant, the
+// first stage is an unrolled radix-4 or radix-8 block without twiddles and
+// the rest are radix-4 stages. Twiddles come from one quarter-wave sine
+// table and bit reversal from a byte table, both generated at compile time
+// and embedded read-only, so a kernel needs no setup and no memory of its
+// own. FftPlan dispatches to them and keeps its generic transforms for
+// every other size.
+namespace FftKernels {
+
+constexpr int SMALLEST = 4096;
+constexpr int LARGEST = 65536;
+
+using Kernel = void (*)(std::complex<double> *data);
+
+// In-place forward transform of size elements, nullptr when size has no kernel
+Kernel forSize(int size);
+
+}
+
+#endif // FFTKERNELS_H
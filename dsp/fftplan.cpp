@@ -0,0 +1,277 @@
+#include "fftplan.h"
+#include "plancache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+// Per-thread work area, plans themselves stay immutable and shareable
+std::vector<std::complex<double>>& scratchBuffer(size_t size)
+{
+    thread_local std::vector<std::complex<double>> scratch;
+    if (scratch.size() < size) scratch.resize(size);
+    return scratch;
+}
+
+bool factorize(int n, std::vector<int>& factors)
+{
+    factors.clear();
+    while (n > 1) {
+        int p = (n % 4 == 0) ? 4 : (n % 2 == 0) ? 2 : (n % 3 == 0) ? 3 : (n % 5 == 0) ? 5 : 0;
+        if (p == 0) return false;
+        n /= p;
+        factors.push_back(p);
+        factors.push_back(n);
+    }
+    return true;
+}
+
+}
+
+FftPlan::FftPlan(int size, bool specialized)
+    : m_size(size)
+{
+    m_specialized = specialized ? FftKernels::forSize(size) : nullptr;
+    if (m_specialized) {
+        m_algorithm = Algorithm::Specialized;
+    } else if (isPowerOfTwo(size)) {
+        m_algorithm = Algorithm::Radix2;
+
+        // Twiddles for the largest stage, smaller stages use a stride into it
+        m_twiddles.resize(size / 2);
+        for (int k = 0; k < size / 2; ++k) {
+            m_twiddles[k] = std::polar(1.0, -2.0 * M_PI * k / size);
+        }
+
+        int bits = 0;
+        while ((1 << bits) < size) ++bits;
+        m_bitReverse.resize(size);
+        for (int i = 0; i < size; ++i) {
+            int reversed = 0;
+            for (int b = 0; b < bits; ++b) {
+                if (i & (1 << b)) reversed |= 1 << (bits - 1 - b);
+            }
+            m_bitReverse[i] = reversed;
+        }
+    } else if (factorize(size, m_factors)) {
+        m_algorithm = Algorithm::MixedRadix;
+        m_twiddles.resize(size);
+        for (int k = 0; k < size; ++k) {
+            m_twiddles[k] = std::polar(1.0, -2.0 * M_PI * k / size);
+        }
+    } else {
+        m_algorithm = Algorithm::Bluestein;
+
+        // Chirp w[k] = exp(-i pi k^2 / n), k^2 reduced mod 2n to keep the angle exact
+        m_chirp.resize(size);
+        for (int k = 0; k < size; ++k) {
+            long long k2 = (static_cast<long long>(k) * k) % (2LL * size);
+            m_chirp[k] = std::polar(1.0, -M_PI * k2 / size);
+        }
+
+        int convolutionSize = nextPowerOfTwo(2 * size - 1);
+        m_inner = forSize(convolutionSize);
+
+        // Transformed kernel conj(w) wrapped around, with the inverse scaling folded in
+        m_kernel.assign(convolutionSize, std::complex<double>(0, 0));
+        m_kernel[0] = std::conj(m_chirp[0]);
+        for (int k = 1; k < size; ++k) {
+            m_kernel[k] = std::conj(m_chirp[k]);
+            m_kernel[convolutionSize - k] = std::conj(m_chirp[k]);
+        }
+        m_inner->transform(m_kernel.data());
+        for (auto& value : m_kernel) value /= convolutionSize;
+    }
+}
+
+void FftPlan::transform(std::complex<double>* data) const
+{
+    if (m_size <= 1) return;
+
+    switch (m_algorithm) {
+    case Algorithm::Specialized:
+        m_specialized(data);
+        break;
+    case Algorithm::Radix2:
+        transformRadix2(data);
+        break;
+    case Algorithm::MixedRadix:
+        transformMixedRadix(data);
+        break;
+    case Algorithm::Bluestein:
+        transformBluestein(data);
+        break;
+    }
+}
+
+void FftPlan::transformRadix2(std::complex<double>* data) const
+{
+    const int n = m_size;
+
+    for (int i = 0; i < n; ++i) {
+        int j = m_bitReverse[i];
+        if (i < j) std::swap(data[i], data[j]);
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        int half = len / 2;
+        int stride = n / len;
+        for (int start = 0; start < n; start += len) {
+            for (int k = 0; k < half; ++k) {
+                std::complex<double> t = m_twiddles[k * stride] * data[start + k + half];
+                data[start + k + half] = data[start + k] - t;
+                data[start + k] += t;
+            }
+        }
+    }
+}
+
+void FftPlan::transformMixedRadix(std::complex<double>* data) const
+{
+    auto& scratch = scratchBuffer(m_size);
+    std::copy(data, data + m_size, scratch.begin());
+    mixedRadixStage(data, scratch.data(), 1, m_factors.data());
+}
+
+void FftPlan::mixedRadixStage(std::complex<double>* out, const std::complex<double>* in,
+                              int fstride, const int* factors) const
+{
+    // Decimation in time: transform the p interleaved sub-sequences, then combine
+    const int p = factors[0];
+    const int m = factors[1];
+
+    if (m == 1) {
+        for (int q = 0; q < p; ++q) {
+            out[q] = in[q * fstride];
+        }
+    } else {
+        for (int q = 0; q < p; ++q) {
+            mixedRadixStage(out + q * m, in + q * fstride, fstride * p, factors + 2);
+        }
+    }
+
+    switch (p) {
+    case 2:
+        butterfly2(out, fstride, m);
+        break;
+    case 4:
+        butterfly4(out, fstride, m);
+        break;
+    default:
+        butterflyGeneric(out, fstride, m, p);
+        break;
+    }
+}
+
+void FftPlan::butterfly2(std::complex<double>* out, int fstride, int m) const
+{
+    for (int k = 0; k < m; ++k) {
+        std::complex<double> t = out[k + m] * m_twiddles[k * fstride];
+        out[k + m] = out[k] - t;
+        out[k] += t;
+    }
+}
+
+void FftPlan::butterfly4(std::complex<double>* out, int fstride, int m) const
+{
+    for (int k = 0; k < m; ++k) {
+        std::complex<double> s0 = out[k + m] * m_twiddles[k * fstride];
+        std::complex<double> s1 = out[k + 2 * m] * m_twiddles[2 * k * fstride];
+        std::complex<double> s2 = out[k + 3 * m] * m_twiddles[3 * k * fstride];
+
+        std::complex<double> s5 = out[k] - s1;
+        out[k] += s1;
+        std::complex<double> s3 = s0 + s2;
+        std::complex<double> s4 = s0 - s2;
+
+        out[k + 2 * m] = out[k] - s3;
+        out[k] += s3;
+        // Multiplying s4 by -i for the forward direction
+        out[k + m] = std::complex<double>(s5.real() + s4.imag(), s5.imag() - s4.real());
+        out[k + 3 * m] = std::complex<double>(s5.real() - s4.imag(), s5.imag() + s4.real());
+    }
+}
+
+void FftPlan::butterflyGeneric(std::complex<double>* out, int fstride, int m, int p) const
+{
+    // Used for radix 3 and 5, p is at most 5 here
+    std::complex<double> values[5];
+    for (int u = 0; u < m; ++u) {
+        for (int q = 0; q < p; ++q) {
+            values[q] = out[u + q * m];
+        }
+        for (int q1 = 0; q1 < p; ++q1) {
+            int k = u + q1 * m;
+            int twiddleIndex = 0;
+            std::complex<double> sum = values[0];
+            for (int q = 1; q < p; ++q) {
+                twiddleIndex += fstride * k;
+                if (twiddleIndex >= m_size) twiddleIndex -= m_size;
+                sum += values[q] * m_twiddles[twiddleIndex];
+            }
+            out[k] = sum;
+        }
+    }
+}
+
+void FftPlan::transformBluestein(std::complex<double>* data) const
+{
+    const int n = m_size;
+    const int convolutionSize = m_inner->size();
+    auto& work = scratchBuffer(convolutionSize);
+
+    for (int k = 0; k < n; ++k) {
+        work[k] = data[k] * m_chirp[k];
+    }
+    std::fill(work.begin() + n, work.begin() + convolutionSize, std::complex<double>(0, 0));
+
+    // Circular convolution with the chirp kernel; inverse FFT through conjugation
+    m_inner->transform(work.data());
+    for (int k = 0; k < convolutionSize; ++k) {
+        work[k] = std::conj(work[k] * m_kernel[k]);
+    }
+    m_inner->transform(work.data());
+
+    for (int k = 0; k < n; ++k) {
+        data[k] = std::conj(work[k]) * m_chirp[k];
+    }
+}
+
+std::shared_ptr<const FftPlan> FftPlan::forSize(int size)
+{
+    // A Bluestein plan requests its inner plan from here while being built
+    static PlanCache<FftPlan> plans(CACHED_SIZES);
+    return plans.get(size, [](int n) { return std::make_shared<const FftPlan>(n); });
+}
+
+int FftPlan::nextPowerOfTwo(int n)
+{
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+int FftPlan::nextFastSize(int n)
+{
+    for (int candidate = std::max(n, 1); ; ++candidate) {
+        int rest = candidate;
+        for (int p : {2, 3, 5}) {
+            while (rest % p == 0) rest /= p;
+        }
+        if (rest == 1) return candidate;
+    }
+}
+
+std::shared_ptr<const std::vector<double>> HannWindow::forLength(int length)
+{
+    static PlanCache<std::vector<double>> windows(FftPlan::CACHED_SIZES);
+    return windows.get(length, [](int n) {
+        auto window = std::make_shared<std::vector<double>>(n);
+        for (int i = 0; i < n; ++i) {
+            (*window)[i] = n > 1 ? 0.5 * (1 - std::cos(2 * M_PI * i / (n - 1))) : 1.0;
+        }
+        return std::shared_ptr<const std::vector<double>>(std::move(window));
+    });
+}
@@ -0,0 +1,77 @@
+#ifndef FFTPLAN_H
+#define FFTPLAN_H
+
+#include <complex>
+#include <memory>
+#include <vector>
+#include "fftkernels.h"
+
+// Precomputed FFT for one transform size.
+// Plans are immutable once built and shared through forSize(), so twiddles,
+// factorizations and Bluestein chirps are computed once per size.
+//  - powers of two from 4096 to 65536 run a compile-time kernel (fftkernels.h),
+//    nothing is computed when the plan is built
+//  - other powers of two use an in-place iterative radix-2 transform
+//  - sizes whose factors are all 2, 3 or 5 use a mixed radix 2/3/4/5 recursion
+//  - any other size goes through Bluestein's chirp-z on a power-of-two plan
+class FftPlan
+{
+public:
+    enum class Algorithm {
+        Specialized,
+        Radix2,
+        MixedRadix,
+        Bluestein
+    };
+
+    // specialized false skips the compile-time kernels, to compare against them
+    explicit FftPlan(int size, bool specialized = true);
+
+    int size() const { return m_size; }
+    Algorithm algorithm() const { return m_algorithm; }
+
+    // In-place forward transform of size() elements, safe to call from several threads
+    void transform(std::complex<double>* data) const;
+
+    // Shared plan for size, the CACHED_SIZES most recently used sizes stay resident
+    static std::shared_ptr<const FftPlan> forSize(int size);
+    static constexpr int CACHED_SIZES = 16;
+
+    static bool isPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+    static int nextPowerOfTwo(int n);
+    // Smallest size >= n with no prime factor above 5
+    static int nextFastSize(int n);
+
+private:
+    void transformRadix2(std::complex<double>* data) const;
+    void transformMixedRadix(std::complex<double>* data) const;
+    void transformBluestein(std::complex<double>* data) const;
+    void mixedRadixStage(std::complex<double>* out, const std::complex<double>* in,
+                         int fstride, const int* factors) const;
+    void butterfly2(std::complex<double>* out, int fstride, int m) const;
+    void butterfly4(std::complex<double>* out, int fstride, int m) const;
+    void butterflyGeneric(std::complex<double>* out, int fstride, int m, int p) const;
+
+    int m_size;
+    Algorithm m_algorithm;
+    FftKernels::Kernel m_specialized = nullptr;
+    std::vector<std::complex<double>> m_twiddles;
+    std::vector<int> m_bitReverse;
+
+    // Mixed radix: pairs of (radix, remaining length)
+    std::vector<int> m_factors;
+
+    // Bluestein: chirp, transformed convolution kernel and the inner plan
+    std::vector<std::complex<double>> m_chirp;
+    std::vector<std::complex<double>> m_kernel;
+    std::shared_ptr<const FftPlan> m_inner;
+};
+
+// Cached Hann window coefficients, one table per window length, bounded like FftPlan::forSize()
+class HannWindow
+{
+public:
+    static std::shared_ptr<const std::vector<double>> forLength(int length);
+};
+
+#endif // FFTPLAN_H
@@ -0,0 +1,150 @@
+#include "fixedpoint.h"
+#include "fftplan.h"
+#include "plancache.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+constexpr int LOG2_TABLE_BITS = 8;
+
+// log2(1 + i / 256) in Q16, with one extra entry for the interpolation
+const std::array<int32_t, (1 << LOG2_TABLE_BITS) + 1> &log2Table()
+{
+    static const auto table = [] {
+        std::array<int32_t, (1 << LOG2_TABLE_BITS) + 1> values{};
+        for (int i = 0; i <= (1 << LOG2_TABLE_BITS); ++i) {
+            values[i] = static_cast<int32_t>(std::lround(std::log2(1.0 + i / 256.0) * 65536.0));
+        }
+        return values;
+    }();
+    return table;
+}
+
+int highestBit(uint64_t x)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(x);
+#else
+    int bit = 0;
+    while (x >>= 1) ++bit;
+    return bit;
+#endif
+}
+
+int16_t saturate(int32_t value)
+{
+    return static_cast<int16_t>(std::clamp(value, -32768, 32767));
+}
+
+}
+
+int32_t FixedPoint::log2Q16(uint64_t x)
+{
+    if (x == 0) return LOG2_ZERO;
+
+    // Mantissa normalized to 1.xxxx with 16 fraction bits: 8 index the table, 8 interpolate
+    const int exponent = highestBit(x);
+    const uint32_t mantissa = exponent >= 16 ? static_cast<uint32_t>(x >> (exponent - 16))
+                                             : static_cast<uint32_t>(x << (16 - exponent));
+    const uint32_t fraction = mantissa & 0xFFFF;
+    const uint32_t index = fraction >> 8;
+    const int32_t low = log2Table()[index];
+    const int32_t high = log2Table()[index + 1];
+    return (exponent << 16) + low + (((high - low) * static_cast<int32_t>(fraction & 0xFF)) >> 8);
+}
+
+std::shared_ptr<const std::vector<int16_t>> FixedPoint::hannWindow(int length)
+{
+    static PlanCache<std::vector<int16_t>> windows(FftPlan::CACHED_SIZES);
+    return windows.get(length, [](int n) {
+        auto window = std::make_shared<std::vector<int16_t>>(n);
+        for (int i = 0; i < n; ++i) {
+            double value = n > 1 ? 0.5 * (1 - std::cos(2 * M_PI * i / (n - 1))) : 1.0;
+            (*window)[i] = saturate(static_cast<int32_t>(std::lround(value * 32767.0)));
+        }
+        return std::shared_ptr<const std::vector<int16_t>>(std::move(window));
+    });
+}
+
+FixedFftPlan::FixedFftPlan(int size)
+    : m_size(size)
+{
+    m_twiddles.resize(size / 2);
+    for (int k = 0; k < size / 2; ++k) {
+        double angle = -2.0 * M_PI * k / size;
+        m_twiddles[k].re = saturate(static_cast<int32_t>(std::lround(std::cos(angle) * 32767.0)));
+        m_twiddles[k].im = saturate(static_cast<int32_t>(std::lround(std::sin(angle) * 32767.0)));
+    }
+
+    int bits = 0;
+    while ((1 << bits) < size) ++bits;
+    m_bitReverse.resize(size);
+    for (int i = 0; i < size; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) reversed |= 1 << (bits - 1 - b);
+        }
+        m_bitReverse[i] = reversed;
+    }
+}
+
+int FixedFftPlan::transform(Q15Complex *data, int inputExponent) const
+{
+    const int n = m_size;
+    int exponent = inputExponent;
+
+    int32_t largest = 0;
+    for (int i = 0; i < n; ++i) {
+        int j = m_bitReverse[i];
+        if (i < j) std::swap(data[i], data[j]);
+        largest = std::max({largest, std::abs(static_cast<int32_t>(data[i].re)),
+                            std::abs(static_cast<int32_t>(data[i].im))});
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        // A butterfly grows a component by at most 1 + sqrt(2) (2473 / 1024, plus rounding):
+        // shifting until that fits makes saturation unnecessary
+        int shift = 0;
+        while ((((largest * 2473) >> 10) + 1) >> shift > 32767) ++shift;
+        exponent += shift;
+
+        // The outputs of this stage bound the shift of the next one
+        int32_t stageLargest = 0;
+        const int half = len / 2;
+        const int stride = n / len;
+        const int32_t rounding = shift > 0 ? 1 << (shift - 1) : 0;
+        for (int start = 0; start < n; start += len) {
+            for (int k = 0; k < half; ++k) {
+                const Q15Complex w = m_twiddles[k * stride];
+                Q15Complex &a = data[start + k];
+                Q15Complex &b = data[start + k + half];
+                const int32_t tre = (w.re * b.re - w.im * b.im + (1 << 14)) >> 15;
+                const int32_t tim = (w.re * b.im + w.im * b.re + (1 << 14)) >> 15;
+                const int32_t sumRe = (a.re + tre + rounding) >> shift;
+                const int32_t sumIm = (a.im + tim + rounding) >> shift;
+                const int32_t differenceRe = (a.re - tre + rounding) >> shift;
+                const int32_t differenceIm = (a.im - tim + rounding) >> shift;
+                a.re = static_cast<int16_t>(sumRe);
+                a.im = static_cast<int16_t>(sumIm);
+                b.re = static_cast<int16_t>(differenceRe);
+                b.im = static_cast<int16_t>(differenceIm);
+                // v ^ (v >> 31) is |v| or |v| - 1, the + 1 above covers the difference
+                stageLargest = std::max(stageLargest, std::max(std::max(sumRe ^ (sumRe >> 31), sumIm ^ (sumIm >> 31)),
+                                                               std::max(differenceRe ^ (differenceRe >> 31),
+                                                                        differenceIm ^ (differenceIm >> 31))));
+            }
+        }
+        largest = stageLargest;
+    }
+    return exponent;
+}
+
+std::shared_ptr<const FixedFftPlan> FixedFftPlan::forSize(int size)
+{
+    static PlanCache<FixedFftPlan> plans(FftPlan::CACHED_SIZES);
+    return plans.get(size, [](int n) { return std::make_shared<const FixedFftPlan>(n); });
+}
@@ -0,0 +1,74 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Integer building blocks of the Q15 analysis path, for devices whose FPU
+// cannot keep up with the double pipeline. Samples stay int16 (Q15), the
+// FFT is a radix-2 block floating-point transform on int16 data, and
+// magnitudes and logarithms come from shifts, multiplies and small tables.
+
+struct Q15Complex {
+    int16_t re = 0;
+    int16_t im = 0;
+};
+
+namespace FixedPoint {
+
+// log2(x) in Q16, from a 256-entry mantissa table with linear interpolation;
+// x = 0 returns LOG2_ZERO
+constexpr int32_t LOG2_ZERO = -(64 << 16);
+int32_t log2Q16(uint64_t x);
+
+// dB of a power ratio given as a Q16 log2, 10 log10(2) dB per octave
+inline double log2Q16ToDb(int64_t log2Value) { return log2Value * (3.0102999566398120 / 65536.0); }
+
+// Alpha-max-plus-beta-min with two segments, within 1.3% of the true magnitude
+inline uint32_t approxMagnitude(int32_t re, int32_t im)
+{
+    uint32_t a = static_cast<uint32_t>(re < 0 ? -re : re);
+    uint32_t b = static_cast<uint32_t>(im < 0 ? -im : im);
+    uint32_t larger = a > b ? a : b;
+    uint32_t smaller = a > b ? b : a;
+    uint32_t first = larger + ((smaller * 5) >> 5);
+    uint32_t second = ((larger * 27) >> 5) + ((smaller * 71) >> 7);
+    return first > second ? first : second;
+}
+
+inline uint32_t power(const Q15Complex &value)
+{
+    return static_cast<uint32_t>(value.re * value.re) + static_cast<uint32_t>(value.im * value.im);
+}
+
+// Hann window in Q15, cached per length like HannWindow
+std::shared_ptr<const std::vector<int16_t>> hannWindow(int length);
+
+}
+
+// Block floating-point radix-2 FFT plan for power-of-two sizes.
+// Before each stage the data is shifted right just enough that the
+// butterflies cannot overflow int16, and the shifts are summed into the
+// block exponent: true value = data * 2^exponent. Plans are immutable and
+// shared through forSize().
+class FixedFftPlan
+{
+public:
+    explicit FixedFftPlan(int size);
+
+    int size() const { return m_size; }
+
+    // In-place forward transform, returns the block exponent of the result.
+    // inputExponent is the exponent of the data on entry.
+    int transform(Q15Complex *data, int inputExponent) const;
+
+    static std::shared_ptr<const FixedFftPlan> forSize(int size);
+
+private:
+    int m_size;
+    std::vector<Q15Complex> m_twiddles;  // exp(-2 pi i k / n) in Q15, k < n / 2
+    std::vector<int> m_bitReverse;
+};
+
+#endif // FIXEDPOINT_H
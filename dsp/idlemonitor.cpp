@@ -0,0 +1,78 @@
+#include "idlemonitor.h"
+
+#include <algorithm>
+#include <cmath>
+
+void IdleMonitor::configure(int sampleRate, double thresholdDb, double idleDelaySeconds)
+{
+    m_sampleRate = sampleRate;
+    m_thresholdPower = std::pow(10.0, thresholdDb / 10.0);
+    m_idleDelaySamples = static_cast<int64_t>(idleDelaySeconds * sampleRate);
+}
+
+void IdleMonitor::reset()
+{
+    m_idle = false;
+    m_silentSamples = 0;
+    m_hopSum = 0.0;
+    m_hopSamples = 0;
+    m_phase = 0;
+    m_peakPower = 0.0;
+}
+
+bool IdleMonitor::frameAnalyzed(int samples, bool aboveThreshold)
+{
+    if (aboveThreshold || m_idle) {
+        m_silentSamples = 0;
+        return false;
+    }
+
+    m_silentSamples += samples;
+    if (m_silentSamples < m_idleDelaySamples) return false;
+
+    m_idle = true;
+    m_silentSamples = 0;
+    m_hopSum = 0.0;
+    m_hopSamples = 0;
+    m_phase = 0;
+    m_peakPower = 0.0;
+    return true;
+}
+
+int IdleMonitor::scan(const int16_t *samples, int count)
+{
+    if (!m_idle) return 0;
+
+    for (int start = 0; start < count; ) {
+        // Rest of the current hop within this block
+        const int end = std::min(count, start + HOP - m_hopSamples);
+        int i = start + m_phase;
+        for (; i < end; i += DECIMATION) {
+            const double value = samples[i];
+            m_hopSum += value * value;
+        }
+        m_phase = i - end;
+        m_hopSamples += end - start;
+
+        if (m_hopSamples == HOP) {
+            const double power = m_hopSum * SCALE * DECIMATION / HOP;
+            m_peakPower = std::max(m_peakPower, power);
+            m_hopSum = 0.0;
+            m_hopSamples = 0;
+            if (power > m_thresholdPower) {
+                m_idle = false;
+                m_phase = 0;
+                return std::max(0, end - HOP);
+            }
+        }
+        start = end;
+    }
+    return -1;
+}
+
+double IdleMonitor::takeLevelDb()
+{
+    double db = m_peakPower > 0.0 ? 10.0 * std::log10(m_peakPower) : -90.0;
+    m_peakPower = 0.0;
+    return std::max(db, -90.0);
+}
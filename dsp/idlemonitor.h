@@ -0,0 +1,51 @@
+#ifndef IDLEMONITOR_H
+#define IDLEMONITOR_H
+
+#include <cstdint>
+
+// Power-save gate for the analysis pipeline. Full analysis frames report
+// whether they were above the level threshold; after idleDelay seconds of
+// silence the monitor goes idle. While idle the engine skips conversion and
+// detection and only feeds raw int16 blocks to scan(), which tracks the
+// envelope on every DECIMATION-th sample in short HOP-sample hops and wakes
+// on the first hop above the threshold. Decimating without a filter aliases
+// but keeps the mean power of the signal, which is all the gate needs.
+class IdleMonitor
+{
+public:
+    static constexpr int HOP = 256;        // Wake-up latency, 5.3 ms at 48 kHz
+    static constexpr int DECIMATION = 8;
+
+    void configure(int sampleRate, double thresholdDb, double idleDelaySeconds);
+    void reset();
+
+    bool isIdle() const { return m_idle; }
+
+    // Full analysis path, returns true when this frame sent the monitor idle
+    bool frameAnalyzed(int samples, bool aboveThreshold);
+
+    // Idle path, returns the offset in samples where full analysis should
+    // resume (start of the waking hop), or -1 while it stays quiet
+    int scan(const int16_t *samples, int count);
+
+    // Loudest hop level in dBFS since the previous call, for a throttled meter
+    double takeLevelDb();
+
+private:
+    static constexpr double SCALE = 1.0 / (32768.0 * 32768.0);
+
+    int m_sampleRate = 48000;
+    double m_thresholdPower = 0.0;  // Mean square equivalent of the dB threshold
+    int64_t m_idleDelaySamples = 0;
+
+    bool m_idle = false;
+    int64_t m_silentSamples = 0;
+
+    // Hop in progress, carried across blocks
+    double m_hopSum = 0.0;
+    int m_hopSamples = 0;
+    int m_phase = 0;  // Offset of the next decimated sample in the following block
+    double m_peakPower = 0.0;
+};
+
+#endif // IDLEMONITOR_H
@@ -0,0 +1,57 @@
+#ifndef INSTRUMENTPROFILE_H
+#define INSTRUMENTPROFILE_H
+
+#include <array>
+#include <string_view>
+
+// Open strings, search bands and harmonic weights of the bowed strings.
+// Frequencies are equal tempered at A4 = 440 Hz, callers scale them by
+// referenceA / 440. The fundamental search band spans the lowest open string
+// minus two semitones to the top of the usual playing range; a target
+// string narrows it to four semitones either side of that string.
+struct StringProfile {
+    std::string_view name;
+    int midiNote;
+    double frequency;
+};
+
+struct InstrumentProfile {
+    static constexpr int STRING_COUNT = 4;
+    static constexpr int HARMONIC_WEIGHTS = 5;  // Harmonics 2..6
+
+    std::string_view name;
+    std::array<StringProfile, STRING_COUNT> strings;  // Lowest first
+    double minFrequency;
+    double maxFrequency;
+    // Expected strength of harmonics 2..6 relative to the fundamental,
+    // lower instruments radiate their upper partials more strongly
+    std::array<double, HARMONIC_WEIGHTS> harmonicWeights;
+
+    static constexpr double stringMinFrequency(double frequency) { return frequency * 0.7937005259840998; }  // -4 semitones
+    static constexpr double stringMaxFrequency(double frequency) { return frequency * 1.2599210498948732; }  // +4 semitones
+};
+
+inline constexpr std::array<InstrumentProfile, 4> INSTRUMENT_PROFILES = {{
+    {"Cello", {{{"C", 36, 65.406}, {"G", 43, 97.999}, {"D", 50, 146.832}, {"A", 57, 220.000}}},
+     58.0, 1400.0, {0.8, 0.6, 0.45, 0.35, 0.25}},
+    {"Viola", {{{"C", 48, 130.813}, {"G", 55, 195.998}, {"D", 62, 293.665}, {"A", 69, 440.000}}},
+     116.0, 1800.0, {0.6, 0.45, 0.3, 0.22, 0.17}},
+    {"Violin", {{{"G", 55, 195.998}, {"D", 62, 293.665}, {"A", 69, 440.000}, {"E", 76, 659.255}}},
+     175.0, 3000.0, {0.5, 0.33, 0.25, 0.2, 0.15}},
+    {"Double bass", {{{"E", 28, 41.203}, {"A", 33, 55.000}, {"D", 38, 73.416}, {"G", 43, 97.999}}},
+     36.0, 700.0, {0.9, 0.7, 0.5, 0.4, 0.3}},
+}};
+
+// Profile by name, the cello when the name is unknown
+constexpr const InstrumentProfile &instrumentProfile(std::string_view name)
+{
+    for (const InstrumentProfile &profile : INSTRUMENT_PROFILES) {
+        if (profile.name == name) return profile;
+    }
+    return INSTRUMENT_PROFILES[0];
+}
+
+static_assert(instrumentProfile("Viola").strings[0].midiNote == 48, "profile lookup");
+static_assert(InstrumentProfile::stringMinFrequency(65.406) > 50.0, "string band");
+
+#endif // INSTRUMENTPROFILE_H
@@ -0,0 +1,114 @@
+#include "notetable.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 5-limit just ratios for each interval above the drone
+constexpr double JUST_RATIOS[12] = {
+    1.0, 16.0 / 15.0, 9.0 / 8.0, 6.0 / 5.0, 5.0 / 4.0, 4.0 / 3.0,
+    45.0 / 32.0, 3.0 / 2.0, 8.0 / 5.0, 5.0 / 3.0, 9.0 / 5.0, 15.0 / 8.0
+};
+
+constexpr int A4_NOTE = 69;
+
+double wrapCents(double cents)
+{
+    while (cents > 600.0) cents -= 1200.0;
+    while (cents < -600.0) cents += 1200.0;
+    return cents;
+}
+
+}
+
+NoteTable::NoteTable()
+{
+    build(440.0, Temperament::Equal, 9, {});
+}
+
+void NoteTable::build(double referenceA, Temperament temperament, int rootPitchClass,
+                      const std::array<double, 12> &customCents)
+{
+    rootPitchClass = ((rootPitchClass % 12) + 12) % 12;
+    m_offsets.fill(0.0);
+
+    switch (temperament) {
+    case Temperament::Equal:
+        break;
+    case Temperament::Pythagorean:
+        // Fifths -5..+6 around the root cover all twelve pitch classes
+        for (int k = -5; k <= 6; ++k) {
+            int interval = ((7 * k) % 12 + 12) % 12;
+            double pure = 1200.0 * std::log2(1.5) * k;
+            m_offsets[(rootPitchClass + interval) % 12] = wrapCents(pure - 100.0 * interval);
+        }
+        break;
+    case Temperament::Just:
+        for (int interval = 0; interval < 12; ++interval) {
+            double pure = 1200.0 * std::log2(JUST_RATIOS[interval]);
+            m_offsets[(rootPitchClass + interval) % 12] = pure - 100.0 * interval;
+        }
+        break;
+    case Temperament::Custom:
+        m_offsets = customCents;
+        break;
+    }
+
+    // The root keeps its equal-tempered pitch, everything else is relative to it
+    if (temperament == Temperament::Pythagorean || temperament == Temperament::Just) {
+        double rootOffset = m_offsets[rootPitchClass];
+        for (double &offset : m_offsets) offset -= rootOffset;
+    }
+
+    m_centers.resize(NOTE_COUNT);
+    for (int i = 0; i < NOTE_COUNT; ++i) {
+        int note = FIRST_NOTE + i;
+        double semitones = (note - A4_NOTE) + m_offsets[note % 12] / 100.0;
+        m_centers[i] = referenceA * std::pow(2.0, semitones / 12.0);
+    }
+
+    // Boundary i separates note i from note i + 1, at the geometric midpoint
+    size_t padded = 1;
+    while (padded < static_cast<size_t>(NOTE_COUNT - 1)) padded <<= 1;
+    m_boundaries.assign(padded, std::numeric_limits<double>::infinity());
+    for (int i = 0; i < NOTE_COUNT - 1; ++i) {
+        m_boundaries[i] = std::sqrt(m_centers[i] * m_centers[i + 1]);
+    }
+}
+
+int NoteTable::nearestIndex(double frequency) const
+{
+    // Count boundaries <= frequency; the loop has a fixed trip count and the
+    // comparison compiles to a conditional move
+    const double *base = m_boundaries.data();
+    size_t n = m_boundaries.size();
+    while (n > 1) {
+        size_t half = n / 2;
+        base = (base[half - 1] <= frequency) ? base + half : base;
+        n -= half;
+    }
+    int index = static_cast<int>(base - m_boundaries.data()) + (base[0] <= frequency ? 1 : 0);
+    return index < NOTE_COUNT ? index : NOTE_COUNT - 1;
+}
+
+NoteTable::Match NoteTable::nearest(double frequency) const
+{
+    Match match;
+    int index = nearestIndex(frequency);
+    match.note = FIRST_NOTE + index;
+    match.centerFrequency = m_centers[index];
+    match.cents = centsFromRatio(frequency / match.centerFrequency);
+    return match;
+}
+
+double NoteTable::centsFromRatio(double ratio)
+{
+    // ln(r) = 2 atanh(y), y = (r - 1) / (r + 1). Within a semitone |y| < 0.03,
+    // so three terms are exact to well below 1e-9 cents
+    if (ratio < 0.5 || ratio > 2.0) return 1200.0 * std::log2(ratio);
+    double y = (ratio - 1.0) / (ratio + 1.0);
+    double y2 = y * y;
+    double ln = 2.0 * y * (1.0 + y2 * (1.0 / 3.0 + y2 * (1.0 / 5.0 + y2 / 7.0)));
+    return ln * (1200.0 / M_LN2);
+}
@@ -0,0 +1,53 @@
+#ifndef NOTETABLE_H
+#define NOTETABLE_H
+
+#include <array>
+#include <vector>
+
+enum class Temperament {
+    Equal,
+    Pythagorean,  // Pure fifths stacked from the root
+    Just,         // 5-limit ratios against a drone on the root
+    Custom        // Per pitch class cents offsets from equal temperament
+};
+
+// Note centre frequencies and lookup boundaries for MIDI notes C0..B8,
+// rebuilt only when the reference or temperament changes.
+// Lookup is a branchless binary search on the sorted boundaries, and cents
+// come from a short series instead of log2, so per-frame note matching does
+// no transcendental calls.
+class NoteTable
+{
+public:
+    static constexpr int FIRST_NOTE = 12;   // C0
+    static constexpr int NOTE_COUNT = 108;  // Up to B8
+
+    struct Match {
+        int note = 0;                   // MIDI note number
+        double centerFrequency = 0.0;
+        double cents = 0.0;             // Deviation from centerFrequency
+    };
+
+    NoteTable();
+
+    // rootPitchClass: 0 = C ... 11 = B, used by Pythagorean and Just
+    void build(double referenceA, Temperament temperament, int rootPitchClass,
+               const std::array<double, 12> &customCents);
+
+    Match nearest(double frequency) const;
+    double centerFrequency(int note) const { return m_centers[note - FIRST_NOTE]; }
+
+    // Offset from equal temperament applied to each pitch class, in cents
+    const std::array<double, 12> &offsets() const { return m_offsets; }
+
+    static double centsFromRatio(double ratio);
+
+private:
+    int nearestIndex(double frequency) const;
+
+    std::array<double, 12> m_offsets{};
+    std::vector<double> m_centers;
+    std::vector<double> m_boundaries;  // Padded to a power of two with +inf
+};
+
+#endif // NOTETABLE_H
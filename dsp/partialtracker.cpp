@@ -0,0 +1,225 @@
+#include "partialtracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+double centsBetween(double frequency, double reference) { return 1200.0 * std::log2(frequency / reference); }
+
+double logPower(const std::complex<double> &bin) { return std::log(std::norm(bin) + 1e-30); }
+
+}
+
+void PartialTracker::reset()
+{
+    m_partials = {};
+    m_misses = {};
+    m_levelDb = {};
+    m_lastHint = 0.0;
+    m_sumW = m_sumX = m_sumY = m_sumXX = m_sumXY = 0.0;
+    m_fit = Fit();
+}
+
+double PartialTracker::predict(int harmonic, double f0) const
+{
+    return harmonic * f0 * std::sqrt(1.0 + m_fit.inharmonicity * harmonic * harmonic);
+}
+
+bool PartialTracker::search(const std::complex<double> *spectrum, int size, double binWidth, double from, double to,
+                            double &frequency, double &magnitude) const
+{
+    const int first = std::max(1, static_cast<int>(std::ceil(from / binWidth)));
+    const int last = std::min(size / 2 - 2, static_cast<int>(to / binWidth));
+
+    // Strongest local maximum in reach, a monotonic skirt of the neighbouring partial has none
+    int best = -1;
+    double bestPower = 0.0;
+    for (int i = first; i <= last; ++i) {
+        const double power = std::norm(spectrum[i]);
+        if (power > bestPower && power >= std::norm(spectrum[i - 1]) && power > std::norm(spectrum[i + 1])) {
+            best = i;
+            bestPower = power;
+        }
+    }
+    if (best < 0) return false;
+
+    // Parabola on log power, as in PeakPicker
+    const double a = logPower(spectrum[best - 1]);
+    const double b = logPower(spectrum[best]);
+    const double c = logPower(spectrum[best + 1]);
+    const double curvature = a - 2.0 * b + c;
+    const double delta = curvature < 0.0 ? std::clamp(0.5 * (a - c) / curvature, -0.5, 0.5) : 0.0;
+    frequency = (best + delta) * binWidth;
+    magnitude = std::exp(0.5 * (b - 0.25 * (a - c) * delta));
+    return true;
+}
+
+double PartialTracker::inharmonicity() const
+{
+    if (m_sumW <= 0.0) return 0.0;
+    const double spread = m_sumW * m_sumXX - m_sumX * m_sumX;
+    if (spread < MIN_SPAN * m_sumW * m_sumW) return 0.0;
+
+    const double slope = (m_sumW * m_sumXY - m_sumX * m_sumY) / spread;
+    const double intercept = (m_sumY - slope * m_sumX) / m_sumW;
+    if (intercept <= 0.0) return 0.0;
+    return std::clamp(slope / intercept, 0.0, MAX_INHARMONICITY);
+}
+
+const PartialTracker::Fit &PartialTracker::update(const std::complex<double> *spectrum, int size, double binWidth,
+                                                  double resolution, double noiseMagnitude, double f0Hint)
+{
+    if (f0Hint <= 0.0 || binWidth <= 0.0) return m_fit;
+    if (m_lastHint > 0.0 && std::abs(centsBetween(f0Hint, m_lastHint)) > NOTE_CHANGE_CENTS) {
+        reset();
+    }
+    const double hintRatio = m_lastHint > 0.0 ? f0Hint / m_lastHint : 1.0;
+    m_lastHint = f0Hint;
+
+    // Match: live tracks continue from where they were, scaled by the hint's glide.
+    // The others are looked for where the series puts them, or one step above
+    // the two partials matched right below when their step is the series' own,
+    // which follows the stretch before B is known. Either way the search stays
+    // within a spacing of that expectation and above the partial matched
+    // below, so no slot takes a peak that a lower one holds, and a maximum
+    // only counts, and seeds the next step, once it clears the floor
+    const double nyquist = (size / 2 - 2) * binWidth;
+    const double spacing = SEARCH_SPACING * f0Hint;
+    const double relativeFloor = std::pow(10.0, FLOOR_DB / 20.0);
+    double strongest = 0.0;
+    double below = 0.0;
+    for (int n = 1; n <= MAX_PARTIALS; ++n) {
+        Partial &partial = m_partials[n - 1];
+        double expected = predict(n, f0Hint);
+        if (n > 2 && m_found[n - 2] > 0.0 && m_found[n - 3] > 0.0) {
+            const double step = m_found[n - 2] - m_found[n - 3];
+            if (std::abs(step - (predict(n - 1, f0Hint) - predict(n - 2, f0Hint))) <= spacing) {
+                expected = m_found[n - 2] + step;
+            }
+        }
+        const double centre = partial.active ? partial.frequency * hintRatio : expected;
+        const double reach = std::max(centre * (std::exp2(SEARCH_CENTS / 1200.0) - 1.0), resolution);
+        const double from = std::max({centre - reach, expected - spacing, below + binWidth});
+        const double to = std::min(centre + reach, expected + spacing);
+        m_found[n - 1] = 0.0;
+        if (to >= nyquist || from > to) continue;
+
+        double frequency = 0.0;
+        double magnitude = 0.0;
+        if (search(spectrum, size, binWidth, from, to, frequency, magnitude) &&
+            magnitude >= std::max(noiseMagnitude, strongest * relativeFloor)) {
+            m_found[n - 1] = frequency;
+            m_magnitude[n - 1] = magnitude;
+            strongest = std::max(strongest, magnitude);
+            below = frequency;
+        }
+    }
+
+    // A strong partial above can still sink earlier matches under the floor. A
+    // noise maximum taken for a missing high partial would drag B with all the
+    // leverage of its n^2
+    const double floor = std::max(noiseMagnitude, strongest * relativeFloor);
+    int matched = 0;
+    for (int n = 1; n <= MAX_PARTIALS; ++n) {
+        if (m_found[n - 1] > 0.0 && m_magnitude[n - 1] >= floor) {
+            ++matched;
+        } else {
+            m_found[n - 1] = 0.0;
+        }
+    }
+
+    // Fit f0 to every matched partial under the current B. A partial's own
+    // error shrinks as n in its implied f0 but the error of B grows with n,
+    // so the weight is power times n. Partials already known to be unstable
+    // only count when nothing else is left
+    m_fit.partialCount = matched;
+    if (matched >= MIN_FIT_PARTIALS) {
+        double sum = 0.0;
+        double weights = 0.0;
+        for (int pass = 0; pass < 2 && weights <= 0.0; ++pass) {
+            for (int n = 1; n <= MAX_PARTIALS; ++n) {
+                if (m_found[n - 1] <= 0.0 || (pass == 0 && m_partials[n - 1].unstable)) continue;
+                const double amplitude = m_magnitude[n - 1] / strongest;
+                const double weight = amplitude * amplitude * n;
+                sum += weight * m_found[n - 1] / predict(n, 1.0);
+                weights += weight;
+            }
+        }
+        m_fit.frequency = sum / weights;
+
+        // Forget old frames slowly, B belongs to the string and changes with nothing but the note
+        m_sumW *= FORGETTING;
+        m_sumX *= FORGETTING;
+        m_sumY *= FORGETTING;
+        m_sumXX *= FORGETTING;
+        m_sumXY *= FORGETTING;
+        for (int n = 1; n <= MAX_PARTIALS; ++n) {
+            if (m_found[n - 1] <= 0.0) continue;
+            const double weight = m_magnitude[n - 1] / strongest;
+            const double x = static_cast<double>(n) * n;
+            const double ratio = m_found[n - 1] / (n * m_fit.frequency);
+            const double y = ratio * ratio;
+            m_sumW += weight;
+            m_sumX += weight * x;
+            m_sumY += weight * y;
+            m_sumXX += weight * x * x;
+            m_sumXY += weight * x * y;
+        }
+        m_fit.inharmonicity = inharmonicity();
+    } else {
+        m_fit.frequency = 0.0;
+    }
+
+    // Level changes common to all partials are the note's own swell or decay
+    double commonChange = 0.0;
+    int continued = 0;
+    for (int n = 1; n <= MAX_PARTIALS; ++n) {
+        if (m_found[n - 1] <= 0.0 || !m_partials[n - 1].active) continue;
+        commonChange += 20.0 * std::log10(m_magnitude[n - 1]) - m_levelDb[n - 1];
+        ++continued;
+    }
+    commonChange = continued > 0 ? commonChange / continued : 0.0;
+
+    // Continue, start or end the tracks, and judge their stability against the fit
+    int unstable = 0;
+    int judged = 0;
+    for (int n = 1; n <= MAX_PARTIALS; ++n) {
+        Partial &partial = m_partials[n - 1];
+        if (m_found[n - 1] <= 0.0) {
+            if (partial.active && ++m_misses[n - 1] > MAX_MISSES) {
+                partial = Partial();
+            }
+            continue;
+        }
+
+        const double amplitude = m_magnitude[n - 1] / strongest;
+        const double levelDb = 20.0 * std::log10(m_magnitude[n - 1]);
+        const double deviation = m_fit.frequency > 0.0 ? centsBetween(m_found[n - 1], predict(n, m_fit.frequency)) : 0.0;
+        if (!partial.active) {
+            partial = Partial();
+            partial.active = true;
+        } else {
+            const double jump = std::abs(deviation - partial.deviationCents);
+            const double flutter = std::abs(levelDb - m_levelDb[n - 1] - commonChange);
+            partial.jitterCents += SMOOTHING * (jump - partial.jitterCents);
+            partial.flutterDb += SMOOTHING * (flutter - partial.flutterDb);
+        }
+        m_misses[n - 1] = 0;
+        m_levelDb[n - 1] = levelDb;
+        partial.frequency = m_found[n - 1];
+        partial.amplitude = amplitude;
+        partial.deviationCents = deviation;
+        ++partial.age;
+
+        const bool judgeable = partial.age >= MIN_JUDGE_AGE && 20.0 * std::log10(amplitude) >= JUDGE_DB;
+        partial.unstable = judgeable && (partial.jitterCents > UNSTABLE_JITTER_CENTS ||
+                                         partial.flutterDb > UNSTABLE_FLUTTER_DB);
+        judged += judgeable ? 1 : 0;
+        unstable += partial.unstable ? 1 : 0;
+    }
+
+    m_fit.unstableCount = unstable;
+    m_fit.wolfTone = (m_partials[0].unstable || m_partials[1].unstable) && 2 * unstable <= judged;
+    return m_fit;
+}
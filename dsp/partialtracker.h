@@ -0,0 +1,92 @@
+#ifndef PARTIALTRACKER_H
+#define PARTIALTRACKER_H
+
+#include <array>
+#include <complex>
+
+// Frame-to-frame tracking of the partials of one note, McAulay-Quatieri style
+// but constrained to the stiff string series f_n = n f0 sqrt(1 + B n^2).
+// Each of the fixed pool of tracks continues to the spectral maximum nearest
+// its predicted frequency, is born when one appears and dies after a few
+// frames without. Weighted least squares over the tracked partials, with
+// exponential forgetting across frames, estimates the inharmonicity B online;
+// every frame then fits f0 to all partials at once instead of trusting the
+// single fundamental peak. Tracks whose deviation from the series or whose
+// level keeps jumping are flagged unstable, on the lowest partials that is a
+// wolf tone. update() is O(partials) and allocates nothing.
+class PartialTracker
+{
+public:
+    static constexpr int MAX_PARTIALS = 20;
+    static constexpr int MIN_FIT_PARTIALS = 2;         // Fewer and the frame keeps its own estimate
+    static constexpr double NOTE_CHANGE_CENTS = 60.0;  // A hint this far from the fit starts a new note
+    static constexpr double MAX_INHARMONICITY = 0.01;  // Beyond any real string, caps noisy fits
+
+    struct Partial {
+        bool active = false;
+        double frequency = 0.0;       // Hz
+        double amplitude = 0.0;       // Relative to the strongest partial of the frame
+        double deviationCents = 0.0;  // From the fitted series
+        double jitterCents = 0.0;     // Smoothed change of deviationCents per frame
+        double flutterDb = 0.0;       // Smoothed level change per frame, beyond the note's own
+        int age = 0;                  // Frames since birth
+        bool unstable = false;
+    };
+
+    struct Fit {
+        double frequency = 0.0;       // f0 of the series, 0 before enough partials
+        double inharmonicity = 0.0;   // B, 0 until the partials span enough harmonics
+        int partialCount = 0;         // Partials matched in the last frame
+        int unstableCount = 0;
+        bool wolfTone = false;        // First or second partial unstable while most others are steady
+    };
+
+    void reset();
+
+    // spectrum holds size bins of binWidth Hz from a window whose unpadded
+    // bins are resolution Hz wide. Maxima below noiseMagnitude are noise, not
+    // partials; f0Hint is this frame's detection
+    const Fit &update(const std::complex<double> *spectrum, int size, double binWidth, double resolution,
+                      double noiseMagnitude, double f0Hint);
+
+    const Fit &fit() const { return m_fit; }
+    // Indexed by harmonic number - 1
+    const std::array<Partial, MAX_PARTIALS> &partials() const { return m_partials; }
+
+private:
+    static constexpr double SEARCH_CENTS = 35.0;        // Around each prediction, at least one resolution bin
+    static constexpr double SEARCH_SPACING = 0.3;       // Never past this fraction of f0 from the series
+    static constexpr double FLOOR_DB = -50.0;           // Below the strongest partial nothing is tracked either
+    static constexpr double JUDGE_DB = -30.0;           // Weaker partials are too noisy to call unstable
+    static constexpr int MAX_MISSES = 3;
+    static constexpr int MIN_JUDGE_AGE = 4;
+    static constexpr double SMOOTHING = 0.25;           // Per frame, for jitter and flutter
+    static constexpr double FORGETTING = 0.9;           // Per frame, for the inharmonicity sums
+    static constexpr double MIN_SPAN = 8.0;             // Weighted spread of n^2 needed before B is trusted
+    static constexpr double UNSTABLE_JITTER_CENTS = 6.0;
+    static constexpr double UNSTABLE_FLUTTER_DB = 4.0;
+
+    double predict(int harmonic, double f0) const;
+    // Strongest local maximum between from and to Hz, refined
+    bool search(const std::complex<double> *spectrum, int size, double binWidth, double from, double to,
+                double &frequency, double &magnitude) const;
+    double inharmonicity() const;
+
+    std::array<Partial, MAX_PARTIALS> m_partials{};
+    std::array<double, MAX_PARTIALS> m_found{};     // This frame's matched frequency, 0 for none
+    std::array<double, MAX_PARTIALS> m_magnitude{};
+    std::array<int, MAX_PARTIALS> m_misses{};
+    std::array<double, MAX_PARTIALS> m_levelDb{};  // Absolute, of the last match
+    double m_lastHint = 0.0;
+
+    // Forgetting sums of w, w x, w y, w x^2, w x y with x = n^2, y = (f_n / n f0)^2
+    double m_sumW = 0.0;
+    double m_sumX = 0.0;
+    double m_sumY = 0.0;
+    double m_sumXX = 0.0;
+    double m_sumXY = 0.0;
+
+    Fit m_fit;
+};
+
+#endif // PARTIALTRACKER_H
@@ -0,0 +1,162 @@
+#include "peakpicker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double TINY_POWER = 1e-30;  // Keeps log() finite on exact zeros
+
+// Streams the local maxima of keys[1 .. length - 2] above threshold through a
+// min-heap of maxPeaks entries, bins receives the indices of the survivors
+template<typename Key>
+int collectCandidates(const Key *keys, int length, Key threshold, int maxPeaks,
+                      std::array<int, PeakPicker::MAX_PEAKS> &bins)
+{
+    std::array<Key, PeakPicker::MAX_PEAKS> heapKeys;
+    std::array<int, PeakPicker::MAX_PEAKS> heap;
+    int heapSize = 0;
+    auto heapLess = [&heapKeys](int a, int b) { return heapKeys[a] > heapKeys[b]; };
+
+    for (int i = 1; i < length - 1; ++i) {
+        Key key = keys[i];
+        if (key <= threshold || key <= keys[i - 1] || key < keys[i + 1]) continue;
+
+        if (heapSize < maxPeaks) {
+            heapKeys[heapSize] = key;
+            bins[heapSize] = i;
+            heap[heapSize] = heapSize;
+            ++heapSize;
+            std::push_heap(heap.begin(), heap.begin() + heapSize, heapLess);
+        } else {
+            // Replace the weakest peak kept so far
+            std::pop_heap(heap.begin(), heap.begin() + heapSize, heapLess);
+            int slot = heap[heapSize - 1];
+            heapKeys[slot] = key;
+            bins[slot] = i;
+            std::push_heap(heap.begin(), heap.begin() + heapSize, heapLess);
+        }
+        if (heapSize == maxPeaks) threshold = heapKeys[heap[0]];
+    }
+    return heapSize;
+}
+
+}
+
+void PeakPicker::setMaxPeaks(int count)
+{
+    m_maxPeaks = std::clamp(count, 1, MAX_PEAKS);
+}
+
+int PeakPicker::pick(const std::complex<double>* spectrum, int firstBin, int lastBin)
+{
+    m_count = 0;
+    if (lastBin < firstBin) return 0;
+
+    // Power of bins firstBin - 1 .. lastBin + 1, and the mean log power of the band
+    const int length = lastBin - firstBin + 3;
+    if (static_cast<int>(m_power.size()) < length) m_power.resize(length);
+    double *power = m_power.data();
+    const std::complex<double> *band = spectrum + firstBin - 1;
+    double logSum = 0.0;
+    for (int i = 0; i < length; ++i) {
+        double p = band[i].real() * band[i].real() + band[i].imag() * band[i].imag();
+        power[i] = p;
+        logSum += std::log(p + TINY_POWER);
+    }
+    double meanLogPower = logSum / length;
+    m_noiseFloorDb = 10.0 * meanLogPower / std::log(10.0);
+
+    // Candidates must clear the prominence floor, and once the heap is full its minimum
+    double threshold = std::exp(meanLogPower + m_prominenceDb * std::log(10.0) / 10.0);
+    std::array<int, MAX_PEAKS> bins;
+    int heapSize = collectCandidates(power, length, threshold, m_maxPeaks, bins);
+
+    // Parabolic interpolation on log power (a Gaussian fit in linear terms)
+    for (int k = 0; k < heapSize; ++k) {
+        int i = bins[k];
+        double alpha = std::log(power[i - 1] + TINY_POWER);
+        double beta = std::log(power[i] + TINY_POWER);
+        double gamma = std::log(power[i + 1] + TINY_POWER);
+        double denominator = alpha - 2.0 * beta + gamma;
+        double offset = denominator < 0.0 ? 0.5 * (alpha - gamma) / denominator : 0.0;
+        double peakLogPower = beta - 0.25 * (alpha - gamma) * offset;
+
+        m_peaks[k].bin = firstBin - 1 + i + offset;
+        m_peaks[k].magnitude = std::exp(0.5 * peakLogPower);
+    }
+
+    return finishPeaks(heapSize);
+}
+
+int PeakPicker::pick(const Q15Complex* spectrum, int firstBin, int lastBin, int exponent)
+{
+    m_count = 0;
+    if (lastBin < firstBin) return 0;
+
+    // Same scan as the double version on Q16 log2 magnitudes, integer only per bin
+    const int length = lastBin - firstBin + 3;
+    if (static_cast<int>(m_logMagnitude.size()) < length) m_logMagnitude.resize(length);
+    int32_t *logMagnitude = m_logMagnitude.data();
+    const Q15Complex *band = spectrum + firstBin - 1;
+    int64_t logSum = 0;
+    for (int i = 0; i < length; ++i) {
+        logMagnitude[i] = FixedPoint::log2Q16(FixedPoint::approxMagnitude(band[i].re, band[i].im));
+        logSum += logMagnitude[i];
+    }
+    const int32_t meanLogMagnitude = static_cast<int32_t>(logSum / length);
+
+    // Magnitudes are data * 2^exponent in Q15, 0 dB is a magnitude of 1 as above
+    const double scaleDb = 20.0 * std::log10(2.0) * (exponent - 15);
+    m_noiseFloorDb = 2.0 * FixedPoint::log2Q16ToDb(meanLogMagnitude) + scaleDb;
+
+    const int32_t prominence = static_cast<int32_t>(m_prominenceDb / (20.0 * std::log10(2.0)) * 65536.0);
+    std::array<int, MAX_PEAKS> bins;
+    int heapSize = collectCandidates(logMagnitude, length, meanLogMagnitude + prominence, m_maxPeaks, bins);
+
+    // Interpolation uses the exact integer power of the three bins, only K times per frame
+    for (int k = 0; k < heapSize; ++k) {
+        int i = bins[k];
+        double alpha = FixedPoint::log2Q16(FixedPoint::power(band[i - 1])) / 65536.0;
+        double beta = FixedPoint::log2Q16(FixedPoint::power(band[i])) / 65536.0;
+        double gamma = FixedPoint::log2Q16(FixedPoint::power(band[i + 1])) / 65536.0;
+        double denominator = alpha - 2.0 * beta + gamma;
+        double offset = denominator < 0.0 ? 0.5 * (alpha - gamma) / denominator : 0.0;
+        double peakLog2Power = beta - 0.25 * (alpha - gamma) * offset;
+
+        m_peaks[k].bin = firstBin - 1 + i + offset;
+        m_peaks[k].magnitude = std::exp2(0.5 * peakLog2Power + exponent - 15);
+    }
+
+    return finishPeaks(heapSize);
+}
+
+int PeakPicker::finishPeaks(int heapSize)
+{
+    // K is small, an insertion sort keeps this allocation free
+    for (int k = 1; k < heapSize; ++k) {
+        Peak peak = m_peaks[k];
+        int j = k - 1;
+        while (j >= 0 && m_peaks[j].bin > peak.bin) {
+            m_peaks[j + 1] = m_peaks[j];
+            --j;
+        }
+        m_peaks[j + 1] = peak;
+    }
+
+    // Drop sidelobes of stronger neighbours
+    const double reach = SIDELOBE_REACH * m_padding;
+    const double sidelobeRatio = std::pow(10.0, -SIDELOBE_DB / 20.0);
+    int kept = 0;
+    for (int k = 0; k < heapSize; ++k) {
+        bool sidelobe = false;
+        for (int j = 0; j < heapSize && !sidelobe; ++j) {
+            sidelobe = std::abs(m_peaks[j].bin - m_peaks[k].bin) < reach &&
+                    m_peaks[k].magnitude < m_peaks[j].magnitude * sidelobeRatio;
+        }
+        if (!sidelobe) m_peaks[kept++] = m_peaks[k];
+    }
+
+    m_count = kept;
+    return m_count;
+}
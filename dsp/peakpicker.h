@@ -0,0 +1,69 @@
+#ifndef PEAKPICKER_H
+#define PEAKPICKER_H
+
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <vector>
+#include "fixedpoint.h"
+
+// Single pass spectral peak picker.
+// Power is computed for the whole band in one branch-free loop, then local
+// maxima are streamed through a fixed-size min-heap so only the K strongest
+// survive. Peaks are refined with a parabola on log power, which is the exact
+// fit for a Gaussian main lobe and close to it for a Hann window.
+// Ripples are rejected twice: a peak must clear the band's noise floor by the
+// prominence, and it must not sit in the sidelobe range of a much stronger one.
+// pick() allocates nothing once the scratch buffer has grown to the band size.
+class PeakPicker
+{
+public:
+    static constexpr int MAX_PEAKS = 32;
+    static constexpr double DEFAULT_PROMINENCE_DB = 20.0;
+    // Hann sidelobes stay 31 dB under their main lobe, within a few window bins
+    static constexpr double SIDELOBE_DB = 30.0;
+    static constexpr double SIDELOBE_REACH = 6.0;
+
+    struct Peak {
+        double bin = 0.0;        // Fractional bin of the interpolated maximum
+        double magnitude = 0.0;  // Interpolated linear magnitude
+    };
+
+    void setMaxPeaks(int count);
+    int maxPeaks() const { return m_maxPeaks; }
+
+    // Peaks must rise this far above the mean log power of the band
+    void setProminence(double db) { m_prominenceDb = db; }
+    double prominence() const { return m_prominenceDb; }
+
+    // Spectrum bins per bin of the unpadded window, i.e. the zero padding factor
+    void setPadding(double factor) { m_padding = factor; }
+
+    // Scans bins [firstBin, lastBin] of spectrum, which must be valid from
+    // firstBin - 1 to lastBin + 1. Returns the peak count, peaks() is then
+    // sorted by ascending bin.
+    int pick(const std::complex<double>* spectrum, int firstBin, int lastBin);
+    // Q15 spectrum in block floating point (value = data * 2^exponent); per-bin
+    // work is integer, peaks come out in the same units as the double version
+    int pick(const Q15Complex* spectrum, int firstBin, int lastBin, int exponent);
+
+    const Peak* peaks() const { return m_peaks.data(); }
+    int count() const { return m_count; }
+    // Mean log power of the last band in dB, 0 dB being a magnitude of 1
+    double noiseFloorDb() const { return m_noiseFloorDb; }
+
+private:
+    int m_maxPeaks = 5;
+    double m_prominenceDb = DEFAULT_PROMINENCE_DB;
+    double m_noiseFloorDb = 0.0;
+    double m_padding = 1.0;
+
+    int finishPeaks(int heapSize);
+
+    std::vector<double> m_power;
+    std::vector<int32_t> m_logMagnitude;
+    std::array<Peak, MAX_PEAKS> m_peaks;
+    int m_count = 0;
+};
+
+#endif // PEAKPICKER_H
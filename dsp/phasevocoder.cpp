@@ -0,0 +1,82 @@
+#include "phasevocoder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+double wrapPhase(double phase)
+{
+    return phase - 2.0 * M_PI * std::floor(phase / (2.0 * M_PI) + 0.5);
+}
+
+}
+
+void PhaseVocoder::reset()
+{
+    m_previous.fill(Partial());
+    m_size = 0;
+    m_frequency = 0.0;
+}
+
+double PhaseVocoder::refine(const std::complex<double> *spectrum, int size, int sampleRate, int hop,
+                            double coarseFrequency)
+{
+    // A different transform or hop breaks the phase chain
+    const bool continuous = size == m_size && hop == m_hop && sampleRate == m_sampleRate;
+    m_size = size;
+    m_hop = hop;
+    m_sampleRate = sampleRate;
+
+    const double binWidth = static_cast<double>(sampleRate) / size;
+    std::array<Partial, MAX_HARMONICS> current{};
+    std::array<double, MAX_HARMONICS> magnitudes{};
+    double strongest = 0.0;
+
+    // Local maximum near each harmonic, the bin whose phase is followed
+    for (int h = 0; h < MAX_HARMONICS; ++h) {
+        int bin = static_cast<int>(std::lround((h + 1) * coarseFrequency / binWidth));
+        if (bin < 2 || bin >= size / 2 - 1) break;
+        double magnitude = std::abs(spectrum[bin]);
+        for (int candidate : {bin - 1, bin + 1}) {
+            double candidateMagnitude = std::abs(spectrum[candidate]);
+            if (candidateMagnitude > magnitude) {
+                magnitude = candidateMagnitude;
+                bin = candidate;
+            }
+        }
+        current[h].bin = bin;
+        current[h].phase = std::arg(spectrum[bin]);
+        magnitudes[h] = magnitude;
+        strongest = std::max(strongest, magnitude);
+    }
+
+    double weightedFrequency = 0.0;
+    double weightedHarmonic = 0.0;
+    if (continuous && strongest > 0.0) {
+        const double expectedPerBin = 2.0 * M_PI * hop / size;
+        for (int h = 0; h < MAX_HARMONICS; ++h) {
+            const int bin = current[h].bin;
+            if (bin < 0 || bin != m_previous[h].bin || magnitudes[h] < HARMONIC_FLOOR * strongest) continue;
+
+            // Deviation from the bin centre's advance, unambiguous within sampleRate / (2 hop)
+            double deviation = wrapPhase(current[h].phase - m_previous[h].phase - expectedPerBin * bin);
+            double frequency = (bin + deviation / expectedPerBin) * binWidth;
+            if (std::abs(frequency - (h + 1) * coarseFrequency) > 2.0 * binWidth) continue;
+
+            // f0 = sum(w f_h) / sum(w h): higher harmonics weigh in by their finer resolution
+            weightedFrequency += magnitudes[h] * frequency;
+            weightedHarmonic += magnitudes[h] * (h + 1);
+        }
+    }
+
+    m_previous = current;
+    m_frequency = weightedHarmonic > 0.0 ? weightedFrequency / weightedHarmonic : 0.0;
+    return m_frequency;
+}
+
+double PhaseVocoder::phaseError(double targetFrequency) const
+{
+    if (m_frequency <= 0.0 || m_sampleRate <= 0) return 0.0;
+    return (m_frequency - targetFrequency) * m_hop / m_sampleRate;
+}
@@ -0,0 +1,45 @@
+#ifndef PHASEVOCODER_H
+#define PHASEVOCODER_H
+
+#include <array>
+#include <complex>
+
+// Phase-vocoder frequency refinement for overlapping frames.
+// Given the spectrum of a frame and a coarse fundamental, the phase of each
+// harmonic's bin is compared with the same bin of the previous frame,
+// taken hop samples earlier. The deviation from the advance expected for
+// the bin centre gives the instantaneous frequency within a small fraction
+// of a bin, so short unpadded frames reach sub-cent precision. The frames
+// must share transform size and window and be exactly hop samples apart,
+// callers reset() whenever that chain breaks.
+class PhaseVocoder
+{
+public:
+    static constexpr int MAX_HARMONICS = 8;
+
+    void reset();
+
+    // Refined fundamental in Hz, 0 when there is no usable previous frame
+    double refine(const std::complex<double> *spectrum, int size, int sampleRate, int hop,
+                  double coarseFrequency);
+
+    // Phase error of the fundamental against a reference at targetFrequency
+    // over the last hop, in cycles; drives the strobe display
+    double phaseError(double targetFrequency) const;
+
+private:
+    static constexpr double HARMONIC_FLOOR = 0.03;  // Harmonics 30 dB below the strongest are skipped
+
+    struct Partial {
+        int bin = -1;
+        double phase = 0.0;
+    };
+
+    std::array<Partial, MAX_HARMONICS> m_previous{};
+    int m_size = 0;
+    int m_hop = 0;
+    int m_sampleRate = 0;
+    double m_frequency = 0.0;  // Last refined fundamental
+};
+
+#endif // PHASEVOCODER_H
@@ -0,0 +1,469 @@
+#include "pitchdetector.h"
+#include "fftplan.h"
+#include "notetable.h"
+
+#include <algorithm>
+#include <cmath>
+
+int PitchDetector::paddedSize(int windowSize) const
+{
+    // The lag domain estimators need twice the window so their correlation is not circular
+    const Method method = m_settings.method;
+    int padding = m_settings.fftPadding;
+    if (method == Method::Autocorrelation || method == Method::Cepstrum || method == Method::Ensemble) {
+        padding = std::max(padding, 2);
+    }
+
+    // Extra zero padding up to a 2/3/5-smooth length keeps the transform off the Bluestein path
+    int size = windowSize * padding;
+    return m_settings.powerOfTwoPadding ? FftPlan::nextPowerOfTwo(size) : FftPlan::nextFastSize(size);
+}
+
+double PitchDetector::levelDb(const double *samples, int count)
+{
+    if (count <= 0) return -90.0; // Return minimal level if no samples
+
+    // Calculate RMS (Root Mean Square)
+    double sum = 0.0;
+    for (int i = 0; i < count; ++i) {
+        sum += samples[i] * samples[i];
+    }
+    double rms = std::sqrt(sum / count);
+
+    // Convert to dBFS (0 dBFS = maximum level = 1.0), clamped to -90 dB
+    return std::max(20 * std::log10(rms), -90.0);
+}
+
+PitchDetector::Result PitchDetector::analyze(const double *samples, int count)
+{
+    Result result;
+    result.levelDb = levelDb(samples, count);
+    m_peaks.clear();
+
+    // Only process frequency if signal is above threshold
+    if (result.levelDb <= m_settings.dbThreshold) {
+        m_vocoder.reset();
+        m_partials.reset();
+        return result;
+    }
+
+    result.aboveThreshold = true;
+    transform(samples, count);
+    result.spectrumValid = true;
+
+    // Spectral peaks are picked for every method, they are also what the engine displays
+    double peakConfidence = 0.0;
+    double peakFrequency = detectPeaks(count, peakConfidence);
+    result.frequency = estimate(peakFrequency, peakConfidence, result.confidence);
+
+    // The estimate names the note, its partials across frames pin down the pitch.
+    // A frame without a detection leaves the tracks to age on the next one
+    if (result.frequency > 0) {
+        // Partials must clear the band's noise floor by the same margin as picked peaks
+        const double noiseMagnitude = std::pow(10.0, (m_peakPicker.noiseFloorDb() + m_peakPicker.prominence()) / 20.0);
+        const PartialTracker::Fit &fit = m_partials.update(m_spectrum.data(), static_cast<int>(m_spectrum.size()),
+                                                           m_binWidth, static_cast<double>(m_settings.sampleRate) / count,
+                                                           noiseMagnitude, result.frequency);
+        // The fit refines the estimate, a fit somewhere else is a tracking error, not the pitch
+        if (m_settings.partialFit && fit.partialCount >= PartialTracker::MIN_FIT_PARTIALS &&
+            inBand(fit.frequency) &&
+            std::abs(1200.0 * std::log2(fit.frequency / result.frequency)) <= MAX_FIT_CENTS) {
+            result.frequency = fit.frequency;
+            result.partialCount = fit.partialCount;
+        }
+    }
+    result.inharmonicity = m_partials.fit().inharmonicity;
+    result.wolfTone = m_partials.fit().wolfTone;
+
+    // Reuses this frame's spectrum, the previous frame supplies the phases
+    if (m_settings.phaseHop > 0 && result.frequency > 0) {
+        double refined = m_vocoder.refine(m_spectrum.data(), static_cast<int>(m_spectrum.size()),
+                                          m_settings.sampleRate, m_settings.phaseHop, result.frequency);
+        if (refined > 0) {
+            result.frequency = refined;
+            result.phaseRefined = true;
+        }
+    } else {
+        m_vocoder.reset();
+    }
+    return result;
+}
+
+double PitchDetector::estimate(double peakFrequency, double peakConfidence, double &confidence)
+{
+    const SpectralEstimators::Band band{m_settings.minFrequency, m_settings.maxFrequency};
+    SpectralEstimators::Candidate candidate;
+
+    switch (m_settings.method) {
+    case Method::Fft:
+        candidate = {peakFrequency, peakConfidence};
+        break;
+    case Method::Autocorrelation:
+        candidate = m_estimators.autocorrelation(band);
+        break;
+    case Method::HarmonicSum:
+        candidate = m_estimators.harmonicSum(band);
+        break;
+    case Method::Cepstrum:
+        candidate = m_estimators.cepstrum(band);
+        break;
+    case Method::Ensemble: {
+        // Cepstrum and autocorrelation share one inverse transform, the rest is bin arithmetic.
+        // Finest frequency resolution first, see SpectralEstimators::fuse()
+        const SpectralEstimators::Candidate candidates[] = {
+            {peakFrequency, peakConfidence},
+            m_estimators.harmonicSum(band),
+            m_estimators.cepstrum(band),
+            m_estimators.autocorrelation(band)
+        };
+        candidate = SpectralEstimators::fuse(candidates, 4);
+        break;
+    }
+    }
+
+    if (candidate.frequency <= 0 || !inBand(candidate.frequency)) return 0;
+    confidence = candidate.confidence;
+    return candidate.frequency;
+}
+
+PitchDetector::Result PitchDetector::analyze(const int16_t *samples, int count)
+{
+    Result result;
+    result.levelDb = levelDb(samples, count);
+    m_peaks.clear();
+    m_vocoder.reset();
+    m_partials.reset();
+
+    if (result.levelDb <= m_settings.dbThreshold) return result;
+
+    result.aboveThreshold = true;
+    if (m_settings.method == Method::Autocorrelation) {
+        // Products of two Q15 samples are Q30
+        result.frequency = detectAutocorrelation<int16_t, int64_t>(samples, count, 1.0 / (1 << 30),
+                                                                   result.confidence);
+    } else {
+        result.frequency = detectFft(samples, count, result.confidence);
+        result.spectrumValid = true;
+    }
+    return result;
+}
+
+double PitchDetector::levelDb(const int16_t *samples, int count)
+{
+    if (count <= 0) return -90.0;
+
+    uint64_t sum = 0;
+    for (int i = 0; i < count; ++i) {
+        sum += static_cast<uint32_t>(samples[i] * samples[i]);
+    }
+
+    // Mean square relative to full scale (2^30), through the log table
+    int64_t log2MeanSquare = static_cast<int64_t>(FixedPoint::log2Q16(sum)) -
+            FixedPoint::log2Q16(static_cast<uint64_t>(count)) - (30 << 16);
+    return sum == 0 ? -90.0 : std::max(FixedPoint::log2Q16ToDb(log2MeanSquare), -90.0);
+}
+
+void PitchDetector::magnitudes(float *out, int count) const
+{
+    if (m_fixedSpectrumValid) {
+        const float scale = std::ldexp(1.0f, m_fixedExponent - 15);
+        for (int i = 0; i < count; ++i) {
+            out[i] = scale * std::sqrt(static_cast<float>(FixedPoint::power(m_fixedSpectrum[i])));
+        }
+    } else {
+        for (int i = 0; i < count; ++i) {
+            out[i] = static_cast<float>(std::abs(m_spectrum[i]));
+        }
+    }
+}
+
+int PitchDetector::spectrumSize() const
+{
+    return static_cast<int>(m_fixedSpectrumValid ? m_fixedSpectrum.size() : m_spectrum.size());
+}
+
+double PitchDetector::coarsePitch(const double *samples, int count)
+{
+    // 2x padded probe transform, only used to size the real analysis window
+    int size = FftPlan::nextPowerOfTwo(count * 2);
+    auto plan = FftPlan::forSize(size);
+    auto window = HannWindow::forLength(count);
+
+    m_probeSpectrum.assign(size, std::complex<double>(0, 0));
+    for (int i = 0; i < count; ++i) {
+        m_probeSpectrum[i] = std::complex<double>(samples[i] * (*window)[i], 0);
+    }
+    plan->transform(m_probeSpectrum.data());
+    const std::vector<std::complex<double>> &spectrum = m_probeSpectrum;
+
+    double freqStep = static_cast<double>(m_settings.sampleRate) / size;
+    int firstBin = std::max(1, static_cast<int>(std::ceil(m_settings.minFrequency / freqStep)));
+    int lastBin = std::min(size / 2 - 2, static_cast<int>(m_settings.maxFrequency / freqStep));
+
+    double maxMagnitude = 0;
+    for (int i = firstBin; i <= lastBin; ++i) {
+        maxMagnitude = std::max(maxMagnitude, std::abs(spectrum[i]));
+    }
+    if (maxMagnitude <= 0) return 0;
+
+    // Lowest strong local maximum, so a loud harmonic does not shrink the window
+    for (int i = firstBin; i <= lastBin; ++i) {
+        double magnitude = std::abs(spectrum[i]);
+        if (magnitude >= 0.3 * maxMagnitude &&
+            magnitude >= std::abs(spectrum[i - 1]) &&
+            magnitude >= std::abs(spectrum[i + 1])) {
+            return i * freqStep;
+        }
+    }
+    return 0;
+}
+
+void PitchDetector::transform(const double *samples, int count)
+{
+    m_fixedSpectrumValid = false;
+
+    // Hann window and zero padding for better frequency resolution
+    int size = paddedSize(count);
+    auto window = HannWindow::forLength(count);
+    m_spectrum.assign(size, std::complex<double>(0, 0));
+    for (int i = 0; i < count; ++i) {
+        m_spectrum[i] = std::complex<double>(samples[i] * (*window)[i], 0);
+    }
+
+    FftPlan::forSize(size)->transform(m_spectrum.data());
+    m_binWidth = static_cast<double>(m_settings.sampleRate) / size;
+    m_estimators.prepare(m_spectrum.data(), size, count, m_settings.sampleRate);
+}
+
+double PitchDetector::detectPeaks(int count, double &confidence)
+{
+    const int size = static_cast<int>(m_spectrum.size());
+
+    // Strongest peaks from the bottom of the band up to the harmonics of its top, sorted by frequency
+    int firstBin = std::max(1, static_cast<int>(std::ceil(m_settings.minFrequency / m_binWidth)));
+    int lastBin = std::min(size / 2 - 2, static_cast<int>(peakCeiling() / m_binWidth));
+    m_peakPicker.setMaxPeaks(m_settings.maxPeaks);
+    m_peakPicker.setPadding(static_cast<double>(size) / count);
+    int peakCount = m_peakPicker.pick(m_spectrum.data(), firstBin, lastBin);
+    return scorePickedPeaks(peakCount, confidence);
+}
+
+double PitchDetector::detectFft(const int16_t *samples, int count, double &confidence)
+{
+    m_fixedSpectrumValid = true;
+    int size = FftPlan::nextPowerOfTwo(count * m_settings.fftPadding);
+    auto window = FixedPoint::hannWindow(count);
+
+    // Scale the block up to 14 bits first, so quiet input keeps its precision through the transform
+    int32_t largest = 1;
+    for (int i = 0; i < count; ++i) {
+        largest = std::max(largest, std::abs(static_cast<int32_t>(samples[i])));
+    }
+    int headroom = 0;
+    while ((largest << (headroom + 1)) <= 16383) ++headroom;
+
+    m_fixedSpectrum.assign(size, Q15Complex());
+    for (int i = 0; i < count; ++i) {
+        int32_t scaled = static_cast<int32_t>(samples[i]) * (1 << headroom);
+        m_fixedSpectrum[i].re = static_cast<int16_t>((scaled * (*window)[i] + (1 << 14)) >> 15);
+    }
+    m_fixedExponent = FixedFftPlan::forSize(size)->transform(m_fixedSpectrum.data(), -headroom);
+    m_binWidth = static_cast<double>(m_settings.sampleRate) / size;
+
+    int firstBin = std::max(1, static_cast<int>(std::ceil(m_settings.minFrequency / m_binWidth)));
+    int lastBin = std::min(size / 2 - 2, static_cast<int>(peakCeiling() / m_binWidth));
+    m_peakPicker.setMaxPeaks(m_settings.maxPeaks);
+    m_peakPicker.setPadding(static_cast<double>(size) / count);
+    int peakCount = m_peakPicker.pick(m_fixedSpectrum.data(), firstBin, lastBin, m_fixedExponent);
+    return scorePickedPeaks(peakCount, confidence);
+}
+
+double PitchDetector::scorePickedPeaks(int peakCount, double &confidence)
+{
+    if (peakCount == 0) return 0;
+
+    double maxMagnitude = 0;
+    for (int i = 0; i < peakCount; i++) {
+        maxMagnitude = std::max(maxMagnitude, m_peakPicker.peaks()[i].magnitude);
+    }
+
+    // Normalized amplitudes for the harmonic analysis, the vector keeps its capacity
+    for (int i = 0; i < peakCount; i++) {
+        const PeakPicker::Peak &picked = m_peakPicker.peaks()[i];
+        Peak peak;
+        peak.frequency = picked.bin * m_binWidth;
+        peak.amplitude = picked.magnitude / maxMagnitude;
+        m_peaks.push_back(peak);
+    }
+
+    // Analyze harmonics for each peak
+    for (Peak &fundamental : m_peaks) {
+        analyzeHarmonics(fundamental);
+    }
+
+    const Peak *bestPeak = selectBestPeak();
+    if (!bestPeak) return 0;
+    confidence = noteProbability(*bestPeak);
+    return bestPeak->frequency;
+}
+
+template<typename Sample, typename Accumulator>
+double PitchDetector::detectAutocorrelation(const Sample *samples, int count, double scale, double &confidence)
+{
+    // Lags of the fundamental band only, a target string keeps this range short
+    const int sampleRate = m_settings.sampleRate;
+    int maxPeriod = std::min(count - 1, static_cast<int>(sampleRate / m_settings.minFrequency));
+    int minPeriod = std::max(2, static_cast<int>(sampleRate / m_settings.maxFrequency));
+
+    // Find correlation peaks
+    double lastCorrelation = 0;
+    bool rising = false;
+
+    for (int period = minPeriod; period <= maxPeriod; ++period) {
+        Accumulator sum = 0;
+        int validSamples = 0;
+
+        // Normalized autocorrelation, integer products on the Q15 path
+        for (int i = 0; i < count - period; ++i) {
+            sum += static_cast<Accumulator>(samples[i]) * samples[i + period];
+            validSamples++;
+        }
+
+        // Normalize by the number of samples
+        double correlation = static_cast<double>(sum) * scale;
+        if (validSamples > 0) {
+            correlation /= validSamples;
+        }
+
+        // Detect peaks
+        if (rising && correlation < lastCorrelation) {
+            // We just passed a peak
+            Peak peak;
+            peak.frequency = static_cast<double>(sampleRate) / (period - 1);
+            peak.amplitude = std::abs(lastCorrelation);
+            m_peaks.push_back(peak);
+            rising = false;
+        } else if (correlation > lastCorrelation) {
+            rising = true;
+        }
+
+        lastCorrelation = correlation;
+    }
+
+    if (m_peaks.empty()) return 0;
+
+    // Keep the five strongest correlation peaks, sorted by frequency to analyze harmonics
+    std::sort(m_peaks.begin(), m_peaks.end(),
+              [](const Peak &a, const Peak &b) { return a.amplitude > b.amplitude; });
+    m_peaks.resize(std::min<size_t>(5, m_peaks.size()));
+    std::sort(m_peaks.begin(), m_peaks.end(),
+              [](const Peak &a, const Peak &b) { return a.frequency < b.frequency; });
+
+    for (Peak &fundamental : m_peaks) {
+        analyzeHarmonics(fundamental);
+    }
+
+    // Find the peak with the most harmonics
+    // If multiple peaks have the same number of harmonics, take the lowest frequency
+    const Peak *bestPeak = nullptr;
+    for (const Peak &peak : m_peaks) {
+        if (!inBand(peak.frequency)) continue;
+        if (!bestPeak ||
+            peak.harmonicCount > bestPeak->harmonicCount ||
+            (peak.harmonicCount == bestPeak->harmonicCount && peak.frequency < bestPeak->frequency)) {
+            bestPeak = &peak;
+        }
+    }
+
+    if (!bestPeak) return 0;
+    confidence = noteProbability(*bestPeak);
+    return bestPeak->frequency;
+}
+
+void PitchDetector::analyzeHarmonics(Peak &fundamental) const
+{
+    int harmonicCount = 0;
+    double harmonicStrength = 0;
+
+    for (const Peak &peak : m_peaks) {
+        if (peak.frequency > fundamental.frequency) {
+            double ratio = peak.frequency / fundamental.frequency;
+
+            // Check against harmonics 2..6, weighted by how strong the instrument makes them
+            for (int harmonic = 2; harmonic <= HIGHEST_HARMONIC; ++harmonic) {
+                if (std::abs(ratio - harmonic) < 0.03) { // 3% tolerance
+                    harmonicCount++;
+                    harmonicStrength += peak.amplitude * m_settings.harmonicWeights[harmonic - 2];
+                    break;
+                }
+            }
+        }
+    }
+
+    fundamental.harmonicCount = harmonicCount;
+    fundamental.harmonicStrength = harmonicStrength;
+}
+
+double PitchDetector::noteProbability(const Peak &peak) const
+{
+    double probability = 0.0;
+
+    // Base probability from harmonic count
+    probability += peak.harmonicCount * 0.2;
+
+    // Add harmonic strength contribution
+    probability += std::min(peak.harmonicStrength, 0.3);
+
+    // Check proximity to note frequencies of the active temperament
+    if (m_noteTable) {
+        double centsDiff = std::abs(m_noteTable->nearest(peak.frequency).cents);
+        if (centsDiff < 50) { // Within 50 cents
+            probability += 0.3 * (1.0 - centsDiff / 50.0);
+        }
+    }
+
+    return std::min(probability, 1.0);
+}
+
+const PitchDetector::Peak *PitchDetector::selectBestPeak() const
+{
+    const Peak *bestPeak = nullptr;
+    double bestScore = 0;
+
+    for (const Peak &peak : m_peaks) {
+        // Peaks above the band only count as harmonics
+        if (!inBand(peak.frequency)) continue;
+
+        // Calculate base score from harmonics
+        double score = peak.harmonicCount * 2.0;
+
+        // Add probability score
+        score += noteProbability(peak) * 3.0;
+
+        // Prefer lower frequencies (fundamental over harmonics)
+        score += 1.0 / (1.0 + peak.frequency / 440.0);
+
+        // Amplitude contribution (smaller weight)
+        score += peak.amplitude * 0.5;
+
+        if (!bestPeak || score > bestScore) {
+            bestPeak = &peak;
+            bestScore = score;
+        }
+    }
+
+    // Only return if we're confident enough
+    return (bestScore > 2.0) ? bestPeak : nullptr;
+}
+
+bool PitchDetector::inBand(double frequency) const
+{
+    return frequency >= m_settings.minFrequency && frequency <= m_settings.maxFrequency;
+}
+
+double PitchDetector::peakCeiling() const
+{
+    // Harmonics of the band top, but no further up than the default band reaches
+    return std::max(m_settings.maxFrequency,
+                    std::min(HIGHEST_HARMONIC * m_settings.maxFrequency, MAX_FREQUENCY));
+}
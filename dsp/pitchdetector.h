@@ -0,0 +1,152 @@
+#ifndef PITCHDETECTOR_H
+#define PITCHDETECTOR_H
+
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <vector>
+#include "fixedpoint.h"
+#include "partialtracker.h"
+#include "peakpicker.h"
+#include "phasevocoder.h"
+#include "spectralestimators.h"
+
+class NoteTable;
+
+// Per-window pitch detection, the DSP half of TunerEngine.
+// Plain C++ so it can run without Qt (see tunerdsp.h). FFT plans and
+// window tables come from the shared caches, and every scratch buffer is
+// owned here, so analyzing windows of a known size does not allocate.
+// Each frame is windowed and transformed once; the spectral peak picker and
+// the SpectralEstimators all read that spectrum, and Ensemble fuses them.
+// The partials of the detected note are tracked across frames and their
+// fitted series can refine the single peak (PartialTracker).
+// One detector per thread.
+class PitchDetector
+{
+public:
+    static constexpr double MIN_FREQUENCY = 50.0;
+    static constexpr double MAX_FREQUENCY = 1500.0;  // Also the default reach for harmonics
+    static constexpr int HIGHEST_HARMONIC = 6;
+    static constexpr double MAX_FIT_CENTS = 5.0;     // Largest correction by the partial fit, see Settings
+
+    // Estimators over the shared spectrum, dispatched by a switch in estimate()
+    enum class Method {
+        Fft,              // Spectral peaks scored by their harmonics
+        Autocorrelation,  // Inverse transform of the power spectrum
+        HarmonicSum,
+        Cepstrum,
+        Ensemble          // All of the above, fused by confidence
+    };
+
+    struct Settings {
+        int sampleRate = 48000;
+        int fftPadding = 2;
+        bool powerOfTwoPadding = false;  // For varying window sizes, see paddedSize()
+        Method method = Method::Fft;
+        double dbThreshold = -70.0;
+        int maxPeaks = 10;
+        // Band searched for the fundamental, see instrumentprofile.h
+        double minFrequency = MIN_FREQUENCY;
+        double maxFrequency = MAX_FREQUENCY;
+        // Expected strength of harmonics 2..6, relative to the fundamental
+        std::array<double, 5> harmonicWeights = {1.0 / 2, 1.0 / 3, 1.0 / 4, 1.0 / 5, 1.0 / 6};
+        // Consecutive FFT frames overlap, starting this many samples apart:
+        // the fundamental is refined from their phase advance (PhaseVocoder)
+        int phaseHop = 0;
+        // The tracked partial series replaces the estimator's frequency when
+        // the two agree within MAX_FIT_CENTS, the tracks, B and wolf tones are
+        // followed either way (double path only)
+        bool partialFit = false;
+    };
+
+    struct Peak {
+        double frequency = 0.0;
+        double amplitude = 0.0;  // Relative to the strongest peak of the window
+        int harmonicCount = 0;
+        double harmonicStrength = 0.0;
+    };
+
+    struct Result {
+        double levelDb = -90.0;
+        bool aboveThreshold = false;
+        double frequency = 0.0;    // 0 when nothing was detected
+        double confidence = 0.0;   // 0..1
+        bool spectrumValid = false;
+        bool phaseRefined = false;  // frequency came from the phase vocoder
+        int partialCount = 0;       // Partials behind frequency, 0 when it is the estimator's own
+        double inharmonicity = 0.0; // String stiffness B of the tracked partials
+        bool wolfTone = false;      // A low partial is unstable, see PartialTracker
+    };
+
+    void setSettings(const Settings &settings) { m_settings = settings; }
+    const Settings &settings() const { return m_settings; }
+
+    // Candidates are scored by their distance to the nearest note of this table
+    void setNoteTable(const NoteTable *noteTable) { m_noteTable = noteTable; }
+
+    Result analyze(const double *samples, int count);
+    // Q15 pipeline on the raw int16 samples: block floating-point radix-2 FFT
+    // (the padded size is always a power of two), integer magnitudes and
+    // table logarithms. Only Fft and a time-domain Autocorrelation exist on
+    // this path, the other methods fall back to Fft; no phase refinement and
+    // no partial tracking.
+    Result analyze(const int16_t *samples, int count);
+
+    // Candidate peaks of the last analyzed window, sorted by frequency
+    const std::vector<Peak> &peaks() const { return m_peaks; }
+    // Linear magnitudes of the first count bins of the last window's spectrum
+    // when Result::spectrumValid, from either pipeline
+    void magnitudes(float *out, int count) const;
+    int spectrumSize() const;
+    double binWidth() const { return m_binWidth; }
+
+    // Phase error of the last refined frame against a reference pitch, in cycles per hop
+    double phaseError(double targetFrequency) const { return m_vocoder.phaseError(targetFrequency); }
+    // Breaks the phase chain, the next frame is not refined
+    void resetPhase() { m_vocoder.reset(); }
+
+    // Partial tracks of the current note, from the last analyzed window
+    const PartialTracker &partialTracker() const { return m_partials; }
+
+    // Transform length for a window: zero padded up to a 2/3/5-smooth size,
+    // or a power of two so varying window sizes share few cached plans
+    int paddedSize(int windowSize) const;
+
+    // Lowest strong spectral peak of a short probe, 0 if none
+    double coarsePitch(const double *samples, int count);
+
+    static double levelDb(const double *samples, int count);
+    static double levelDb(const int16_t *samples, int count);
+
+private:
+    void transform(const double *samples, int count);
+    double estimate(double peakFrequency, double peakConfidence, double &confidence);
+    double detectPeaks(int count, double &confidence);
+    double detectFft(const int16_t *samples, int count, double &confidence);
+    double scorePickedPeaks(int peakCount, double &confidence);
+    template<typename Sample, typename Accumulator>
+    double detectAutocorrelation(const Sample *samples, int count, double scale, double &confidence);
+    void analyzeHarmonics(Peak &fundamental) const;
+    double noteProbability(const Peak &peak) const;
+    const Peak *selectBestPeak() const;
+    bool inBand(double frequency) const;
+    double peakCeiling() const;
+
+    Settings m_settings;
+    const NoteTable *m_noteTable = nullptr;
+    PeakPicker m_peakPicker;
+    PhaseVocoder m_vocoder;
+    PartialTracker m_partials;
+    SpectralEstimators m_estimators;
+
+    std::vector<std::complex<double>> m_spectrum;
+    std::vector<Q15Complex> m_fixedSpectrum;
+    int m_fixedExponent = 0;
+    bool m_fixedSpectrumValid = false;  // Which of the two spectra the last window filled
+    std::vector<std::complex<double>> m_probeSpectrum;
+    std::vector<Peak> m_peaks;
+    double m_binWidth = 0.0;
+};
+
+#endif // PITCHDETECTOR_H
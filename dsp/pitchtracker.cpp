@@ -0,0 +1,98 @@
+#include "pitchtracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+double toPitch(double frequency) { return 1200.0 * std::log2(frequency); }
+double toFrequency(double pitch) { return std::exp2(pitch / 1200.0); }
+
+}
+
+void PitchTracker::reset()
+{
+    m_active = false;
+    m_outlierCount = 0;
+    m_missCount = 0;
+}
+
+void PitchTracker::seed(double pitch, double variance)
+{
+    m_active = true;
+    m_pitch = pitch;
+    m_variance = variance;
+    m_outlierCount = 0;
+    m_missCount = 0;
+}
+
+PitchTracker::Estimate PitchTracker::update(double frequency, double confidence)
+{
+    if (frequency <= 0) return miss();
+
+    double observed = toPitch(frequency);
+    double measurementVariance = MEASUREMENT_STDDEV * MEASUREMENT_STDDEV / std::max(confidence, MIN_CONFIDENCE);
+
+    if (!m_active) {
+        seed(observed, measurementVariance);
+        return current();
+    }
+
+    // Predict
+    m_variance += PROCESS_STDDEV * PROCESS_STDDEV;
+    m_missCount = 0;
+
+    double innovation = observed - m_pitch;
+    double gate = std::max(GATE_CENTS, 3.0 * std::sqrt(m_variance + measurementVariance));
+    if (std::abs(innovation) > gate) {
+        // Octave slips and transients are ignored unless the new pitch persists
+        if (m_outlierCount > 0 && std::abs(observed - m_outlierPitch) < JUMP_AGREEMENT_CENTS) {
+            ++m_outlierCount;
+        } else {
+            m_outlierCount = 1;
+            m_outlierPitch = observed;
+        }
+        if (m_outlierCount >= JUMP_FRAMES) {
+            seed(observed, measurementVariance);
+        }
+        return current();
+    }
+    m_outlierCount = 0;
+
+    // Correct
+    double gain = m_variance / (m_variance + measurementVariance);
+    m_pitch += gain * innovation;
+    m_variance *= (1.0 - gain);
+    return current();
+}
+
+PitchTracker::Estimate PitchTracker::miss()
+{
+    if (!m_active) return Estimate();
+    if (++m_missCount > MAX_MISSES) {
+        reset();
+        return Estimate();
+    }
+    m_variance += PROCESS_STDDEV * PROCESS_STDDEV;
+    return current();
+}
+
+void PitchTracker::skip(int frames)
+{
+    if (!m_active || frames <= 0) return;
+    m_variance += frames * PROCESS_STDDEV * PROCESS_STDDEV;
+    // A jump needs agreeing consecutive frames, the gap breaks the run
+    m_outlierCount = 0;
+}
+
+PitchTracker::Estimate PitchTracker::current() const
+{
+    Estimate estimate;
+    if (!m_active) return estimate;
+
+    double stddev = std::sqrt(m_variance);
+    estimate.frequency = toFrequency(m_pitch);
+    estimate.confidence = 1.0 / (1.0 + stddev / LOCK_STDDEV);
+    estimate.locked = stddev < LOCK_STDDEV;
+    return estimate;
+}
@@ -0,0 +1,53 @@
+#ifndef PITCHTRACKER_H
+#define PITCHTRACKER_H
+
+// Incremental pitch tracker: a scalar Kalman filter on log-frequency (cents).
+// Every observation updates the estimate at O(1) cost, so a result is
+// available from the first frame, with a confidence that grows as the
+// variance shrinks. Vibrato averages out around its centre because the
+// process noise is small compared to the vibrato depth, while a sustained
+// jump to another note re-seeds the filter after two agreeing frames.
+class PitchTracker
+{
+public:
+    struct Estimate {
+        double frequency = 0.0;
+        double confidence = 0.0;  // 0..1
+        bool locked = false;      // Standard deviation below LOCK_STDDEV
+    };
+
+    void reset();
+
+    // confidence is the detector's 0..1 score for this observation
+    Estimate update(double frequency, double confidence);
+
+    // A frame above threshold where the detector found nothing
+    Estimate miss();
+
+    // Frames dropped unanalyzed: the estimate ages as if each had been
+    // predicted without an observation, so the lock reflects the gap
+    void skip(int frames);
+
+    Estimate current() const;
+
+private:
+    static constexpr double PROCESS_STDDEV = 4.0;        // Cents of drift allowed per frame
+    static constexpr double MEASUREMENT_STDDEV = 12.0;   // Cents, for a fully confident detection
+    static constexpr double MIN_CONFIDENCE = 0.05;
+    static constexpr double GATE_CENTS = 80.0;           // Beyond this an observation is an outlier
+    static constexpr double JUMP_AGREEMENT_CENTS = 50.0; // Outliers this close count as a new note
+    static constexpr int JUMP_FRAMES = 2;
+    static constexpr int MAX_MISSES = 4;
+    static constexpr double LOCK_STDDEV = 10.0;
+
+    void seed(double pitch, double variance);
+
+    bool m_active = false;
+    double m_pitch = 0.0;     // Cents above 1 Hz
+    double m_variance = 0.0;  // Cents^2
+    double m_outlierPitch = 0.0;
+    int m_outlierCount = 0;
+    int m_missCount = 0;
+};
+
+#endif // PITCHTRACKER_H
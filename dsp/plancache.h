@@ -0,0 +1,56 @@
+#ifndef PLANCACHE_H
+#define PLANCACHE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Bounded cache of shared plans or tables keyed by size, least recently used
+// evicted first. Hot reconfiguration can walk through any number of sizes,
+// only the last few stay resident; an evicted entry lives on for as long as
+// a caller still holds it. Lookups are a short linear scan under a mutex.
+template <typename T>
+class PlanCache
+{
+public:
+    explicit PlanCache(std::size_t capacity) : m_capacity(capacity) {}
+
+    // build(size) runs outside the lock, it may itself ask a cache for other sizes
+    template <typename Build>
+    std::shared_ptr<const T> get(int size, Build build)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (std::shared_ptr<const T> found = findLocked(size)) return found;
+        }
+
+        std::shared_ptr<const T> built = build(size);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Another thread may have built the same size meanwhile, keep one
+        if (std::shared_ptr<const T> found = findLocked(size)) return found;
+        if (m_entries.size() == m_capacity) m_entries.pop_back();
+        m_entries.insert(m_entries.begin(), {size, built});
+        return built;
+    }
+
+private:
+    std::shared_ptr<const T> findLocked(int size)
+    {
+        for (std::size_t i = 0; i < m_entries.size(); ++i) {
+            if (m_entries[i].first != size) continue;
+            std::rotate(m_entries.begin(), m_entries.begin() + i, m_entries.begin() + i + 1);
+            return m_entries.front().second;
+        }
+        return nullptr;
+    }
+
+    std::size_t m_capacity;
+    std::mutex m_mutex;
+    std::vector<std::pair<int, std::shared_ptr<const T>>> m_entries;  // Most recently used first
+};
+
+#endif // PLANCACHE_H
@@ -0,0 +1,143 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+// Single-writer, multi-reader publication of a trivially copyable value.
+// Two copies alternate: the writer fills the one readers were not sent to,
+// marking its sequence odd meanwhile, then bumps the version. A reader copies
+// the newest copy and retries only when the writer lapped it, two stores
+// during one read. The value is moved in relaxed atomic words, so there is
+// no data race, and neither side ever blocks or allocates.
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock copies the value bytewise");
+
+public:
+    // Writer thread only
+    void store(const T &value)
+    {
+        const uint64_t version = m_version.load(std::memory_order_relaxed) + 1;
+        Slot &slot = m_slots[version & 1];
+
+        std::array<uint64_t, WORDS> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        slot.sequence.store(version << 1 | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i = 0; i < WORDS; ++i) slot.words[i].store(words[i], std::memory_order_relaxed);
+        slot.sequence.store(version << 1, std::memory_order_release);
+        m_version.store(version, std::memory_order_release);
+    }
+
+    // Any thread. The newest complete value, T() before the first store
+    T load(uint64_t *version = nullptr) const
+    {
+        std::array<uint64_t, WORDS> words;
+        for (;;) {
+            const uint64_t current = m_version.load(std::memory_order_acquire);
+            if (current == 0) {
+                if (version) *version = 0;
+                return T();
+            }
+            const Slot &slot = m_slots[current & 1];
+            if (slot.sequence.load(std::memory_order_acquire) != current << 1) continue;
+
+            for (int i = 0; i < WORDS; ++i) words[i] = slot.words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != current << 1) continue;
+
+            T value;
+            std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+            if (version) *version = current;
+            return value;
+        }
+    }
+
+    // Number of stores so far
+    uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+
+private:
+    static constexpr int WORDS = static_cast<int>((sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  // version << 1, odd while being written
+        std::array<std::atomic<uint64_t>, WORDS> words{};
+    };
+
+    std::array<Slot, 2> m_slots;
+    std::atomic<uint64_t> m_version{0};
+};
+
+// Ring of float arrays allocated once, for payloads too large to copy on
+// every read. Pointers stay valid for the ring's lifetime; each slot carries
+// a sequence like SeqLock's, and a reader that used a slot in place checks
+// unchanged() afterwards to know the writer did not come round to it. With
+// n slots that takes n - 1 further writes. Values are stored and loaded as
+// relaxed atomics through std::atomic_ref, so a lapped reader sees a mix of
+// frames that unchanged() rejects, never a data race.
+class SeqLockRing
+{
+    static_assert(std::atomic_ref<float>::required_alignment <= alignof(float),
+                  "the payload is allocated as a plain float array");
+
+public:
+    struct Ticket {
+        const float *data = nullptr;  // Read through value(), the writer may be storing meanwhile
+        int count = 0;
+        int slot = -1;
+        uint64_t sequence = 0;
+
+        float value(int index) const
+        {
+            return std::atomic_ref<float>(const_cast<float &>(data[index])).load(std::memory_order_relaxed);
+        }
+    };
+
+    // Not while readers hold tickets
+    void allocate(int slotCount, int capacity)
+    {
+        m_slotCount = slotCount;
+        m_capacity = capacity;
+        m_data = std::make_unique<float[]>(static_cast<size_t>(slotCount) * capacity);
+        m_sequences = std::make_unique<std::atomic<uint64_t>[]>(slotCount);
+        m_writes = 0;
+    }
+    int capacity() const { return m_capacity; }
+
+    // Writer thread only: publishes up to capacity() values
+    Ticket write(const float *values, int count)
+    {
+        const int slot = static_cast<int>(m_writes % m_slotCount);
+        float *data = m_data.get() + static_cast<size_t>(slot) * m_capacity;
+        m_sequences[slot].store((m_writes + 1) << 1 | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i = 0; i < count; ++i) std::atomic_ref<float>(data[i]).store(values[i], std::memory_order_relaxed);
+        ++m_writes;
+        m_sequences[slot].store(m_writes << 1, std::memory_order_release);
+        return {data, count, slot, m_writes << 1};
+    }
+
+    // Any thread, after reading the ticket's values
+    bool unchanged(const Ticket &ticket) const
+    {
+        if (ticket.slot < 0) return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_sequences[ticket.slot].load(std::memory_order_relaxed) == ticket.sequence;
+    }
+
+private:
+    std::unique_ptr<float[]> m_data;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_sequences;
+    int m_slotCount = 0;
+    int m_capacity = 0;
+    uint64_t m_writes = 0;
+};
+
+#endif // SEQLOCK_H
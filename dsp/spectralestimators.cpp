@@ -0,0 +1,262 @@
+#include "spectralestimators.h"
+#include "fftplan.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+// Offset of the vertex of the parabola through three neighbouring values, in [-0.5, 0.5]
+double parabolicOffset(double left, double centre, double right)
+{
+    double denominator = left - 2.0 * centre + right;
+    if (denominator >= 0.0) return 0.0;
+    return std::clamp(0.5 * (left - right) / denominator, -0.5, 0.5);
+}
+
+// Autocorrelation of a Hann window at lag fraction x of its length, normalized to 1 at x = 0
+double hannAutocorrelation(double x)
+{
+    return (1.0 - x) * (2.0 / 3.0 + std::cos(2.0 * M_PI * x) / 3.0) + std::sin(2.0 * M_PI * x) / (2.0 * M_PI);
+}
+
+}
+
+void SpectralEstimators::prepare(const std::complex<double> *spectrum, int size, int windowLength, int sampleRate)
+{
+    m_spectrum = spectrum;
+    m_size = size;
+    m_windowLength = windowLength;
+    m_sampleRate = sampleRate;
+    m_magnitudeBins = 0;
+    m_lagDomainValid = false;
+}
+
+void SpectralEstimators::computeMagnitudes(int lastBin)
+{
+    lastBin = std::min(lastBin, m_size / 2);
+    if (lastBin < m_magnitudeBins) return;
+    if (static_cast<int>(m_magnitudes.size()) <= lastBin) m_magnitudes.resize(lastBin + 1);
+    for (int bin = m_magnitudeBins; bin <= lastBin; ++bin) {
+        m_magnitudes[bin] = std::abs(m_spectrum[bin]);
+    }
+    m_magnitudeBins = lastBin + 1;
+}
+
+void SpectralEstimators::computeLagDomain()
+{
+    if (m_lagDomainValid) return;
+    m_lagDomain.resize(m_size);
+
+    double strongest = 0.0;
+    for (int k = 0; k < m_size; ++k) strongest = std::max(strongest, std::norm(m_spectrum[k]));
+    const double floor = strongest > 0.0 ? LOG_FLOOR * strongest : 1e-300;
+
+    // Both sequences are real and even, so the forward transform is the
+    // inverse up to a 1/size scale, which the estimators do not need
+    for (int k = 0; k < m_size; ++k) {
+        double power = std::norm(m_spectrum[k]);
+        m_lagDomain[k] = std::complex<double>(std::log(power + floor), power);
+    }
+    FftPlan::forSize(m_size)->transform(m_lagDomain.data());
+    m_lagDomainValid = true;
+}
+
+SpectralEstimators::Candidate SpectralEstimators::harmonicSum(const Band &band)
+{
+    const double binWidth = static_cast<double>(m_sampleRate) / m_size;
+    const int firstBin = std::max(2, static_cast<int>(std::ceil(band.minFrequency / binWidth)));
+    const int lastBin = std::min(m_size / 2 / HARMONICS - 1, static_cast<int>(band.maxFrequency / binWidth));
+    if (firstBin > lastBin) return Candidate();
+
+    const int topBin = std::min(m_size / 2 - 1, HARMONICS * lastBin + HARMONICS / 2 + 1);
+    computeMagnitudes(topBin + 1);
+    const std::vector<double> &magnitude = m_magnitudes;
+
+    // Harmonic h of a candidate between two bins lands up to h/2 bins off h * bin
+    auto peakNear = [&](int centre, int radius) {
+        int best = std::clamp(centre, 1, topBin);
+        for (int bin = std::max(1, centre - radius); bin <= std::min(topBin, centre + radius); ++bin) {
+            if (magnitude[bin] > magnitude[best]) best = bin;
+        }
+        return best;
+    };
+
+    int bestBin = -1;
+    double bestScore = 0.0;
+    for (int bin = firstBin; bin <= lastBin; ++bin) {
+        double score = magnitude[bin];
+        double weight = 1.0;
+        for (int h = 2; h <= HARMONICS; ++h) {
+            weight *= HARMONIC_DECAY;
+            score += weight * magnitude[peakNear(h * bin, h / 2)];
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            bestBin = bin;
+        }
+    }
+    if (bestBin < 0) return Candidate();
+
+    // Refine from the interpolated harmonic peaks, higher harmonics resolve the fundamental finer
+    std::array<int, HARMONICS> peaks{};
+    double strongest = 0.0;
+    for (int h = 1; h <= HARMONICS; ++h) {
+        peaks[h - 1] = peakNear(h * bestBin, std::max(1, h / 2));
+        strongest = std::max(strongest, magnitude[peaks[h - 1]]);
+    }
+    double weightedFrequency = 0.0;
+    double totalWeight = 0.0;
+    for (int h = 1; h <= HARMONICS; ++h) {
+        const int bin = peaks[h - 1];
+        if (bin <= 1 || bin >= topBin || magnitude[bin] < 0.1 * strongest) continue;
+        if (magnitude[bin] < magnitude[bin - 1] || magnitude[bin] < magnitude[bin + 1]) continue;
+        double offset = parabolicOffset(std::log(magnitude[bin - 1] + 1e-300), std::log(magnitude[bin]),
+                                        std::log(magnitude[bin + 1] + 1e-300));
+        double weight = h * magnitude[bin];
+        weightedFrequency += weight * binFrequency(bin + offset) / h;
+        totalWeight += weight;
+    }
+    if (totalWeight <= 0.0) return Candidate();
+
+    Candidate candidate;
+    candidate.frequency = weightedFrequency / totalWeight;
+
+    // Share of the energy up to the last harmonic that sits in the harmonics' main lobes
+    const double fundamentalBins = candidate.frequency / binWidth;
+    const int lobe = std::max(1, 2 * m_size / m_windowLength);
+    const int upperBin = std::min(topBin, static_cast<int>((HARMONICS + 0.5) * fundamentalBins));
+    double total = 0.0;
+    for (int bin = 1; bin <= upperBin; ++bin) total += magnitude[bin] * magnitude[bin];
+    double explained = 0.0;
+    for (int h = 1; h <= HARMONICS; ++h) {
+        int centre = static_cast<int>(std::lround(h * fundamentalBins));
+        for (int bin = std::max(1, centre - lobe); bin <= std::min(upperBin, centre + lobe); ++bin) {
+            explained += magnitude[bin] * magnitude[bin];
+        }
+    }
+    candidate.confidence = total > 0.0 ? std::min(explained / total, 1.0) : 0.0;
+    return candidate;
+}
+
+SpectralEstimators::Candidate SpectralEstimators::cepstrum(const Band &band)
+{
+    computeLagDomain();
+    const int minLag = std::max(2, static_cast<int>(m_sampleRate / band.maxFrequency));
+    const int maxLag = std::min(m_size / 2 - 2, static_cast<int>(std::ceil(m_sampleRate / band.minFrequency)));
+    if (minLag >= maxLag) return Candidate();
+
+    auto value = [this](int lag) { return m_lagDomain[lag].real(); };
+
+    // The strongest local maximum, the spectral envelope makes the range edges rise
+    int bestLag = -1;
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    for (int lag = minLag; lag <= maxLag; ++lag) {
+        double v = value(lag);
+        sum += v;
+        sumSquares += v * v;
+        if (v > value(lag - 1) && v >= value(lag + 1) && (bestLag < 0 || v > value(bestLag))) bestLag = lag;
+    }
+    if (bestLag < 0) return Candidate();
+
+    const int count = maxLag - minLag + 1;
+    const double mean = sum / count;
+    const double deviation = std::sqrt(std::max(sumSquares / count - mean * mean, 0.0));
+    if (deviation <= 0.0) return Candidate();
+
+    Candidate candidate;
+    double lag = bestLag + parabolicOffset(value(bestLag - 1), value(bestLag), value(bestLag + 1));
+    candidate.frequency = m_sampleRate / lag;
+    // A rahmonic a few deviations above the rest of the range is a clear period
+    double prominence = (value(bestLag) - mean) / deviation;
+    candidate.confidence = std::clamp((prominence - 3.0) / 6.0, 0.0, 1.0);
+    return candidate;
+}
+
+SpectralEstimators::Candidate SpectralEstimators::autocorrelation(const Band &band)
+{
+    computeLagDomain();
+    const double energy = m_lagDomain[0].imag();
+    const int minLag = std::max(2, static_cast<int>(m_sampleRate / band.maxFrequency));
+    const int maxLag = std::min({m_windowLength / 2, m_size / 2 - 2,
+                                 static_cast<int>(std::ceil(m_sampleRate / band.minFrequency))});
+    if (energy <= 0.0 || minLag >= maxLag) return Candidate();
+
+    auto normalized = [&](int lag) {
+        return m_lagDomain[lag].imag() / energy / hannAutocorrelation(static_cast<double>(lag) / m_windowLength);
+    };
+
+    // Leave the lobe around lag 0 first
+    int start = 1;
+    while (start < maxLag && normalized(start) > 0.0) ++start;
+    start = std::max(start, minLag);
+
+    // Key maxima: the highest point of each positive region. The pitch is the
+    // first one close to the highest, later ones are multiples of the period
+    auto forEachKeyMaximum = [&](auto &&visit) {
+        int regionBest = -1;
+        for (int lag = start; lag <= maxLag; ++lag) {
+            double v = normalized(lag);
+            if (v > 0.0) {
+                if (regionBest < 0 || v > normalized(regionBest)) regionBest = lag;
+            } else if (regionBest >= 0) {
+                if (visit(regionBest)) return;
+                regionBest = -1;
+            }
+        }
+        if (regionBest >= 0 && regionBest < maxLag) visit(regionBest);
+    };
+
+    double highest = 0.0;
+    forEachKeyMaximum([&](int lag) { highest = std::max(highest, normalized(lag)); return false; });
+    if (highest <= 0.0) return Candidate();
+
+    int pitchLag = -1;
+    forEachKeyMaximum([&](int lag) {
+        if (normalized(lag) < KEY_MAXIMUM_RATIO * highest) return false;
+        pitchLag = lag;
+        return true;
+    });
+    if (pitchLag <= 1) return Candidate();
+
+    Candidate candidate;
+    double lag = pitchLag + parabolicOffset(normalized(pitchLag - 1), normalized(pitchLag), normalized(pitchLag + 1));
+    candidate.frequency = m_sampleRate / lag;
+    candidate.confidence = std::clamp(normalized(pitchLag), 0.0, 1.0);
+    return candidate;
+}
+
+SpectralEstimators::Candidate SpectralEstimators::fuse(const Candidate *candidates, int count)
+{
+    auto agree = [](const Candidate &a, const Candidate &b) {
+        return std::abs(1200.0 * std::log2(a.frequency / b.frequency)) <= FUSION_CENTS;
+    };
+
+    int centre = -1;
+    double bestScore = 0.0;
+    for (int i = 0; i < count; ++i) {
+        if (candidates[i].frequency <= 0.0 || candidates[i].confidence <= 0.0) continue;
+        double score = 0.0;
+        for (int j = 0; j < count; ++j) {
+            if (candidates[j].frequency > 0.0 && agree(candidates[i], candidates[j])) score += candidates[j].confidence;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            centre = i;
+        }
+    }
+    if (centre < 0) return Candidate();
+
+    // Averaging in the coarse lag domain estimates would only blur the finest one
+    Candidate fused;
+    for (int j = 0; j < count; ++j) {
+        if (candidates[j].frequency > 0.0 && agree(candidates[centre], candidates[j])) {
+            fused.frequency = candidates[j].frequency;
+            break;
+        }
+    }
+    fused.confidence = std::min(bestScore / count, 1.0);
+    return fused;
+}
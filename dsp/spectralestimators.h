@@ -0,0 +1,66 @@
+#ifndef SPECTRALESTIMATORS_H
+#define SPECTRALESTIMATORS_H
+
+#include <complex>
+#include <vector>
+
+// Pitch estimators that read the one windowed, zero-padded spectrum a frame
+// already has, instead of preprocessing the samples again:
+//  - harmonic sum: magnitudes at the first harmonics of each candidate bin,
+//    decaying slowly so a weak fundamental still beats its octave (Hermes)
+//  - cepstrum: peak quefrency of the inverse transform of the log power spectrum
+//  - autocorrelation: inverse transform of the power spectrum, unbiased by the
+//    Hann window's own autocorrelation, first maximum near the highest (NSDF style)
+// Cepstrum and autocorrelation are both transforms of real, even sequences,
+// so one complex transform of (log power + i power) yields both.
+// Scratch is owned here and reused, one instance per detector.
+class SpectralEstimators
+{
+public:
+    struct Candidate {
+        double frequency = 0.0;   // 0 when the estimator found nothing
+        double confidence = 0.0;  // 0..1
+    };
+
+    struct Band {
+        double minFrequency = 0.0;
+        double maxFrequency = 0.0;
+    };
+
+    static constexpr int HARMONICS = 6;
+
+    // spectrum holds size bins of a Hann-windowed frame of windowLength
+    // samples; it must stay valid until the next prepare()
+    void prepare(const std::complex<double> *spectrum, int size, int windowLength, int sampleRate);
+
+    Candidate harmonicSum(const Band &band);
+    Candidate cepstrum(const Band &band);
+    Candidate autocorrelation(const Band &band);
+
+    // Candidates within FUSION_CENTS of each other vote with their confidence.
+    // They are ordered from the finest frequency resolution to the coarsest,
+    // the winning cluster reports the frequency of its first member
+    static Candidate fuse(const Candidate *candidates, int count);
+
+private:
+    static constexpr double FUSION_CENTS = 30.0;
+    static constexpr double HARMONIC_DECAY = 0.84;    // Weight ratio of successive harmonics
+    static constexpr double KEY_MAXIMUM_RATIO = 0.9;  // First autocorrelation peak this close to the highest
+    static constexpr double LOG_FLOOR = 1e-2;        // Log power floor, -20 dB below the strongest bin
+
+    void computeMagnitudes(int lastBin);
+    void computeLagDomain();
+    double binFrequency(double bin) const { return bin * m_sampleRate / m_size; }
+
+    const std::complex<double> *m_spectrum = nullptr;
+    int m_size = 0;
+    int m_windowLength = 0;
+    int m_sampleRate = 0;
+
+    std::vector<double> m_magnitudes;
+    int m_magnitudeBins = 0;  // Bins of m_magnitudes valid for this frame
+    std::vector<std::complex<double>> m_lagDomain;  // Cepstrum (real) and autocorrelation (imaginary)
+    bool m_lagDomainValid = false;
+};
+
+#endif // SPECTRALESTIMATORS_H
@@ -0,0 +1,171 @@
+#include "tunerdsp.h"
+#include "notetable.h"
+#include "pitchdetector.h"
+#include "pitchtracker.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <vector>
+
+struct tunerdsp_context {
+    tunerdsp_config config;
+    PitchDetector detector;
+    PitchTracker tracker;
+    NoteTable noteTable;
+    std::vector<double> samples;
+};
+
+namespace {
+
+bool isValid(const tunerdsp_config &config)
+{
+    return config.sample_rate >= 8000 && config.window_size >= 256 && config.hop_size >= 0 &&
+           config.fft_padding >= 1 && config.fft_padding <= 8 &&
+           config.method >= TUNERDSP_METHOD_FFT && config.method <= TUNERDSP_METHOD_ENSEMBLE &&
+           config.max_peaks >= 1 && config.reference_a > 0;
+}
+
+template<typename Sample, typename Convert>
+size_t analyze(tunerdsp_context *context, const Sample *samples, size_t sampleCount,
+               tunerdsp_frame *frames, size_t maxFrames, Convert convert)
+{
+    if (!context || (!samples && sampleCount > 0) || (!frames && maxFrames > 0)) return 0;
+    // Callers built against an older header have shorter frames, write only what they know
+    const size_t stride = maxFrames > 0 ? frames->struct_size : sizeof(tunerdsp_frame);
+    if (stride < offsetof(tunerdsp_frame, time)) return 0;
+    const size_t written = std::min(stride, sizeof(tunerdsp_frame));
+
+    const tunerdsp_config &config = context->config;
+    const size_t window = static_cast<size_t>(config.window_size);
+    const size_t hop = static_cast<size_t>(config.hop_size);
+    const size_t frameCount = std::min(tunerdsp_frame_count(context, sampleCount), maxFrames);
+
+    context->tracker.reset();
+    context->detector.resetPhase();
+    for (size_t f = 0; f < frameCount; ++f) {
+        const Sample *begin = samples + f * hop;
+        for (size_t i = 0; i < window; ++i) {
+            context->samples[i] = convert(begin[i]);
+        }
+
+        PitchDetector::Result result = context->detector.analyze(context->samples.data(), config.window_size);
+        PitchTracker::Estimate estimate = result.aboveThreshold ?
+                    context->tracker.update(result.frequency, result.confidence) : PitchTracker::Estimate();
+        if (!result.aboveThreshold) context->tracker.reset();
+
+        tunerdsp_frame frame;
+        std::memset(&frame, 0, sizeof(frame));
+        frame.struct_size = stride;
+        frame.time = static_cast<double>(f * hop) / config.sample_rate;
+        frame.level_db = result.levelDb;
+        frame.raw_frequency = result.frequency;
+        frame.frequency = estimate.frequency;
+        frame.confidence = estimate.confidence;
+        frame.locked = estimate.locked ? 1 : 0;
+        frame.midi_note = -1;
+        if (estimate.frequency > 0) {
+            NoteTable::Match match = context->noteTable.nearest(estimate.frequency);
+            frame.midi_note = match.note;
+            frame.cents = match.cents;
+        }
+        std::memcpy(reinterpret_cast<char*>(frames) + f * stride, &frame, written);
+    }
+    return frameCount;
+}
+
+}
+
+extern "C" {
+
+int tunerdsp_api_version(void)
+{
+    return TUNERDSP_API_VERSION;
+}
+
+void tunerdsp_default_config(tunerdsp_config *config)
+{
+    if (!config) return;
+    std::memset(config, 0, sizeof(*config));
+    config->struct_size = sizeof(*config);
+    config->sample_rate = 48000;
+    config->window_size = 8112;
+    config->hop_size = 0;
+    config->fft_padding = 2;
+    config->method = TUNERDSP_METHOD_FFT;
+    config->max_peaks = 10;
+    config->db_threshold = -70.0;
+    config->reference_a = 440.0;
+}
+
+tunerdsp_context *tunerdsp_create(const tunerdsp_config *config)
+{
+    if (!config || config->struct_size < offsetof(tunerdsp_config, sample_rate)) return nullptr;
+
+    // Fields past the caller's struct_size come from a newer header, they keep their defaults
+    tunerdsp_config resolved;
+    tunerdsp_default_config(&resolved);
+    std::memcpy(&resolved, config, std::min(config->struct_size, sizeof(resolved)));
+    resolved.struct_size = sizeof(resolved);
+    if (resolved.hop_size == 0) resolved.hop_size = resolved.window_size;
+    if (!isValid(resolved)) return nullptr;
+
+    auto *context = new (std::nothrow) tunerdsp_context;
+    if (!context) return nullptr;
+    context->config = resolved;
+
+    context->noteTable.build(resolved.reference_a, Temperament::Equal, 9, {});
+
+    PitchDetector::Settings settings;
+    settings.sampleRate = resolved.sample_rate;
+    settings.fftPadding = resolved.fft_padding;
+    // The C enum follows PitchDetector::Method
+    settings.method = static_cast<PitchDetector::Method>(resolved.method);
+    settings.dbThreshold = resolved.db_threshold;
+    settings.maxPeaks = resolved.max_peaks;
+    if (resolved.phase_refinement && resolved.hop_size < resolved.window_size) {
+        settings.phaseHop = resolved.hop_size;
+    }
+    context->detector.setSettings(settings);
+    context->detector.setNoteTable(&context->noteTable);
+
+    // Scratch and the FFT plan are sized once, analyze calls then run allocation free
+    context->samples.resize(resolved.window_size);
+    std::vector<double> silence(resolved.window_size, 0.0);
+    PitchDetector::Settings warmUp = settings;
+    warmUp.dbThreshold = -1000.0;
+    context->detector.setSettings(warmUp);
+    context->detector.analyze(silence.data(), resolved.window_size);
+    context->detector.setSettings(settings);
+    return context;
+}
+
+void tunerdsp_destroy(tunerdsp_context *context)
+{
+    delete context;
+}
+
+size_t tunerdsp_frame_count(const tunerdsp_context *context, size_t sample_count)
+{
+    if (!context) return 0;
+    const size_t window = static_cast<size_t>(context->config.window_size);
+    const size_t hop = static_cast<size_t>(context->config.hop_size);
+    return sample_count < window ? 0 : (sample_count - window) / hop + 1;
+}
+
+size_t tunerdsp_analyze_float(tunerdsp_context *context, const float *samples, size_t sample_count,
+                              tunerdsp_frame *frames, size_t max_frames)
+{
+    return analyze(context, samples, sample_count, frames, max_frames,
+                   [](float sample) { return static_cast<double>(sample); });
+}
+
+size_t tunerdsp_analyze_int16(tunerdsp_context *context, const int16_t *samples, size_t sample_count,
+                              tunerdsp_frame *frames, size_t max_frames)
+{
+    return analyze(context, samples, sample_count, frames, max_frames,
+                   [](int16_t sample) { return sample / 32768.0; });
+}
+
+}
@@ -0,0 +1,111 @@
+#ifndef TUNERDSP_H
+#define TUNERDSP_H
+
+/*
+ * C interface to the tuner's DSP core, for batch analysis outside the app.
+ *
+ * A context owns the detector, pitch tracker, note table and all scratch
+ * memory; FFT plans are cached process wide. Create one context per thread
+ * and reuse it across clips, each analyze call treats its buffer as one
+ * clip: the tracker starts fresh and frame times start at zero.
+ *
+ * ABI: structs are only ever extended at the end and callers pass their
+ * size in struct_size, so a program built against an older header keeps
+ * working: config fields it does not know take their defaults and frame
+ * fields it does not know are not written. Always initialize a config with
+ * tunerdsp_default_config().
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(TUNERDSP_BUILD)
+#    define TUNERDSP_EXPORT __declspec(dllexport)
+#  elif defined(TUNERDSP_SHARED)
+#    define TUNERDSP_EXPORT __declspec(dllimport)
+#  else
+#    define TUNERDSP_EXPORT
+#  endif
+#else
+#  define TUNERDSP_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Bumped whenever fields are appended, callers can check tunerdsp_api_version()
+ * before setting them. 2: phase_refinement, the ensemble method, frame struct_size.
+ */
+#define TUNERDSP_API_VERSION 2
+
+enum tunerdsp_method {
+    TUNERDSP_METHOD_FFT = 0,
+    TUNERDSP_METHOD_AUTOCORRELATION = 1,
+    TUNERDSP_METHOD_HARMONIC_SUM = 2,
+    TUNERDSP_METHOD_CEPSTRUM = 3,
+    TUNERDSP_METHOD_ENSEMBLE = 4      /* All of the above, fused by confidence, since 2 */
+};
+
+typedef struct tunerdsp_config {
+    size_t struct_size;    /* sizeof(tunerdsp_config), set by tunerdsp_default_config */
+    int sample_rate;       /* Hz */
+    int window_size;       /* Samples per analysis frame */
+    int hop_size;          /* Samples between frame starts, 0 = window_size */
+    int fft_padding;       /* Zero padding factor, 1..8 */
+    int method;            /* enum tunerdsp_method */
+    int max_peaks;         /* Candidate peaks per frame, 1..32 */
+    double db_threshold;   /* Frames at or below this RMS level are silent */
+    double reference_a;    /* A4 in Hz, equal temperament */
+    int phase_refinement;  /* Non-zero: refine FFT results from the phase advance between
+                              frames, needs hop_size < window_size. Since 2 */
+} tunerdsp_config;
+
+/*
+ * Set frames[0].struct_size to sizeof(tunerdsp_frame) before analyzing,
+ * the frame array is read with that stride.
+ */
+typedef struct tunerdsp_frame {
+    size_t struct_size;    /* sizeof(tunerdsp_frame), set by the caller in frames[0] */
+    double time;           /* Seconds from the start of the clip to the frame start */
+    double level_db;       /* RMS level, dBFS */
+    double raw_frequency;  /* This frame's detection in Hz, 0 if none */
+    double frequency;      /* Tracked frequency in Hz, 0 if none */
+    double confidence;     /* Tracker confidence, 0..1 */
+    double cents;          /* Deviation from the nearest note */
+    int midi_note;         /* Nearest MIDI note, -1 if no pitch */
+    int locked;            /* Non-zero once the tracker has settled */
+} tunerdsp_frame;
+
+typedef struct tunerdsp_context tunerdsp_context;
+
+TUNERDSP_EXPORT int tunerdsp_api_version(void);
+
+TUNERDSP_EXPORT void tunerdsp_default_config(tunerdsp_config *config);
+
+/* Returns NULL when the config is invalid */
+TUNERDSP_EXPORT tunerdsp_context *tunerdsp_create(const tunerdsp_config *config);
+TUNERDSP_EXPORT void tunerdsp_destroy(tunerdsp_context *context);
+
+/* Number of frames a clip of sample_count samples produces */
+TUNERDSP_EXPORT size_t tunerdsp_frame_count(const tunerdsp_context *context, size_t sample_count);
+
+/*
+ * Analyze one mono clip, writing at most max_frames results.
+ * Float samples are expected in [-1, 1]. Returns the number of frames
+ * written, 0 when frames[0].struct_size is not set.
+ */
+TUNERDSP_EXPORT size_t tunerdsp_analyze_float(tunerdsp_context *context,
+                                              const float *samples, size_t sample_count,
+                                              tunerdsp_frame *frames, size_t max_frames);
+TUNERDSP_EXPORT size_t tunerdsp_analyze_int16(tunerdsp_context *context,
+                                              const int16_t *samples, size_t sample_count,
+                                              tunerdsp_frame *frames, size_t max_frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TUNERDSP_H */
@@ -0,0 +1,156 @@
+#include "wavetableoscillator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Relative amplitude of partials 1..n, indexed by WavetableOscillator::Timbre
+const std::vector<double> TIMBRE_PARTIALS[] = {
+    {1.0},
+    {1.0, 0.8, 0.55, 0.45, 0.35, 0.3, 0.2, 0.15, 0.12, 0.1, 0.08, 0.06},
+    {1.0, 0.7, 0.0, 0.5, 0.0, 0.0, 0.0, 0.35}
+};
+
+constexpr int TIMBRE_COUNT = static_cast<int>(WavetableOscillator::Timbre::TIMBRE_COUNT);
+constexpr int TABLE_STRIDE = WavetableOscillator::TABLE_SIZE + 1;
+
+// Moves value towards target by at most step
+double approach(double value, double target, double step)
+{
+    return value < target ? std::min(value + step, target) : std::max(value - step, target);
+}
+
+// Ramp position to gain, flat at both ends so fades start and stop without a corner
+double smoothStep(double x)
+{
+    return x * x * (3.0 - 2.0 * x);
+}
+
+}
+
+void WavetableOscillator::prepare(int sampleRate)
+{
+    m_sampleRate = std::max(sampleRate, 1);
+    m_tables.assign(static_cast<size_t>(TIMBRE_COUNT) * OCTAVE_COUNT * TABLE_STRIDE, 0.0f);
+
+    for (int timbre = 0; timbre < TIMBRE_COUNT; ++timbre) {
+        const std::vector<double> &partials = TIMBRE_PARTIALS[timbre];
+        float *first = m_tables.data() + static_cast<size_t>(timbre) * OCTAVE_COUNT * TABLE_STRIDE;
+
+        for (int octave = 0; octave < OCTAVE_COUNT; ++octave) {
+            const double topFrequency = LOWEST_FREQUENCY * std::pow(2.0, octave + 1);
+            float *samples = first + octave * TABLE_STRIDE;
+            for (int h = 1; h <= static_cast<int>(partials.size()); ++h) {
+                // The fundamental always stays, even above the limit
+                if (h > 1 && h * topFrequency > PARTIAL_LIMIT * m_sampleRate) break;
+                if (partials[h - 1] == 0.0) continue;
+                for (int i = 0; i < TABLE_SIZE; ++i) {
+                    samples[i] += static_cast<float>(partials[h - 1] * std::sin(2.0 * M_PI * h * i / TABLE_SIZE));
+                }
+            }
+        }
+
+        // One scale per timbre, dropping partials must not make higher octaves louder
+        float peak = 0.0f;
+        for (int i = 0; i < OCTAVE_COUNT * TABLE_STRIDE; ++i) peak = std::max(peak, std::abs(first[i]));
+        for (int octave = 0; octave < OCTAVE_COUNT; ++octave) {
+            float *samples = first + octave * TABLE_STRIDE;
+            if (peak > 0.0f) {
+                for (int i = 0; i < TABLE_SIZE; ++i) samples[i] /= peak;
+            }
+            samples[TABLE_SIZE] = samples[0];
+        }
+    }
+
+    m_voices = {};
+    m_envelope = 0.0;
+    m_currentLevel = m_level.load(std::memory_order_relaxed);
+}
+
+void WavetableOscillator::setFrequency(int voice, double frequency)
+{
+    if (voice < 0 || voice >= VOICE_COUNT) return;
+    m_frequency[voice].store(std::max(frequency, 0.0), std::memory_order_relaxed);
+}
+
+void WavetableOscillator::setTimbre(Timbre timbre)
+{
+    m_timbre.store(std::clamp(static_cast<int>(timbre), 0, TIMBRE_COUNT - 1), std::memory_order_relaxed);
+}
+
+void WavetableOscillator::setLevel(double level)
+{
+    m_level.store(std::clamp(level, 0.0, 1.0), std::memory_order_relaxed);
+}
+
+void WavetableOscillator::setFadeSeconds(double seconds)
+{
+    m_fadeSeconds.store(std::max(seconds, 0.0), std::memory_order_relaxed);
+}
+
+void WavetableOscillator::setGate(bool open)
+{
+    m_gate.store(open, std::memory_order_relaxed);
+}
+
+const float *WavetableOscillator::table(int timbre, double frequency) const
+{
+    int octave = frequency > LOWEST_FREQUENCY ? static_cast<int>(std::log2(frequency / LOWEST_FREQUENCY)) : 0;
+    octave = std::clamp(octave, 0, OCTAVE_COUNT - 1);
+    return m_tables.data() + (static_cast<size_t>(timbre) * OCTAVE_COUNT + octave) * TABLE_STRIDE;
+}
+
+void WavetableOscillator::render(float *out, int count)
+{
+    if (m_tables.empty()) {
+        std::fill(out, out + count, 0.0f);
+        return;
+    }
+
+    // Controls are read once per block, their changes ramp within it
+    const int timbre = m_timbre.load(std::memory_order_relaxed);
+    const double gateTarget = m_gate.load(std::memory_order_relaxed) ? 1.0 : 0.0;
+    const double levelTarget = m_level.load(std::memory_order_relaxed);
+    const double fadeSamples = m_fadeSeconds.load(std::memory_order_relaxed) * m_sampleRate;
+    const double fadeStep = fadeSamples >= 1.0 ? 1.0 / fadeSamples : 1.0;
+    const double levelStep = 1.0 / (LEVEL_RAMP_SECONDS * m_sampleRate);
+
+    std::array<const float *, VOICE_COUNT> tables;
+    std::array<double, VOICE_COUNT> increments;
+    std::array<double, VOICE_COUNT> voiceTargets;
+    for (int v = 0; v < VOICE_COUNT; ++v) {
+        Voice &voice = m_voices[v];
+        double frequency = m_frequency[v].load(std::memory_order_relaxed);
+        if (frequency > 0.0) voice.frequency = frequency;
+        voiceTargets[v] = frequency > 0.0 ? 1.0 : 0.0;
+        tables[v] = table(timbre, voice.frequency);
+        increments[v] = std::min(voice.frequency * TABLE_SIZE / m_sampleRate, TABLE_SIZE / 2.0);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        m_envelope = approach(m_envelope, gateTarget, fadeStep);
+        m_currentLevel = approach(m_currentLevel, levelTarget, levelStep);
+
+        double mix = 0.0;
+        double weight = 0.0;
+        for (int v = 0; v < VOICE_COUNT; ++v) {
+            Voice &voice = m_voices[v];
+            voice.gain = approach(voice.gain, voiceTargets[v], fadeStep);
+            if (voice.gain <= 0.0) continue;
+
+            const int index = static_cast<int>(voice.phase);
+            const double fraction = voice.phase - index;
+            const float *samples = tables[v];
+            double value = samples[index] + fraction * (samples[index + 1] - samples[index]);
+            double gain = smoothStep(voice.gain);
+            mix += gain * value;
+            weight += gain;
+
+            voice.phase += increments[v];
+            if (voice.phase >= TABLE_SIZE) voice.phase -= TABLE_SIZE;
+        }
+        // A second voice shares the level instead of clipping
+        out[i] = static_cast<float>(m_currentLevel * smoothStep(m_envelope) * mix / std::max(weight, 1.0));
+    }
+}
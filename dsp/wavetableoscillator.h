@@ -0,0 +1,69 @@
+#ifndef WAVETABLEOSCILLATOR_H
+#define WAVETABLEOSCILLATOR_H
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Band-limited wavetable oscillator for reference tones and drones. Each
+// timbre has one table per octave of fundamental holding only the partials
+// that stay below Nyquist at the top of that octave, so no pitch aliases.
+// prepare() builds the tables; after it the setters are relaxed atomics, safe
+// from any thread, and render() neither locks nor allocates, so it can run in
+// an audio callback. Gate, level and voice changes ramp instead of stepping.
+class WavetableOscillator
+{
+public:
+    enum class Timbre {
+        Sine,
+        Cello,   // Bowed string, partials falling off roughly as 1/h
+        Organ,   // Octave partials only, an easy drone to tune against
+        TIMBRE_COUNT
+    };
+
+    static constexpr int VOICE_COUNT = 2;         // The note and a drone interval
+    static constexpr int TABLE_SIZE = 2048;       // Linear interpolation error below -100 dB
+    static constexpr int OCTAVE_COUNT = 10;
+    static constexpr double LOWEST_FREQUENCY = 16.0;  // Top of the first octave's range is twice this
+    static constexpr double PARTIAL_LIMIT = 0.45;     // Highest partial, as a fraction of the rate
+    static constexpr double LEVEL_RAMP_SECONDS = 0.01;
+
+    // Allocates the tables and resets the state, not while render() may run
+    void prepare(int sampleRate);
+    int sampleRate() const { return m_sampleRate; }
+
+    // 0 fades the voice out
+    void setFrequency(int voice, double frequency);
+    void setTimbre(Timbre timbre);
+    // Peak amplitude of the mix, 0..1
+    void setLevel(double level);
+    void setFadeSeconds(double seconds);
+    void setGate(bool open);
+
+    // Audio thread only
+    void render(float *out, int count);
+
+private:
+    struct Voice {
+        double phase = 0.0;      // In table samples
+        double frequency = 0.0;  // Kept while fading out after setFrequency(0)
+        double gain = 0.0;       // Ramp position 0..1
+    };
+
+    const float *table(int timbre, double frequency) const;
+
+    int m_sampleRate = 0;
+    std::vector<float> m_tables;  // [timbre][octave][TABLE_SIZE + 1], the last sample wraps
+
+    std::array<std::atomic<double>, VOICE_COUNT> m_frequency{};
+    std::atomic<int> m_timbre{static_cast<int>(Timbre::Cello)};
+    std::atomic<double> m_level{0.5};
+    std::atomic<double> m_fadeSeconds{0.25};
+    std::atomic<bool> m_gate{false};
+
+    std::array<Voice, VOICE_COUNT> m_voices;
+    double m_envelope = 0.0;
+    double m_currentLevel = 0.0;
+};
+
+#endif // WAVETABLEOSCILLATOR_H
@@ -1,10 +1,29 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include "qmlapp.h"
+#include "tunerengine.h"
+#include "audio/capturereplay.h"
 #include "tools/crashReportTool.h"
+#include "tools/startupProfile.h"
+
+// Headless replay of a raw input capture: --replay <file> [--fast]
+static int runReplay(QGuiApplication &app, const QString &path, bool fast)
+{
+    TunerEngine engine(nullptr, false);
+    CaptureReplay replay;
+    if (!replay.open(path)) return 1;
+
+    QObject::connect(&replay, &CaptureReplay::finished, &app, [&app](const QByteArray &digest, qint64 elapsedMs) {
+        qInfo().noquote() << "replay digest" << digest << "elapsed" << elapsedMs << "ms";
+        app.quit();
+    });
+    replay.start(&engine, fast ? CaptureReplay::AsFastAsPossible : CaptureReplay::RealTime);
+    return app.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    StartupProfile::begin();
     QGuiApplication app(argc, argv);
     installCrashHandler();
     qInstallMessageHandler(0);
@@ -13,6 +32,12 @@ int main(int argc, char *argv[])
     QCoreApplication::setOrganizationName("CB4Tech");
     QCoreApplication::setApplicationName("CelloTuner");
 
+    const QStringList args = QCoreApplication::arguments();
+    qsizetype replayIndex = args.indexOf("--replay");
+    if (replayIndex >= 0 && replayIndex + 1 < args.size()) {
+        return runReplay(app, args.at(replayIndex + 1), args.contains("--fast"));
+    }
+
     QmlApp a;
 
     return app.exec();
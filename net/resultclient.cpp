@@ -0,0 +1,101 @@
+#include "resultclient.h"
+#include "resultserver.h"
+
+#include <QDebug>
+#include <QUdpSocket>
+#include <QUrl>
+#include <QWebSocket>
+#include <QtEndian>
+
+ResultClient::ResultClient(QObject *parent)
+    : QObject(parent)
+    , m_socket(new QUdpSocket(this))
+{
+    connect(m_socket, &QUdpSocket::readyRead, this, &ResultClient::readPendingDatagrams);
+    connect(&m_renewTimer, &QTimer::timeout, this, [this]() { sendSubscription(ResultServer::SUBSCRIBE_MESSAGE); });
+    m_datagram.resize(ResultRecord::DATAGRAM_HEADER_SIZE + ResultRecord::MAX_BATCH * ResultRecord::RECORD_SIZE);
+}
+
+ResultClient::~ResultClient()
+{
+    unsubscribe();
+}
+
+bool ResultClient::subscribe(const QHostAddress &server, quint16 port, Transport transport)
+{
+    unsubscribe();
+    m_haveSequence = false;
+
+    if (transport == Transport::WebSocket) {
+        if (!m_webSocket) {
+            m_webSocket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+            connect(m_webSocket, &QWebSocket::binaryMessageReceived, this, [this](const QByteArray &message) {
+                decode(reinterpret_cast<const uchar*>(message.constData()), message.size());
+            });
+            connect(m_webSocket, &QWebSocket::errorOccurred, this, [this]() {
+                qWarning() << "Result client WebSocket error" << m_webSocket->errorString();
+            });
+        }
+        QUrl url;
+        url.setScheme("ws");
+        url.setHost(server.toString());
+        url.setPort(port);
+        m_webSocket->open(url);
+        return true;
+    }
+
+    if (m_socket->localPort() == 0 && !m_socket->bind(QHostAddress::AnyIPv4, 0)) {
+        qWarning() << "Result client cannot bind" << m_socket->errorString();
+        return false;
+    }
+    m_server = server;
+    m_serverPort = port;
+    sendSubscription(ResultServer::SUBSCRIBE_MESSAGE);
+    m_renewTimer.start(ResultServer::SUBSCRIPTION_TIMEOUT_MS / 3);
+    return true;
+}
+
+void ResultClient::unsubscribe()
+{
+    if (m_webSocket) m_webSocket->close();
+    if (m_serverPort == 0) return;
+    m_renewTimer.stop();
+    sendSubscription(ResultServer::UNSUBSCRIBE_MESSAGE);
+    m_serverPort = 0;
+}
+
+void ResultClient::sendSubscription(const char *message)
+{
+    m_socket->writeDatagram(message, qstrlen(message), m_server, m_serverPort);
+}
+
+void ResultClient::readPendingDatagrams()
+{
+    while (m_socket->hasPendingDatagrams()) {
+        qint64 size = m_socket->readDatagram(m_datagram.data(), m_datagram.size());
+        decode(reinterpret_cast<const uchar*>(m_datagram.constData()), size);
+    }
+}
+
+void ResultClient::decode(const uchar *data, qint64 size)
+{
+    // A WebSocket message carries exactly one datagram
+    if (size < ResultRecord::DATAGRAM_HEADER_SIZE ||
+        qFromLittleEndian<quint32>(data) != ResultRecord::DATAGRAM_MAGIC ||
+        qFromLittleEndian<quint16>(data + 4) != ResultRecord::VERSION) {
+        return;
+    }
+
+    int count = qFromLittleEndian<quint16>(data + 6);
+    count = qMin<qint64>(count, (size - ResultRecord::DATAGRAM_HEADER_SIZE) / ResultRecord::RECORD_SIZE);
+    for (int i = 0; i < count; ++i) {
+        ResultRecord record = ResultRecord::decode(data + ResultRecord::DATAGRAM_HEADER_SIZE + i * ResultRecord::RECORD_SIZE);
+        if (m_haveSequence && record.sequence > m_nextSequence) {
+            m_lostRecords += record.sequence - m_nextSequence;
+        }
+        m_haveSequence = true;
+        m_nextSequence = record.sequence + 1;
+        ++m_receivedRecords;
+        emit resultReceived(record);
+    }
+}
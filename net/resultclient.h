@@ -0,0 +1,56 @@
+#ifndef RESULTCLIENT_H
+#define RESULTCLIENT_H
+
+#include <QHostAddress>
+#include <QObject>
+#include <QTimer>
+#include "resultrecord.h"
+
+class QUdpSocket;
+class QWebSocket;
+
+// Reference client for ResultServer: subscribes over UDP and keeps the
+// subscription alive, or connects to the WebSocket port, and decodes every
+// record of the incoming datagrams or binary messages. Sequence gaps are
+// counted as lost records.
+class ResultClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Transport {
+        Udp,
+        WebSocket
+    };
+
+    explicit ResultClient(QObject *parent = nullptr);
+    ~ResultClient();
+
+    // port is the server's UDP port or its WebSocket port, depending on transport
+    bool subscribe(const QHostAddress &server, quint16 port, Transport transport = Transport::Udp);
+    void unsubscribe();
+
+    quint64 receivedRecords() const { return m_receivedRecords; }
+    quint64 lostRecords() const { return m_lostRecords; }
+
+signals:
+    void resultReceived(const ResultRecord &record);
+
+private:
+    void sendSubscription(const char *message);
+    void readPendingDatagrams();
+    void decode(const uchar *data, qint64 size);
+
+    QUdpSocket *m_socket = nullptr;
+    QWebSocket *m_webSocket = nullptr;
+    QTimer m_renewTimer;
+    QHostAddress m_server;
+    quint16 m_serverPort = 0;
+    QByteArray m_datagram;
+    bool m_haveSequence = false;
+    quint32 m_nextSequence = 0;
+    quint64 m_receivedRecords = 0;
+    quint64 m_lostRecords = 0;
+};
+
+#endif // RESULTCLIENT_H
@@ -0,0 +1,59 @@
+#include "resultrecord.h"
+
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+void putFloat(uchar *out, float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian(bits, out);
+}
+
+float getFloat(const uchar *in)
+{
+    quint32 bits = qFromLittleEndian<quint32>(in);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}
+
+void ResultRecord::encode(uchar *out) const
+{
+    qToLittleEndian(sequence, out);
+    qToLittleEndian(timestampUSecs, out + 4);
+    putFloat(out + 12, frequency);
+    putFloat(out + 16, cents);
+    putFloat(out + 20, levelDb);
+    putFloat(out + 24, confidence);
+    qToLittleEndian(midiNote, out + 28);
+    out[30] = peakCount;
+    out[31] = flags;
+    for (int i = 0; i < MAX_PEAKS; ++i) {
+        putFloat(out + 32 + i * 8, peaks[i].frequency);
+        putFloat(out + 36 + i * 8, peaks[i].amplitude);
+    }
+}
+
+ResultRecord ResultRecord::decode(const uchar *in)
+{
+    ResultRecord record;
+    record.sequence = qFromLittleEndian<quint32>(in);
+    record.timestampUSecs = qFromLittleEndian<qint64>(in + 4);
+    record.frequency = getFloat(in + 12);
+    record.cents = getFloat(in + 16);
+    record.levelDb = getFloat(in + 20);
+    record.confidence = getFloat(in + 24);
+    record.midiNote = qFromLittleEndian<qint16>(in + 28);
+    record.peakCount = qMin<quint8>(in[30], MAX_PEAKS);
+    record.flags = in[31];
+    for (int i = 0; i < MAX_PEAKS; ++i) {
+        record.peaks[i].frequency = getFloat(in + 32 + i * 8);
+        record.peaks[i].amplitude = getFloat(in + 36 + i * 8);
+    }
+    return record;
+}
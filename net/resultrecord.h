@@ -0,0 +1,48 @@
+#ifndef RESULTRECORD_H
+#define RESULTRECORD_H
+
+#include <QtGlobal>
+#include <array>
+
+// One analysis result as streamed to companion devices.
+// Wire format, little endian, RECORD_SIZE bytes per record:
+//   u32 sequence, i64 timestamp (us, engine monotonic clock, when the newest
+//   sample of the analyzed window was captured),
+//   f32 frequency, f32 cents, f32 level (dBFS), f32 confidence,
+//   i16 MIDI note (-1 when nothing was detected), u8 peak count, u8 flags,
+//   MAX_PEAKS x (f32 frequency, f32 normalized amplitude)
+// A datagram is DATAGRAM_HEADER_SIZE bytes ("CTRS", u16 version,
+// u16 record count) followed by up to MAX_BATCH records.
+struct ResultRecord {
+    static constexpr int MAX_PEAKS = 8;
+    static constexpr int RECORD_SIZE = 96;
+    static constexpr int DATAGRAM_HEADER_SIZE = 8;
+    static constexpr int MAX_BATCH = 12;  // Keeps a datagram under a 1500 byte MTU
+    static constexpr quint32 DATAGRAM_MAGIC = 0x53525443;  // "CTRS"
+    static constexpr quint16 VERSION = 1;
+
+    enum Flag : quint8 {
+        Locked = 1 << 0
+    };
+
+    struct PeakEntry {
+        float frequency = 0.0f;
+        float amplitude = 0.0f;
+    };
+
+    quint32 sequence = 0;
+    qint64 timestampUSecs = 0;
+    float frequency = 0.0f;
+    float cents = 0.0f;
+    float levelDb = -90.0f;
+    float confidence = 0.0f;
+    qint16 midiNote = -1;
+    quint8 peakCount = 0;
+    quint8 flags = 0;
+    std::array<PeakEntry, MAX_PEAKS> peaks{};
+
+    void encode(uchar *out) const;
+    static ResultRecord decode(const uchar *in);
+};
+
+#endif // RESULTRECORD_H
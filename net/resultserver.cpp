@@ -0,0 +1,288 @@
+#include "resultserver.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QWebSocket>
+#include <QWebSocketServer>
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Lives on the server thread and owns everything that touches the network
+class ResultServer::Sender : public QObject
+{
+public:
+    bool open(quint16 port, const QHostAddress &multicastGroup, quint16 webSocketPort);
+    void send(const ResultRecord *records, int count);
+    int subscriberCount() const { return m_subscriberCount.load(std::memory_order_relaxed); }
+    quint64 skippedRecords() const { return m_skippedRecords.load(std::memory_order_relaxed); }
+    quint16 port() const { return m_port; }
+    quint16 webSocketPort() const { return m_webSocketPort; }
+
+private:
+    struct Subscriber {
+        QHostAddress address;
+        quint16 port = 0;
+        qint64 lastSeenMs = 0;
+    };
+
+    void readPendingDatagrams();
+    void expireSubscribers();
+    void acceptWebSockets();
+    void updateSubscriberCount();
+
+    QUdpSocket *m_socket = nullptr;
+    QHostAddress m_multicastGroup;
+    quint16 m_port = 0;
+    quint16 m_webSocketPort = 0;
+    std::vector<Subscriber> m_subscribers;
+    QWebSocketServer *m_webSocketServer = nullptr;
+    std::vector<QWebSocket*> m_webSockets;
+    std::atomic<int> m_subscriberCount{0};
+    std::atomic<quint64> m_skippedRecords{0};
+    QElapsedTimer m_clock;
+    QByteArray m_datagram;
+};
+
+bool ResultServer::Sender::open(quint16 port, const QHostAddress &multicastGroup, quint16 webSocketPort)
+{
+    m_socket = new QUdpSocket(this);
+    if (!m_socket->bind(QHostAddress::AnyIPv4, port)) {
+        qWarning() << "Result server cannot bind port" << port << m_socket->errorString();
+        return false;
+    }
+    m_port = m_socket->localPort();
+    m_multicastGroup = multicastGroup;
+    if (!m_multicastGroup.isNull()) {
+        m_socket->setSocketOption(QAbstractSocket::MulticastTtlOption, 1);
+    }
+    m_clock.start();
+    m_datagram.resize(ResultRecord::DATAGRAM_HEADER_SIZE + ResultRecord::MAX_BATCH * ResultRecord::RECORD_SIZE);
+
+    connect(m_socket, &QUdpSocket::readyRead, this, [this]() { readPendingDatagrams(); });
+    auto *expiry = new QTimer(this);
+    connect(expiry, &QTimer::timeout, this, [this]() { expireSubscribers(); });
+    expiry->start(SUBSCRIPTION_TIMEOUT_MS / 2);
+
+    m_webSocketServer = new QWebSocketServer("CelloTuner", QWebSocketServer::NonSecureMode, this);
+    if (!m_webSocketServer->listen(QHostAddress::AnyIPv4, webSocketPort)) {
+        qWarning() << "Result server cannot listen for WebSocket clients on port" << webSocketPort
+                   << m_webSocketServer->errorString();
+        delete m_webSocketServer;
+        m_webSocketServer = nullptr;
+        return true;
+    }
+    m_webSocketPort = m_webSocketServer->serverPort();
+    connect(m_webSocketServer, &QWebSocketServer::newConnection, this, [this]() { acceptWebSockets(); });
+    return true;
+}
+
+void ResultServer::Sender::acceptWebSockets()
+{
+    while (QWebSocket *socket = m_webSocketServer->nextPendingConnection()) {
+        if (static_cast<int>(m_subscribers.size() + m_webSockets.size()) >= MAX_SUBSCRIBERS) {
+            socket->close(QWebSocketProtocol::CloseCodePolicyViolated, "Too many subscribers");
+            socket->deleteLater();
+            continue;
+        }
+        socket->setParent(this);
+        m_webSockets.push_back(socket);
+        connect(socket, &QWebSocket::disconnected, this, [this, socket]() {
+            std::erase(m_webSockets, socket);
+            socket->deleteLater();
+            updateSubscriberCount();
+        });
+    }
+    updateSubscriberCount();
+}
+
+void ResultServer::Sender::updateSubscriberCount()
+{
+    m_subscriberCount.store(static_cast<int>(m_subscribers.size() + m_webSockets.size()), std::memory_order_relaxed);
+}
+
+void ResultServer::Sender::readPendingDatagrams()
+{
+    char message[16];
+    while (m_socket->hasPendingDatagrams()) {
+        QHostAddress address;
+        quint16 port = 0;
+        qint64 size = m_socket->readDatagram(message, sizeof(message) - 1, &address, &port);
+        if (size <= 0) continue;
+        message[size] = '\0';
+
+        auto it = std::find_if(m_subscribers.begin(), m_subscribers.end(), [&](const Subscriber &s) {
+            return s.port == port && s.address == address;
+        });
+        if (qstrcmp(message, SUBSCRIBE_MESSAGE) == 0) {
+            if (it != m_subscribers.end()) {
+                it->lastSeenMs = m_clock.elapsed();
+            } else if (static_cast<int>(m_subscribers.size() + m_webSockets.size()) < MAX_SUBSCRIBERS) {
+                m_subscribers.push_back({address, port, m_clock.elapsed()});
+            }
+        } else if (qstrcmp(message, UNSUBSCRIBE_MESSAGE) == 0 && it != m_subscribers.end()) {
+            m_subscribers.erase(it);
+        }
+    }
+    updateSubscriberCount();
+}
+
+void ResultServer::Sender::expireSubscribers()
+{
+    qint64 now = m_clock.elapsed();
+    std::erase_if(m_subscribers, [now](const Subscriber &s) {
+        return now - s.lastSeenMs > SUBSCRIPTION_TIMEOUT_MS;
+    });
+    updateSubscriberCount();
+}
+
+void ResultServer::Sender::send(const ResultRecord *records, int count)
+{
+    uchar *data = reinterpret_cast<uchar*>(m_datagram.data());
+    qToLittleEndian(ResultRecord::DATAGRAM_MAGIC, data);
+    qToLittleEndian(ResultRecord::VERSION, data + 4);
+    qToLittleEndian(quint16(count), data + 6);
+    for (int i = 0; i < count; ++i) {
+        records[i].encode(data + ResultRecord::DATAGRAM_HEADER_SIZE + i * ResultRecord::RECORD_SIZE);
+    }
+
+    // UDP writes do not block; a subscriber that falls behind loses datagrams, not us
+    const char *bytes = m_datagram.constData();
+    qint64 size = ResultRecord::DATAGRAM_HEADER_SIZE + count * ResultRecord::RECORD_SIZE;
+    for (const Subscriber &subscriber : m_subscribers) {
+        m_socket->writeDatagram(bytes, size, subscriber.address, subscriber.port);
+    }
+    if (!m_multicastGroup.isNull()) {
+        m_socket->writeDatagram(bytes, size, m_multicastGroup, m_port);
+    }
+
+    // WebSocket writes queue up behind a slow reader, so skip it rather than buffer without bound
+    const QByteArray message = QByteArray::fromRawData(bytes, size);
+    for (QWebSocket *socket : m_webSockets) {
+        if (socket->bytesToWrite() > MAX_WEBSOCKET_BACKLOG) {
+            m_skippedRecords.fetch_add(count, std::memory_order_relaxed);
+            continue;
+        }
+        socket->sendBinaryMessage(message);
+    }
+}
+
+ResultServer::ResultServer(QObject *parent)
+    : QObject(parent)
+{
+    m_thread.setObjectName("ResultServer");
+}
+
+ResultServer::~ResultServer()
+{
+    stop();
+}
+
+bool ResultServer::start(quint16 port, const QHostAddress &multicastGroup, quint16 webSocketPort)
+{
+    stop();
+
+    auto *sender = new Sender;
+    sender->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, sender, &QObject::deleteLater);
+    m_thread.start();
+
+    bool opened = false;
+    QMetaObject::invokeMethod(sender, [&]() {
+        opened = sender->open(port, multicastGroup, webSocketPort);
+    }, Qt::BlockingQueuedConnection);
+
+    if (!opened) {
+        m_thread.quit();
+        m_thread.wait();
+        return false;
+    }
+
+    // Port 0 lets the system choose, the benchmark relies on that
+    m_port = sender->port();
+    m_webSocketPort = sender->webSocketPort();
+    QMutexLocker locker(&m_mutex);
+    m_sender = sender;
+    qDebug() << "Result server publishing on UDP port" << m_port << "and WebSocket port" << m_webSocketPort;
+    return true;
+}
+
+void ResultServer::stop()
+{
+    if (!m_thread.isRunning()) return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_sender = nullptr;
+        m_queueCount = 0;
+        m_drainScheduled = false;
+    }
+    // The sender is deleted on its own thread once the event loop has quit
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void ResultServer::publish(const ResultRecord &record)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_sender) return;
+
+    if (m_queueCount == QUEUE_CAPACITY) {
+        m_queueHead = (m_queueHead + 1) % QUEUE_CAPACITY;
+        --m_queueCount;
+        ++m_droppedRecords;
+    }
+    m_queue[(m_queueHead + m_queueCount) % QUEUE_CAPACITY] = record;
+    ++m_queueCount;
+
+    // One wake-up per burst, the sender takes everything queued by then
+    if (!m_drainScheduled) {
+        m_drainScheduled = true;
+        Sender *sender = m_sender;
+        QMetaObject::invokeMethod(sender, [this, sender]() { drain(sender); }, Qt::QueuedConnection);
+    }
+}
+
+void ResultServer::drain(Sender *sender)
+{
+    // Runs on the server thread
+    std::array<ResultRecord, ResultRecord::MAX_BATCH> batch;
+    for (;;) {
+        int count = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (count < ResultRecord::MAX_BATCH && m_queueCount > 0) {
+                batch[count++] = m_queue[m_queueHead];
+                m_queueHead = (m_queueHead + 1) % QUEUE_CAPACITY;
+                --m_queueCount;
+            }
+            if (count == 0) {
+                m_drainScheduled = false;
+                return;
+            }
+        }
+        sender->send(batch.data(), count);
+    }
+}
+
+quint64 ResultServer::droppedRecords() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_droppedRecords;
+}
+
+quint64 ResultServer::skippedRecords() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_sender ? m_sender->skippedRecords() : 0;
+}
+
+int ResultServer::subscriberCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_sender ? m_sender->subscriberCount() : 0;
+}
@@ -0,0 +1,77 @@
+#ifndef RESULTSERVER_H
+#define RESULTSERVER_H
+
+#include <QHostAddress>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+#include <array>
+#include "resultrecord.h"
+
+class QUdpSocket;
+
+// Publishes analysis results to companion displays over UDP and WebSocket.
+// UDP clients subscribe by sending SUBSCRIBE_MESSAGE to the server port and
+// renewing it within SUBSCRIPTION_TIMEOUT_MS; results can additionally go
+// to a multicast group. WebSocket clients connect to the WebSocket port and
+// receive each datagram as one binary message, for browsers and for
+// networks that drop UDP. publish() only copies the record into a bounded
+// queue, the sockets live on the server's own thread, so neither a slow
+// network nor a slow client can hold up the analysis. Records that pile up
+// while the sender is busy are batched into one datagram, and when the
+// queue is full the oldest record is dropped. A WebSocket client whose send
+// buffer is over MAX_WEBSOCKET_BACKLOG skips batches until it catches up.
+class ResultServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr quint16 DEFAULT_PORT = 47631;
+    static constexpr quint16 DEFAULT_WEBSOCKET_PORT = 47632;
+    static constexpr int QUEUE_CAPACITY = 256;
+    static constexpr int MAX_SUBSCRIBERS = 64;
+    static constexpr int SUBSCRIPTION_TIMEOUT_MS = 10000;
+    static constexpr qint64 MAX_WEBSOCKET_BACKLOG = 64 * 1024;  // Bytes
+    static constexpr const char *SUBSCRIBE_MESSAGE = "CTSUB";
+    static constexpr const char *UNSUBSCRIBE_MESSAGE = "CTUNSUB";
+
+    explicit ResultServer(QObject *parent = nullptr);
+    ~ResultServer();
+
+    // A null multicastGroup publishes to subscribers only. Port 0 lets the
+    // system choose; without a free WebSocket port only UDP is served.
+    bool start(quint16 port = DEFAULT_PORT, const QHostAddress &multicastGroup = QHostAddress(),
+               quint16 webSocketPort = DEFAULT_WEBSOCKET_PORT);
+    void stop();
+    bool isRunning() const { return m_thread.isRunning(); }
+    quint16 port() const { return m_port; }
+    quint16 webSocketPort() const { return m_webSocketPort; }
+
+    // Safe from any thread, never waits for the network
+    void publish(const ResultRecord &record);
+
+    quint64 droppedRecords() const;
+    // Records not sent to WebSocket clients that had fallen behind, summed over clients
+    quint64 skippedRecords() const;
+    // UDP subscribers and WebSocket connections
+    int subscriberCount() const;
+
+private:
+    class Sender;
+
+    void drain(Sender *sender);
+
+    QThread m_thread;
+    Sender *m_sender = nullptr;
+    quint16 m_port = 0;
+    quint16 m_webSocketPort = 0;
+
+    mutable QMutex m_mutex;
+    std::array<ResultRecord, QUEUE_CAPACITY> m_queue;
+    int m_queueHead = 0;
+    int m_queueCount = 0;
+    bool m_drainScheduled = false;
+    quint64 m_droppedRecords = 0;
+};
+
+#endif // RESULTSERVER_H
@@ -0,0 +1,162 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+
+// Per-note intonation of the current or last practice session
+Rectangle {
+    id: root
+    color: "#2d2d2d"
+    radius: 4
+
+    property var statistics: ({ durationSeconds: 0, inTuneCents: 5, droppedFrames: 0, notes: [] })
+
+    function refresh() {
+        statistics = tuner.sessionStatistics()
+    }
+
+    function formatDuration(seconds) {
+        let minutes = Math.floor(seconds / 60)
+        let rest = Math.floor(seconds % 60)
+        return minutes + ":" + (rest < 10 ? "0" : "") + rest
+    }
+
+    function centsColor(cents) {
+        if (Math.abs(cents) < 5) return "#4CAF50"
+        else if (Math.abs(cents) < 15) return "#FFC107"
+        else return "#FF5722"
+    }
+
+    // The queries only read chunk summaries, refreshing during a session is cheap
+    Timer {
+        interval: 2000
+        repeat: true
+        running: root.visible && tuner.sessionRecording
+        triggeredOnStart: true
+        onTriggered: root.refresh()
+    }
+
+    Connections {
+        target: tuner
+        function onSessionRecordingChanged() {
+            root.refresh()
+        }
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: 4
+
+        RowLayout {
+            Layout.fillWidth: true
+            Layout.margins: 8
+            spacing: 10
+
+            Label {
+                text: "Session " + root.formatDuration(root.statistics.durationSeconds)
+                color: "#ffffff"
+                font.pixelSize: 14
+                Layout.fillWidth: true
+            }
+
+            Label {
+                text: root.statistics.droppedFrames + " frames dropped"
+                color: "#9e9e9e"
+                font.pixelSize: 12
+                visible: root.statistics.droppedFrames > 0
+            }
+
+            Button {
+                text: tuner.sessionRecording ? "Stop" : "Record"
+                flat: true
+                onClicked: tuner.sessionRecording ? tuner.stopSession() : tuner.startSession()
+            }
+        }
+
+        ListView {
+            id: noteList
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            Layout.margins: 8
+            Layout.topMargin: 0
+            clip: true
+            model: root.statistics.notes
+            spacing: 2
+
+            header: RowLayout {
+                width: noteList.width
+                Label { text: "Note"; color: "#9e9e9e"; font.pixelSize: 12; Layout.preferredWidth: 50 }
+                Label { text: "Mean ± SD"; color: "#9e9e9e"; font.pixelSize: 12; Layout.preferredWidth: 100 }
+                Label { text: "In tune"; color: "#9e9e9e"; font.pixelSize: 12; Layout.preferredWidth: 90 }
+                Label { text: "Drift"; color: "#9e9e9e"; font.pixelSize: 12; Layout.preferredWidth: 80 }
+                Label { text: "Over time"; color: "#9e9e9e"; font.pixelSize: 12; Layout.fillWidth: true }
+            }
+
+            delegate: RowLayout {
+                required property var modelData
+                width: noteList.width
+                height: 24
+
+                Label {
+                    text: modelData.note
+                    color: "#ffffff"
+                    Layout.preferredWidth: 50
+                }
+                Label {
+                    text: (modelData.meanCents >= 0 ? "+" : "") + modelData.meanCents.toFixed(1) +
+                          " ± " + modelData.stddevCents.toFixed(1)
+                    color: root.centsColor(modelData.meanCents)
+                    Layout.preferredWidth: 100
+                }
+                Label {
+                    text: (modelData.inTuneFraction * 100).toFixed(0) + "% of " + modelData.seconds.toFixed(0) + " s"
+                    color: "#ffffff"
+                    Layout.preferredWidth: 90
+                }
+                Label {
+                    text: (modelData.driftCentsPerMinute >= 0 ? "+" : "") +
+                          modelData.driftCentsPerMinute.toFixed(2) + " c/min"
+                    color: "#ffffff"
+                    Layout.preferredWidth: 80
+                }
+
+                // Mean cents per log chunk, the centre line is in tune, the edges are ±25 cents
+                Canvas {
+                    id: timeline
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    property var points: modelData.timeline
+                    onPointsChanged: requestPaint()
+                    onWidthChanged: requestPaint()
+
+                    onPaint: {
+                        let ctx = getContext("2d")
+                        ctx.clearRect(0, 0, width, height)
+                        ctx.strokeStyle = "#555555"
+                        ctx.beginPath()
+                        ctx.moveTo(0, height / 2)
+                        ctx.lineTo(width, height / 2)
+                        ctx.stroke()
+
+                        let duration = Math.max(root.statistics.durationSeconds, 1)
+                        ctx.strokeStyle = root.centsColor(modelData.meanCents)
+                        ctx.beginPath()
+                        for (let i = 0; i < points.length; ++i) {
+                            let x = points[i].seconds / duration * width
+                            let y = height / 2 - Math.max(-25, Math.min(25, points[i].cents)) / 25 * (height / 2)
+                            if (i === 0) ctx.moveTo(x, y)
+                            else ctx.lineTo(x, y)
+                        }
+                        ctx.stroke()
+                    }
+                }
+            }
+
+            Label {
+                anchors.centerIn: parent
+                visible: noteList.count === 0
+                text: tuner.sessionRecording ? "Play a note to start the log" : "Record a session to review its intonation"
+                color: "#9e9e9e"
+            }
+        }
+    }
+}
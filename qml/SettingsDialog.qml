@@ -21,6 +21,7 @@ Dialog {
         property int bufferSize: 8112
         property int maxPeaks: 10
         property double referenceA: 440.0
+        property bool autoConfigure: true
     }
 
     // Load settings when dialog is created
@@ -31,17 +32,52 @@ Dialog {
         referenceASpinBox.value = settingsStorage.referenceA
         methodComboBox.currentText = tuner.detectionMethod
         fftPaddingSlider.value = tuner.fftPadding
+        deviceBufferSizeSlider.value = tuner.deviceBufferSize
         thresholdSlider.value = tuner.dbThreshold
+        adaptiveWindowSwitch.checked = tuner.adaptiveWindow
+        powerSaveSwitch.checked = tuner.powerSave
+        strobeModeSwitch.checked = tuner.strobeMode
+        fixedPointSwitch.checked = tuner.fixedPoint
+        autoConfigureSwitch.checked = tuner.autoConfigure
+        instrumentComboBox.currentIndex = tuner.instruments.indexOf(tuner.instrument)
+        targetStringComboBox.currentIndex = tuner.targetString + 1
     }
 
-    onAccepted: {
-        tuner.dbThreshold = thresholdSlider.value
-        tuner.sampleRate = sampleRateSlider.value
-        tuner.bufferSize = bufferSizeSlider.value
-        tuner.maxPeaks = maxPeaksSlider.value
-        tuner.referenceA = referenceASpinBox.value
-        tuner.detectionMethod = methodComboBox.currentText
-        tuner.fftPadding = fftPaddingSlider.value
+    onAccepted: applyToTuner()
+
+    // One transaction, so the engine rebuilds each part at most once
+    function applyToTuner() {
+        let settings = {
+            dbThreshold: thresholdSlider.value,
+            sampleRate: parseInt(sampleRateSlider.value),
+            bufferSize: parseInt(bufferSizeSlider.value),
+            deviceBufferSize: parseInt(deviceBufferSizeSlider.value),
+            maxPeaks: maxPeaksSlider.value,
+            referenceA: referenceASpinBox.value,
+            detectionMethod: methodComboBox.currentText,
+            fftPadding: fftPaddingSlider.value,
+            adaptiveWindow: adaptiveWindowSwitch.checked,
+            powerSave: powerSaveSwitch.checked,
+            strobeMode: strobeModeSwitch.checked,
+            fixedPoint: fixedPointSwitch.checked,
+            backlogPolicy: backlogPolicyComboBox.currentText,
+            instrument: instrumentComboBox.currentText,
+            targetString: targetStringComboBox.currentIndex - 1,
+            temperament: temperamentComboBox.currentText,
+            temperamentRoot: temperamentRootComboBox.currentIndex,
+            autoConfigure: autoConfigureSwitch.checked
+        }
+        // The benchmark owns these while auto-configure is on
+        if (autoConfigureSwitch.checked) {
+            delete settings.sampleRate
+            delete settings.bufferSize
+            delete settings.fftPadding
+            delete settings.detectionMethod
+        }
+        if (temperamentComboBox.currentText === "Custom") {
+            settings.customCents = customCentsField.text.split(",").map(v => parseFloat(v) || 0)
+        }
+        tuner.applySettings(settings)
     }
 
     Flickable {
@@ -56,6 +92,74 @@ Dialog {
             width: parent.width
             spacing: 16
 
+            // Instrument and target string
+            Label {
+                text: "Instrument"
+                font.bold: true
+            }
+            RowLayout {
+                Layout.fillWidth: true
+                ComboBox {
+                    id: instrumentComboBox
+                    Layout.fillWidth: true
+                    model: tuner.instruments
+                    currentIndex: tuner.instruments.indexOf(tuner.instrument)
+                }
+                ComboBox {
+                    id: targetStringComboBox
+                    Layout.preferredWidth: 110
+                    model: ["Any string"].concat(tuner.stringNamesFor(instrumentComboBox.currentText))
+                    currentIndex: tuner.targetString + 1
+                }
+            }
+            Label {
+                text: "A target string narrows the search to that string: less work per block and fewer octave errors"
+                font.italic: true
+                Layout.fillWidth: true
+                wrapMode: Text.WordWrap
+            }
+
+            // Analysis settings picked by the startup benchmark
+            Label {
+                text: "Auto-configure"
+                font.bold: true
+            }
+            Switch {
+                id: autoConfigureSwitch
+                text: "Pick analysis settings from a device benchmark"
+                checked: tuner.autoConfigure
+            }
+            RowLayout {
+                Layout.fillWidth: true
+                visible: autoConfigureSwitch.checked
+                BusyIndicator {
+                    running: tuner.autoConfiguring
+                    visible: running
+                    Layout.preferredWidth: 24
+                    Layout.preferredHeight: 24
+                }
+                Label {
+                    property var profile: tuner.autoConfigProfile
+                    Layout.fillWidth: true
+                    wrapMode: Text.WordWrap
+                    font.italic: true
+                    text: tuner.autoConfiguring ? "Benchmarking..."
+                          : profile.detectionMethod === undefined ? "Not benchmarked yet"
+                          : profile.detectionMethod + ", " + profile.sampleRate + " Hz, "
+                            + profile.bufferSize + " samples, " + profile.fftPadding + "x padding\n"
+                            + (profile.cpuShare * 100).toFixed(1) + "% CPU, "
+                            + profile.latencyMs.toFixed(0) + " ms latency, "
+                            + profile.errorCents.toFixed(2) + " cents error, "
+                            + tuner.autoConfigHeadroom.toFixed(0) + "× real time"
+                            + (profile.fits ? "" : "\nNo candidate fit the budget, using the cheapest")
+                }
+                Button {
+                    text: "Re-run"
+                    enabled: !tuner.autoConfiguring
+                    onClicked: tuner.runAutoConfiguration()
+                }
+            }
+
             // Detection Method
             Label {
                 text: "Detection Method"
@@ -64,7 +168,8 @@ Dialog {
             ComboBox {
                 id: methodComboBox
                 Layout.fillWidth: true
-                model: ["FFT", "Autocorrelation"]
+                enabled: !autoConfigureSwitch.checked
+                model: tuner.detectionMethods
                 currentIndex: model.indexOf(tuner.detectionMethod)
             }
 
@@ -72,13 +177,11 @@ Dialog {
             Label {
                 text: "FFT Settings"
                 font.bold: true
-                visible: methodComboBox.currentText === "FFT"
             }
 
             // FFT Padding
             Label {
                 text: "FFT Padding: " + fftPaddingSlider.value + "x"
-                visible: methodComboBox.currentText === "FFT"
             }
             Slider {
                 id: fftPaddingSlider
@@ -87,7 +190,7 @@ Dialog {
                 to: 8
                 stepSize: 1
                 value: tuner.fftPadding
-                visible: methodComboBox.currentText === "FFT"
+                enabled: !autoConfigureSwitch.checked
 
                 ToolTip {
                     parent: fftPaddingSlider.handle
@@ -125,6 +228,7 @@ Dialog {
                 to: tuner.maximumSampleRate
                 stepSize: 100
                 value: tuner.sampleRate
+                enabled: !autoConfigureSwitch.checked
             }
 
             // Buffer Size
@@ -138,6 +242,77 @@ Dialog {
                 to: 16384
                 stepSize: 1024
                 value: tuner.bufferSize
+                enabled: !autoConfigureSwitch.checked
+            }
+
+            // Input device buffer, trades callback rate against capture latency
+            Label {
+                text: deviceBufferSizeSlider.value > 0
+                      ? "Device Buffer: " + deviceBufferSizeSlider.value + " samples ("
+                        + (deviceBufferSizeSlider.value / tuner.sampleRate * 1000).toFixed(1) + " ms)"
+                      : "Device Buffer: system default"
+                        + (tuner.actualDeviceBufferSize > 0 ? " (" + tuner.actualDeviceBufferSize + " samples)" : "")
+            }
+            Slider {
+                id: deviceBufferSizeSlider
+                Layout.fillWidth: true
+                from: 0
+                to: 4096
+                stepSize: 256
+                value: tuner.deviceBufferSize
+            }
+            Label {
+                property int fastSize: tuner.suggestedBufferSize(bufferSizeSlider.value)
+                visible: fastSize !== bufferSizeSlider.value
+                text: "Nearest fast FFT size: " + fastSize + " samples"
+                font.italic: true
+                Layout.fillWidth: true
+            }
+
+            // What to do with audio that piled up while analysis fell behind
+            Label {
+                text: "When analysis falls behind"
+            }
+            ComboBox {
+                id: backlogPolicyComboBox
+                Layout.fillWidth: true
+                model: tuner.backlogPolicies
+                currentIndex: model.indexOf(tuner.backlogPolicy)
+            }
+            Label {
+                text: tuner.backlogStats.droppedBlocks + " of " +
+                      (tuner.backlogStats.processedBlocks + tuner.backlogStats.droppedBlocks) +
+                      " blocks dropped, longest backlog " + tuner.backlogStats.maxBacklogMs.toFixed(0) + " ms"
+                font.italic: true
+                Layout.fillWidth: true
+            }
+
+            // Adaptive analysis window
+            Switch {
+                id: adaptiveWindowSwitch
+                text: "Adaptive window (sized to the played pitch)"
+                checked: tuner.adaptiveWindow
+            }
+
+            // Phase-vocoder precision on short frames
+            Switch {
+                id: strobeModeSwitch
+                text: "Strobe mode (sub-cent precision, short frames)"
+                checked: tuner.strobeMode
+            }
+
+            // Integer analysis for devices without a fast FPU
+            Switch {
+                id: fixedPointSwitch
+                text: "Integer (Q15) pipeline for slow FPUs"
+                checked: tuner.fixedPoint
+            }
+
+            // Idle mode after a stretch of silence
+            Switch {
+                id: powerSaveSwitch
+                text: "Power save after " + tuner.idleDelay.toFixed(0) + " s of silence"
+                checked: tuner.powerSave
             }
 
             // Visualization Settings Section
@@ -184,6 +359,72 @@ Dialog {
                 }
             }
 
+            // Temperament
+            Label {
+                text: "Temperament"
+            }
+            RowLayout {
+                Layout.fillWidth: true
+                ComboBox {
+                    id: temperamentComboBox
+                    Layout.fillWidth: true
+                    model: ["Equal", "Pythagorean", "Just", "Custom"]
+                    currentIndex: model.indexOf(tuner.temperament)
+                }
+                ComboBox {
+                    id: temperamentRootComboBox
+                    Layout.preferredWidth: 90
+                    model: ["C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"]
+                    currentIndex: tuner.temperamentRoot
+                    enabled: temperamentComboBox.currentText === "Pythagorean" || temperamentComboBox.currentText === "Just"
+                }
+            }
+            Label {
+                text: "Pythagorean tunes pure fifths from the root, Just tunes against a drone on the root"
+                font.italic: true
+                Layout.fillWidth: true
+                wrapMode: Text.WordWrap
+            }
+            TextField {
+                id: customCentsField
+                Layout.fillWidth: true
+                visible: temperamentComboBox.currentText === "Custom"
+                placeholderText: "Cents offsets C, C#, D ... B"
+                text: tuner.customCents.map(c => c.toFixed(1)).join(", ")
+            }
+
+            // Diagnostics Section
+            Label {
+                text: "Diagnostics"
+                font.bold: true
+            }
+
+            Switch {
+                id: captureSwitch
+                text: "Record raw input for bug reports"
+                checked: tuner.capturing
+                onToggled: {
+                    if (checked) {
+                        checked = tuner.startCapture("")
+                    } else {
+                        tuner.stopCapture()
+                    }
+                }
+            }
+
+            Switch {
+                id: resultServerSwitch
+                text: "Stream results to other displays (UDP and WebSocket)"
+                checked: tuner.resultServerRunning
+                onToggled: {
+                    if (checked) {
+                        checked = tuner.startResultServer()
+                    } else {
+                        tuner.stopResultServer()
+                    }
+                }
+            }
+
             // Info Section
             Label {
                 text: "Information"
@@ -198,10 +439,17 @@ Dialog {
             }
 
             Label {
-                text: "Current frequency resolution: " + 
-                      (methodComboBox.currentText === "FFT" ? 
-                      (tuner.sampleRate / (tuner.bufferSize * fftPaddingSlider.value)).toFixed(2) :
-                      (tuner.sampleRate / tuner.bufferSize).toFixed(2)) + " Hz"
+                // Every method reads the same padded spectrum
+                text: "Current frequency resolution: " +
+                      (tuner.sampleRate / (tuner.bufferSize * fftPaddingSlider.value)).toFixed(2) + " Hz"
+                font.italic: true
+                Layout.fillWidth: true
+                wrapMode: Text.WordWrap
+            }
+
+            Label {
+                text: "Analysis window: " + tuner.analysisWindowSize + " samples" +
+                      (tuner.lastLockTime > 0 ? ", last time to lock: " + tuner.lastLockTime.toFixed(0) + " ms" : "")
                 font.italic: true
                 Layout.fillWidth: true
                 wrapMode: Text.WordWrap
@@ -216,17 +464,13 @@ Dialog {
             highlighted: true
             onClicked: {
                 // Apply and save settings
-                tuner.sampleRate = parseInt(sampleRateSlider.value)
-                tuner.bufferSize = parseInt(bufferSizeSlider.value)
-                tuner.maxPeaks = maxPeaksSlider.value
-                tuner.referenceA = referenceASpinBox.value
-                tuner.detectionMethod = methodComboBox.currentText
-                tuner.fftPadding = fftPaddingSlider.value
+                applyToTuner()
 
                 settingsStorage.sampleRate = tuner.sampleRate
                 settingsStorage.bufferSize = tuner.bufferSize
                 settingsStorage.maxPeaks = tuner.maxPeaks
                 settingsStorage.referenceA = tuner.referenceA
+                settingsStorage.autoConfigure = tuner.autoConfigure
                 settingsDialog.close()
             }
         }
@@ -260,9 +504,50 @@ Dialog {
         }
 
         Label {
-            text: "Latency: " + (tuner.bufferSize / tuner.sampleRate * 1000).toFixed(1) + " ms"
+            text: "Window: " + (tuner.bufferSize / tuner.sampleRate * 1000).toFixed(1) + " ms"
             color: "#9e9e9e"
         }
+
+        // Measured from device capture to the frame showing the note
+        Label {
+            property var total: tuner.latencyStats["total"]
+            text: total && total.count > 0
+                  ? "Latency: " + total.p50Ms.toFixed(1) + " ms median, " + total.p99Ms.toFixed(1) + " ms p99"
+                  : "Latency: not measured yet"
+            color: "#9e9e9e"
+        }
+
+        Repeater {
+            model: ["capture", "analysis", "properties", "render"]
+            Label {
+                property var stage: tuner.latencyStats[modelData]
+                visible: stage !== undefined && stage.count > 0
+                text: visible ? "  " + modelData + ": " + stage.p50Ms.toFixed(1) + " / "
+                                + stage.p99Ms.toFixed(1) + " ms" : ""
+                color: "#757575"
+                font.pixelSize: 12
+            }
+        }
+
+        // Distribution of the total, one bar per histogram bucket
+        Row {
+            id: latencyBars
+            property var total: tuner.latencyStats["total"]
+            property int largest: total ? Math.max(1, ...total.buckets.map(b => b.count)) : 1
+            visible: total !== undefined && total.count > 0
+            spacing: 1
+            height: 24
+
+            Repeater {
+                model: latencyBars.total ? latencyBars.total.buckets : []
+                Rectangle {
+                    width: 4
+                    height: Math.max(1, latencyBars.height * modelData.count / latencyBars.largest)
+                    anchors.bottom: parent.bottom
+                    color: "#4CAF50"
+                }
+            }
+        }
     }
 
     // Donation section
@@ -0,0 +1,48 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+import CelloTuner
+
+Rectangle {
+    id: root
+    color: "#2d2d2d"
+    radius: 4
+
+    property alias logarithmicScale: spectrum.logarithmicScale
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: 4
+
+        RowLayout {
+            Layout.fillWidth: true
+            Layout.margins: 8
+            spacing: 10
+
+            Label {
+                text: "Spectrum"
+                color: "#ffffff"
+                font.pixelSize: 14
+                Layout.fillWidth: true
+            }
+
+            // Scene graph build time, compare with QSG_RENDER_TIMING=1 for the Canvas view
+            Label {
+                text: spectrum.frameTime.toFixed(2) + " ms/frame"
+                color: "#9e9e9e"
+                font.pixelSize: 12
+            }
+        }
+
+        SpectrumItem {
+            id: spectrum
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            Layout.margins: 8
+            Layout.topMargin: 0
+            engine: tuner
+            minFrequency: 50
+            maxFrequency: 1100
+        }
+    }
+}
@@ -38,15 +38,28 @@ ApplicationWindow {
         property int maxPeaks: 10
         property double referenceA: 440.0
         property double dbThreshold: -70.0
+        property int visualizationTab: 0
+        property bool autoConfigure: true
+        property int toneNote: 57
+        property bool toneFifth: false
+        property string toneTimbre: "Cello"
+        property double toneVolume: 0.5
     }
 
     // Load settings when app starts
     Component.onCompleted: {
-        tuner.sampleRate = appSettings.sampleRate
-        tuner.bufferSize = appSettings.bufferSize
-        tuner.maxPeaks = appSettings.maxPeaks
-        tuner.referenceA = appSettings.referenceA
-        tuner.dbThreshold = appSettings.dbThreshold
+        tuner.applySettings({
+            sampleRate: appSettings.sampleRate,
+            bufferSize: appSettings.bufferSize,
+            maxPeaks: appSettings.maxPeaks,
+            referenceA: appSettings.referenceA,
+            dbThreshold: appSettings.dbThreshold,
+            autoConfigure: appSettings.autoConfigure,
+            toneNote: appSettings.toneNote,
+            toneFifth: appSettings.toneFifth,
+            toneTimbre: appSettings.toneTimbre,
+            toneVolume: appSettings.toneVolume
+        })
     }
 
     // Add property change monitoring
@@ -331,6 +344,7 @@ ApplicationWindow {
                 height: parent.height - 10
                 radius: 2
                 color: "white"
+                opacity: 0.4 + 0.6 * tuner.pitchConfidence  // Faint until the tracker has settled
                 anchors.verticalCenter: parent.verticalCenter
                 x: parent.width / 2 + (tuner.cents * parent.width / 100)
                 
@@ -364,6 +378,61 @@ ApplicationWindow {
             }
         }
 
+        // Partial series of the current note: string stiffness and wolf tones
+        RowLayout {
+            Layout.fillWidth: true
+            visible: tuner.partials.length > 0
+            spacing: 12
+
+            Label {
+                text: tuner.partials.length + " partials, B = " +
+                      (tuner.inharmonicity > 0 ? tuner.inharmonicity.toExponential(1) : "0")
+                color: "#9e9e9e"
+                font.pixelSize: 12
+                Layout.fillWidth: true
+            }
+            Label {
+                text: "Wolf tone"
+                color: "#FF5722"
+                font.pixelSize: 12
+                font.bold: true
+                visible: tuner.wolfTone
+            }
+        }
+
+        // Strobe: stripes drift with the phase error against the nearest note,
+        // standing still when in tune, moving right when sharp and left when flat
+        Rectangle {
+            id: strobe
+            visible: tuner.strobeMode
+            Layout.fillWidth: true
+            Layout.preferredHeight: 36
+            color: "#2d2d2d"
+            radius: 8
+            clip: true
+
+            readonly property real period: 48
+
+            Row {
+                x: -strobe.period + tuner.strobePhase * strobe.period
+                height: parent.height
+                opacity: tuner.strobeActive ? 1.0 : 0.3
+
+                Repeater {
+                    model: Math.ceil(strobe.width / strobe.period) + 2
+                    Item {
+                        width: strobe.period
+                        height: strobe.height
+                        Rectangle {
+                            width: strobe.period / 2
+                            height: parent.height
+                            color: Math.abs(tuner.cents) < 5 ? "#4CAF50" : "#FFC107"
+                        }
+                    }
+                }
+            }
+        }
+
         // Frequency and tuning information
         ColumnLayout {
             Layout.alignment: Qt.AlignHCenter
@@ -402,11 +471,91 @@ ApplicationWindow {
             }
         }
 
-        // Peak visualization
-        PeakView {
+        // Reference tone or drone to tune against, played on the default output
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 6
+
+            Switch {
+                text: "Tone"
+                checked: tuner.toneEnabled
+                onToggled: tuner.toneEnabled = checked
+            }
+            ToolButton {
+                text: "−"
+                onClicked: {
+                    tuner.toneNote = tuner.toneNote - 1
+                    appSettings.toneNote = tuner.toneNote
+                }
+            }
+            Label {
+                text: tuner.toneNoteName + "  " + tuner.toneFrequency.toFixed(1) + " Hz"
+                color: "#ffffff"
+                horizontalAlignment: Text.AlignHCenter
+                Layout.preferredWidth: 100
+            }
+            ToolButton {
+                text: "+"
+                onClicked: {
+                    tuner.toneNote = tuner.toneNote + 1
+                    appSettings.toneNote = tuner.toneNote
+                }
+            }
+            CheckBox {
+                text: "Fifth"
+                checked: tuner.toneFifth
+                onToggled: {
+                    tuner.toneFifth = checked
+                    appSettings.toneFifth = checked
+                }
+            }
+            ComboBox {
+                model: tuner.toneTimbres
+                currentIndex: model.indexOf(tuner.toneTimbre)
+                onActivated: {
+                    tuner.toneTimbre = currentText
+                    appSettings.toneTimbre = currentText
+                }
+            }
+            Slider {
+                Layout.fillWidth: true
+                from: 0
+                to: 1
+                value: tuner.toneVolume
+                onMoved: {
+                    tuner.toneVolume = value
+                    appSettings.toneVolume = value
+                }
+            }
+        }
+
+        // Peak visualization, QML peaks or native spectrum/waterfall, or the session log
+        TabBar {
+            id: visualizationTabs
+            Layout.fillWidth: true
+            currentIndex: appSettings.visualizationTab
+            onCurrentIndexChanged: appSettings.visualizationTab = currentIndex
+            Material.background: "#2d2d2d"
+
+            TabButton { text: "Peaks" }
+            TabButton { text: "Spectrum" }
+            TabButton { text: "Session" }
+        }
+
+        StackLayout {
             Layout.fillWidth: true
             Layout.preferredHeight: 200
-            peaks: tuner.peaks
+            currentIndex: visualizationTabs.currentIndex
+
+            PeakView {
+                peaks: tuner.peaks
+            }
+
+            SpectrumView {
+            }
+
+            SessionView {
+            }
         }
     }
 }
@@ -6,8 +6,11 @@
 
 #include "qmlapp.h"
 #include "tunerengine.h"
+#include "ui/spectrumitem.h"
+#include "tools/startupProfile.h"
 
 #include <QDir>
+#include <QQuickWindow>
 #include <QStandardPaths>
 #ifdef Q_OS_ANDROID
 #include <QJniObject.h>
@@ -18,15 +21,45 @@ QmlApp::QmlApp(QWindow *parent)
     , m_tunerEngine(new TunerEngine(this))
 {
     QQuickStyle::setStyle("Material");
+
+    qmlRegisterUncreatableType<TunerEngine>("CelloTuner", 1, 0, "TunerEngine", "Use the tuner context property");
+    qmlRegisterType<SpectrumItem>("CelloTuner", 1, 0, "SpectrumItem");
     
     // Expose the tuner engine to QML before loading the QML file
     rootContext()->setContextProperty("tuner", m_tunerEngine);
     
-    // Start the tuner
+    // Startup milestones, each connection fires once
+    connect(m_tunerEngine, &TunerEngine::audioInputOpened, this, []() {
+        StartupProfile::mark("audio input opened");
+    }, Qt::SingleShotConnection);
+    connect(m_tunerEngine, &TunerEngine::signalLevelChanged, this, []() {
+        StartupProfile::mark("first audio block");
+    }, Qt::SingleShotConnection);
+    connect(m_tunerEngine, &TunerEngine::noteDetected, this, []() {
+        StartupProfile::mark("first note");
+    }, Qt::SingleShotConnection);
+
+    // Start the tuner, the device opens once the background probe is done and
+    // main.qml has applied the stored settings, so the source is built only once
     m_tunerEngine->start();
     
     qDebug() << "set UI link";
     load(QUrl("qrc:/qml/main.qml"));
+
+    if (auto *window = qobject_cast<QQuickWindow*>(rootObjects().value(0))) {
+        connect(window, &QQuickWindow::frameSwapped, this, []() {
+            StartupProfile::mark("first frame");
+        }, Qt::SingleShotConnection);
+
+        // Swapped on the render thread, take the time there and hand it to the engine
+        TunerEngine *engine = m_tunerEngine;
+        connect(window, &QQuickWindow::frameSwapped, engine, [engine]() {
+            qint64 usecs = engine->monotonicUSecs();
+            QMetaObject::invokeMethod(engine, [engine, usecs]() {
+                engine->frameRendered(usecs);
+            }, Qt::QueuedConnection);
+        }, Qt::DirectConnection);
+    }
 }
 
 bool QmlApp::event(QEvent *event)
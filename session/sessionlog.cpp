@@ -0,0 +1,443 @@
+#include "sessionlog.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+
+using namespace SessionLogFormat;
+
+namespace {
+
+constexpr char FILE_MAGIC[4] = {'C', 'T', 'S', 'L'};
+constexpr quint32 CHUNK_MAGIC = 0x4b434c53;  // "SLCK"
+constexpr int DRAIN_BATCH = 256;
+
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    quint32 chunkFrames;
+    quint32 reserved;
+    qint64 startMSecsSinceEpoch;
+};
+static_assert(sizeof(FileHeader) <= HEADER_SIZE, "File header does not fit");
+
+template<typename T>
+T *column(uchar *chunk, int offset) { return reinterpret_cast<T *>(chunk + offset); }
+
+template<typename T>
+const T *column(const uchar *chunk, int offset) { return reinterpret_cast<const T *>(chunk + offset); }
+
+void accumulate(NoteSummary &summary, double cents, qint64 timestampUSecs, qint64 previousUSecs)
+{
+    const double duration = previousUSecs < 0 ? 0.0 :
+            std::clamp<qint64>(timestampUSecs - previousUSecs, 0, MAX_FRAME_GAP_USECS) / 1e6;
+    const double time = timestampUSecs / 1e6;
+    ++summary.frames;
+    summary.seconds += duration;
+    if (std::abs(cents) <= IN_TUNE_CENTS) summary.inTuneSeconds += duration;
+    summary.sumCents += cents;
+    summary.sumCentsSquared += cents * cents;
+    summary.sumTime += time;
+    summary.sumTimeSquared += time * time;
+    summary.sumTimeCents += time * cents;
+}
+
+void merge(NoteSummary &into, const NoteSummary &from)
+{
+    into.frames += from.frames;
+    into.seconds += from.seconds;
+    into.inTuneSeconds += from.inTuneSeconds;
+    into.sumCents += from.sumCents;
+    into.sumCentsSquared += from.sumCentsSquared;
+    into.sumTime += from.sumTime;
+    into.sumTimeSquared += from.sumTimeSquared;
+    into.sumTimeCents += from.sumTimeCents;
+}
+
+}
+
+std::vector<NoteIntonation> SessionLogFormat::intonation(const std::vector<const uchar *> &chunks,
+                                                         qint64 fromUSecs, qint64 toUSecs)
+{
+    if (toUSecs < 0) toUSecs = std::numeric_limits<qint64>::max();
+
+    std::array<NoteSummary, NOTE_COUNT> totals{};
+    std::array<std::vector<std::pair<double, double>>, NOTE_COUNT> timelines;
+    std::array<NoteSummary, NOTE_COUNT> partial;
+
+    for (const uchar *chunk : chunks) {
+        const auto *header = reinterpret_cast<const ChunkHeader *>(chunk);
+        const int frameCount = static_cast<int>(header->frameCount);
+        if (frameCount == 0) break;
+        if (header->lastUSecs < fromUSecs || header->firstUSecs >= toUSecs) continue;
+
+        // Chunks inside the range answer from their summary, the ones cut by it are scanned
+        const NoteSummary *notes = header->notes.data();
+        if (header->firstUSecs < fromUSecs || header->lastUSecs >= toUSecs) {
+            partial.fill(NoteSummary());
+            const qint64 *timestamps = column<qint64>(chunk, TIMESTAMP_OFFSET);
+            const float *cents = column<float>(chunk, CENTS_OFFSET);
+            const qint16 *midiNotes = column<qint16>(chunk, NOTE_OFFSET);
+            for (int row = 0; row < frameCount; ++row) {
+                if (timestamps[row] < fromUSecs || timestamps[row] >= toUSecs) continue;
+                if (midiNotes[row] < 0 || midiNotes[row] >= NOTE_COUNT) continue;
+                qint64 previous = row > 0 ? timestamps[row - 1] : header->previousUSecs;
+                accumulate(partial[midiNotes[row]], cents[row], timestamps[row], previous);
+            }
+            notes = partial.data();
+        }
+
+        for (int note = 0; note < NOTE_COUNT; ++note) {
+            const NoteSummary &summary = notes[note];
+            if (summary.frames == 0) continue;
+            merge(totals[note], summary);
+            timelines[note].emplace_back(summary.sumTime / summary.frames, summary.sumCents / summary.frames);
+        }
+    }
+
+    std::vector<NoteIntonation> result;
+    for (int note = 0; note < NOTE_COUNT; ++note) {
+        const NoteSummary &total = totals[note];
+        if (total.frames == 0) continue;
+
+        const double n = total.frames;
+        NoteIntonation intonation;
+        intonation.midiNote = note;
+        intonation.frames = static_cast<int>(total.frames);
+        intonation.seconds = total.seconds;
+        intonation.inTuneSeconds = total.inTuneSeconds;
+        intonation.meanCents = total.sumCents / n;
+        intonation.stddevCents = std::sqrt(std::max(total.sumCentsSquared / n - intonation.meanCents * intonation.meanCents, 0.0));
+
+        // No slope for a note held only for an instant
+        const double timeSpread = n * total.sumTimeSquared - total.sumTime * total.sumTime;
+        if (timeSpread > 1e-9 * n * total.sumTimeSquared && timeSpread > n * n) {
+            intonation.driftCentsPerMinute = 60.0 * (n * total.sumTimeCents - total.sumTime * total.sumCents) / timeSpread;
+        }
+        intonation.timeline = std::move(timelines[note]);
+        result.push_back(std::move(intonation));
+    }
+    return result;
+}
+
+bool SessionLogReader::open(const QString &path)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 size = m_file.size();
+    const uchar *base = size >= HEADER_SIZE ? m_file.map(0, size) : nullptr;
+    FileHeader header;
+    if (base) std::memcpy(&header, base, sizeof(header));
+    if (!base || std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        header.version != VERSION || header.chunkFrames != CHUNK_FRAMES) {
+        qWarning() << "Not a session log:" << path;
+        close();
+        return false;
+    }
+
+    m_startMSecs = header.startMSecsSinceEpoch;
+    for (qint64 offset = HEADER_SIZE; offset + CHUNK_SIZE <= size; offset += CHUNK_SIZE) {
+        if (reinterpret_cast<const ChunkHeader *>(base + offset)->magic != CHUNK_MAGIC) break;
+        m_chunks.push_back(base + offset);
+    }
+    return true;
+}
+
+void SessionLogReader::close()
+{
+    m_chunks.clear();
+    m_file.close();
+}
+
+qint64 SessionLogReader::frameCount() const
+{
+    qint64 frames = 0;
+    for (const uchar *chunk : m_chunks) frames += reinterpret_cast<const ChunkHeader *>(chunk)->frameCount;
+    return frames;
+}
+
+qint64 SessionLogReader::durationUSecs() const
+{
+    for (auto it = m_chunks.rbegin(); it != m_chunks.rend(); ++it) {
+        const auto *header = reinterpret_cast<const ChunkHeader *>(*it);
+        if (header->frameCount > 0) return header->lastUSecs;
+    }
+    return 0;
+}
+
+std::vector<NoteIntonation> SessionLogReader::intonation(qint64 fromUSecs, qint64 toUSecs) const
+{
+    return SessionLogFormat::intonation(m_chunks, fromUSecs, toUSecs);
+}
+
+// Lives on the log thread and owns the file and its chunk maps
+class SessionLog::Writer : public QObject
+{
+public:
+    ~Writer() { close(); }
+
+    bool open(const QString &path);
+    void close();
+    void write(const SessionFrame *frames, int count);
+
+    std::vector<NoteIntonation> intonation(qint64 fromUSecs, qint64 toUSecs) const
+    {
+        return SessionLogFormat::intonation(m_chunks, fromUSecs, toUSecs);
+    }
+    qint64 durationUSecs() const { return std::max<qint64>(m_lastUSecs, 0); }
+
+private:
+    bool addChunk();
+
+    QFile m_file;
+    std::vector<const uchar *> m_chunks;
+    uchar *m_current = nullptr;
+    qint64 m_lastUSecs = -1;
+};
+
+bool SessionLog::Writer::open(const QString &path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        qWarning() << "Cannot write session log" << path << m_file.errorString();
+        return false;
+    }
+
+    QByteArray header(HEADER_SIZE, '\0');
+    FileHeader fileHeader;
+    std::memcpy(fileHeader.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    fileHeader.version = VERSION;
+    fileHeader.chunkFrames = CHUNK_FRAMES;
+    fileHeader.reserved = 0;
+    fileHeader.startMSecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+    std::memcpy(header.data(), &fileHeader, sizeof(fileHeader));
+    if (m_file.write(header) != HEADER_SIZE || !m_file.flush()) {
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+void SessionLog::Writer::close()
+{
+    if (!m_file.isOpen()) return;
+    // Maps outlive close() otherwise, unmapping writes the dirty pages back
+    for (const uchar *chunk : m_chunks) m_file.unmap(const_cast<uchar *>(chunk));
+    m_chunks.clear();
+    m_current = nullptr;
+    m_file.close();
+}
+
+bool SessionLog::Writer::addChunk()
+{
+    const qint64 offset = HEADER_SIZE + static_cast<qint64>(m_chunks.size()) * CHUNK_SIZE;
+    uchar *chunk = m_file.resize(offset + CHUNK_SIZE) ? m_file.map(offset, CHUNK_SIZE) : nullptr;
+    if (!chunk) {
+        qWarning() << "Session log cannot grow" << m_file.fileName() << m_file.errorString();
+        m_current = nullptr;
+        return false;
+    }
+
+    // Resizing zero-fills, so every summary starts empty
+    auto *header = new (chunk) ChunkHeader;
+    header->magic = CHUNK_MAGIC;
+    header->previousUSecs = m_lastUSecs;
+    m_chunks.push_back(chunk);
+    m_current = chunk;
+    return true;
+}
+
+void SessionLog::Writer::write(const SessionFrame *frames, int count)
+{
+    if (!m_file.isOpen()) return;
+
+    for (int i = 0; i < count; ++i) {
+        const SessionFrame &frame = frames[i];
+        auto *header = reinterpret_cast<ChunkHeader *>(m_current);
+        if (!header || header->frameCount == CHUNK_FRAMES) {
+            if (!addChunk()) return;
+            header = reinterpret_cast<ChunkHeader *>(m_current);
+        }
+
+        const int row = static_cast<int>(header->frameCount);
+        column<qint64>(m_current, TIMESTAMP_OFFSET)[row] = frame.timestampUSecs;
+        column<float>(m_current, FREQUENCY_OFFSET)[row] = frame.frequency;
+        column<float>(m_current, CENTS_OFFSET)[row] = frame.cents;
+        column<float>(m_current, LEVEL_OFFSET)[row] = frame.levelDb;
+        column<float>(m_current, CONFIDENCE_OFFSET)[row] = frame.confidence;
+        column<qint16>(m_current, NOTE_OFFSET)[row] = frame.midiNote;
+
+        if (frame.midiNote >= 0 && frame.midiNote < NOTE_COUNT) {
+            accumulate(header->notes[frame.midiNote], frame.cents, frame.timestampUSecs, m_lastUSecs);
+        }
+        if (row == 0) header->firstUSecs = frame.timestampUSecs;
+        header->lastUSecs = frame.timestampUSecs;
+        header->frameCount = row + 1;
+        m_lastUSecs = frame.timestampUSecs;
+    }
+}
+
+SessionLog::SessionLog(QObject *parent)
+    : QObject(parent)
+{
+    m_thread.setObjectName("SessionLog");
+}
+
+SessionLog::~SessionLog()
+{
+    stop();
+}
+
+bool SessionLog::start(const QString &path)
+{
+    stop();
+
+    auto *writer = new Writer;
+    writer->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, writer, &QObject::deleteLater);
+    m_thread.start();
+
+    bool opened = false;
+    QMetaObject::invokeMethod(writer, [&]() {
+        opened = writer->open(path);
+    }, Qt::BlockingQueuedConnection);
+
+    if (!opened) {
+        m_thread.quit();
+        m_thread.wait();
+        return false;
+    }
+
+    m_path = path;
+    QMutexLocker locker(&m_mutex);
+    m_writer = writer;
+    m_droppedFrames = 0;
+    return true;
+}
+
+void SessionLog::stop()
+{
+    if (!m_thread.isRunning()) return;
+
+    Writer *writer;
+    {
+        QMutexLocker locker(&m_mutex);
+        writer = m_writer;
+        m_writer = nullptr;
+    }
+    // Frames still queued belong to the session, write them before closing
+    if (writer) {
+        QMetaObject::invokeMethod(writer, [this, writer]() {
+            drain(writer);
+            writer->close();
+        }, Qt::BlockingQueuedConnection);
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        m_queueCount = 0;
+        m_drainScheduled = false;
+    }
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void SessionLog::append(const SessionFrame &frame)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_writer) return;
+
+    if (m_queueCount == QUEUE_CAPACITY) {
+        m_queueHead = (m_queueHead + 1) % QUEUE_CAPACITY;
+        --m_queueCount;
+        ++m_droppedFrames;
+    }
+    m_queue[(m_queueHead + m_queueCount) % QUEUE_CAPACITY] = frame;
+    ++m_queueCount;
+
+    // One wake-up per burst, the writer takes everything queued by then
+    if (!m_drainScheduled) {
+        m_drainScheduled = true;
+        Writer *writer = m_writer;
+        QMetaObject::invokeMethod(writer, [this, writer]() { drain(writer); }, Qt::QueuedConnection);
+    }
+}
+
+void SessionLog::drain(Writer *writer)
+{
+    // Runs on the log thread
+    std::array<SessionFrame, DRAIN_BATCH> batch;
+    for (;;) {
+        int count = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (count < DRAIN_BATCH && m_queueCount > 0) {
+                batch[count++] = m_queue[m_queueHead];
+                m_queueHead = (m_queueHead + 1) % QUEUE_CAPACITY;
+                --m_queueCount;
+            }
+            if (count == 0) {
+                m_drainScheduled = false;
+                return;
+            }
+        }
+        writer->write(batch.data(), count);
+    }
+}
+
+std::vector<NoteIntonation> SessionLog::intonation(qint64 fromUSecs, qint64 toUSecs)
+{
+    Writer *writer;
+    {
+        QMutexLocker locker(&m_mutex);
+        writer = m_writer;
+    }
+
+    std::vector<NoteIntonation> result;
+    if (writer) {
+        // Between two writes on the log thread, including the frames still queued
+        QMetaObject::invokeMethod(writer, [&]() {
+            drain(writer);
+            result = writer->intonation(fromUSecs, toUSecs);
+        }, Qt::BlockingQueuedConnection);
+        return result;
+    }
+
+    SessionLogReader reader;
+    if (!m_path.isEmpty() && reader.open(m_path)) result = reader.intonation(fromUSecs, toUSecs);
+    return result;
+}
+
+qint64 SessionLog::durationUSecs()
+{
+    Writer *writer;
+    {
+        QMutexLocker locker(&m_mutex);
+        writer = m_writer;
+    }
+
+    qint64 duration = 0;
+    if (writer) {
+        QMetaObject::invokeMethod(writer, [&]() {
+            drain(writer);
+            duration = writer->durationUSecs();
+        }, Qt::BlockingQueuedConnection);
+        return duration;
+    }
+
+    SessionLogReader reader;
+    if (!m_path.isEmpty() && reader.open(m_path)) duration = reader.durationUSecs();
+    return duration;
+}
+
+quint64 SessionLog::droppedFrames() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_droppedFrames;
+}
@@ -0,0 +1,155 @@
+#ifndef SESSIONLOG_H
+#define SESSIONLOG_H
+
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <array>
+#include <utility>
+#include <vector>
+
+// Practice session log format (native byte order, little endian on every target):
+//   header: magic "CTSL", quint32 version, quint32 frames per chunk,
+//           qint64 session start (ms since epoch), padded to HEADER_SIZE
+//   chunks: CHUNK_SIZE bytes each, a summary followed by one column per field
+//           (timestamps, frequency, cents, level, confidence, MIDI note)
+// The file grows one chunk at a time and each chunk is written through a
+// memory map. A chunk's summary holds per-note sums (frames, seconds,
+// seconds in tune, cents, cents squared and the cross terms with time), so
+// intonation queries read the rows of at most the two chunks cut by the
+// time range and only the summaries of everything in between.
+
+// One tracked pitch, appended per analyzed frame
+struct SessionFrame {
+    qint64 timestampUSecs = 0;  // Since the session started
+    float frequency = 0.0f;
+    float cents = 0.0f;
+    float levelDb = 0.0f;
+    float confidence = 0.0f;
+    qint16 midiNote = -1;
+};
+
+// Intonation of one note over the queried time range
+struct NoteIntonation {
+    int midiNote = -1;
+    int frames = 0;
+    double seconds = 0.0;
+    double inTuneSeconds = 0.0;        // Within IN_TUNE_CENTS of the note
+    double meanCents = 0.0;
+    double stddevCents = 0.0;
+    double driftCentsPerMinute = 0.0;  // Least-squares slope of cents over time
+    std::vector<std::pair<double, double>> timeline;  // Session seconds and mean cents, per chunk
+};
+
+namespace SessionLogFormat {
+
+constexpr quint32 VERSION = 1;
+constexpr int HEADER_SIZE = 64;
+constexpr int CHUNK_FRAMES = 2048;
+constexpr int NOTE_COUNT = 128;
+constexpr double IN_TUNE_CENTS = 5.0;
+// A frame stands for the time since the previous one, gaps longer than this are silence
+constexpr qint64 MAX_FRAME_GAP_USECS = 500000;
+
+struct NoteSummary {
+    quint32 frames = 0;
+    quint32 reserved = 0;
+    double seconds = 0.0;
+    double inTuneSeconds = 0.0;
+    double sumCents = 0.0;
+    double sumCentsSquared = 0.0;
+    double sumTime = 0.0;         // Session seconds
+    double sumTimeSquared = 0.0;
+    double sumTimeCents = 0.0;
+};
+
+struct ChunkHeader {
+    quint32 magic = 0;
+    quint32 frameCount = 0;       // Rows written, updated after the row itself
+    qint64 firstUSecs = 0;
+    qint64 lastUSecs = 0;
+    qint64 previousUSecs = -1;    // Last row of the previous chunk
+    std::array<NoteSummary, NOTE_COUNT> notes;
+};
+
+constexpr int alignedSize(int size, int alignment) { return (size + alignment - 1) / alignment * alignment; }
+constexpr int TIMESTAMP_OFFSET = alignedSize(sizeof(ChunkHeader), 8);
+constexpr int FREQUENCY_OFFSET = TIMESTAMP_OFFSET + CHUNK_FRAMES * 8;
+constexpr int CENTS_OFFSET = FREQUENCY_OFFSET + CHUNK_FRAMES * 4;
+constexpr int LEVEL_OFFSET = CENTS_OFFSET + CHUNK_FRAMES * 4;
+constexpr int CONFIDENCE_OFFSET = LEVEL_OFFSET + CHUNK_FRAMES * 4;
+constexpr int NOTE_OFFSET = CONFIDENCE_OFFSET + CHUNK_FRAMES * 4;
+constexpr int CHUNK_SIZE = alignedSize(NOTE_OFFSET + CHUNK_FRAMES * 2, 4096);
+
+// Per-note intonation of [fromUSecs, toUSecs) over mapped chunks, ordered by note
+std::vector<NoteIntonation> intonation(const std::vector<const uchar *> &chunks, qint64 fromUSecs, qint64 toUSecs);
+
+}
+
+// Reads a finished (or still growing) session file through one read-only map
+class SessionLogReader
+{
+public:
+    bool open(const QString &path);
+    void close();
+
+    qint64 startMSecsSinceEpoch() const { return m_startMSecs; }
+    qint64 frameCount() const;
+    qint64 durationUSecs() const;
+    std::vector<NoteIntonation> intonation(qint64 fromUSecs = 0, qint64 toUSecs = -1) const;
+
+private:
+    QFile m_file;
+    std::vector<const uchar *> m_chunks;
+    qint64 m_startMSecs = 0;
+};
+
+// Records a practice session. append() only copies the frame into a bounded
+// queue, the file and its maps live on the log's own thread, so a slow disk
+// never holds up the analysis. When the queue is full the oldest frame is
+// dropped. Queries during a session run on the log thread between writes.
+class SessionLog : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int QUEUE_CAPACITY = 1024;
+
+    explicit SessionLog(QObject *parent = nullptr);
+    ~SessionLog();
+
+    bool start(const QString &path);
+    void stop();
+    bool isRecording() const { return m_thread.isRunning(); }
+    // The current session, or the last one after stop()
+    QString path() const { return m_path; }
+
+    // Safe from any thread, never waits for the disk
+    void append(const SessionFrame &frame);
+
+    // Both include the frames still queued. toUSecs < 0 means up to the newest
+    // frame; the file is read instead when not recording
+    std::vector<NoteIntonation> intonation(qint64 fromUSecs = 0, qint64 toUSecs = -1);
+    qint64 durationUSecs();
+    quint64 droppedFrames() const;
+
+private:
+    class Writer;
+
+    void drain(Writer *writer);
+
+    QThread m_thread;
+    Writer *m_writer = nullptr;
+    QString m_path;
+
+    mutable QMutex m_mutex;
+    std::array<SessionFrame, QUEUE_CAPACITY> m_queue;
+    int m_queueHead = 0;
+    int m_queueCount = 0;
+    bool m_drainScheduled = false;
+    quint64 m_droppedFrames = 0;
+};
+
+#endif // SESSIONLOG_H
@@ -0,0 +1,68 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../tunerengine.h"
+#include "../audio/syntheticsource.h"
+
+// Time to lock per open cello string, with the fixed window and with the
+// pitch-adaptive one. The adaptive window spans a fixed number of periods,
+// so its lock time has to follow the string's period and beat the fixed
+// window everywhere above the C string.
+class AdaptiveWindowTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void lockTimeFollowsPeriod();
+
+private:
+    static constexpr int CHUNK_SIZE = 512;
+    static constexpr int MAX_CHUNKS = 400;  // About four seconds at 48 kHz
+
+    // Milliseconds of audio from the onset of a tone to the tracker's lock, 0 if it never locked
+    static double lockTimeMs(bool adaptive, double frequency);
+};
+
+double AdaptiveWindowTest::lockTimeMs(bool adaptive, double frequency)
+{
+    TunerEngine engine(nullptr, false);
+    engine.setAdaptiveWindow(adaptive);
+    SyntheticSource source;
+    source.setSampleRate(engine.sampleRate());
+    source.setChunkSize(CHUNK_SIZE);
+    source.setFrequency(frequency);
+
+    for (int chunk = 0; chunk < MAX_CHUNKS && engine.lastLockTime() <= 0.0; ++chunk) {
+        source.pump(&engine, 1);
+    }
+    return engine.lastLockTime();
+}
+
+void AdaptiveWindowTest::lockTimeFollowsPeriod()
+{
+    // Highest string first, the period grows down the list
+    static const struct {
+        const char *name;
+        double frequency;
+    } strings[] = {{"A3", 220.00}, {"D3", 146.83}, {"G2", 98.00}, {"C2", 65.41}};
+
+    double previous = 0.0;
+    for (const auto &string : strings) {
+        const double fixed = lockTimeMs(false, string.frequency);
+        const double adaptive = lockTimeMs(true, string.frequency);
+        qInfo().noquote() << QString("%1: time to lock %2 ms fixed window, %3 ms adaptive")
+                             .arg(string.name).arg(fixed, 0, 'f', 1).arg(adaptive, 0, 'f', 1);
+
+        QVERIFY2(fixed > 0.0, string.name);
+        QVERIFY2(adaptive > 0.0, string.name);
+        QVERIFY2(adaptive >= previous, string.name);
+        // Twelve periods of C2 are longer than the default window, every other string is shorter
+        if (string.frequency > 80.0) {
+            QVERIFY2(adaptive < fixed, string.name);
+        }
+        previous = adaptive;
+    }
+}
+
+static AdaptiveWindowTest ADAPTIVE_WINDOW_TEST;
+
+#include "adaptivewindowtest.moc"
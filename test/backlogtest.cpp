@@ -0,0 +1,73 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../tunerengine.h"
+#include "../audio/syntheticsource.h"
+
+#include <QVariantMap>
+#include <cmath>
+
+// Backlog policies after a stall: an offline engine settles on a note, then
+// the audio of a 1.5 s stall arrives as one chunk with the note changing
+// halfway through. Processing everything analyzes every block and drops none;
+// the dropping policies skip the stale blocks and still end on the new note.
+class BacklogTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void stallEndsOnNewestNote();
+
+private:
+    static constexpr int STALL_MS = 1500;
+    static constexpr int SETTLE_CHUNKS = 40;
+    static constexpr double MAX_CENTS = 50.0;
+};
+
+void BacklogTest::stallEndsOnNewestNote()
+{
+    static const double before = 65.41;  // C2
+    static const double after = 98.00;   // G2
+
+    TunerEngine probe(nullptr, false);
+    const QStringList policies = probe.backlogPolicies();
+    QVERIFY(policies.contains("Process all"));
+    for (const QString &policy : policies) {
+        TunerEngine engine(nullptr, false);
+        engine.setBacklogPolicy(policy);
+        QCOMPARE(engine.backlogPolicy(), policy);
+        SyntheticSource source;
+        source.setSampleRate(engine.sampleRate());
+        source.setChunkSize(1024);
+        source.setFrequency(before);
+        source.pump(&engine, SETTLE_CHUNKS);
+        engine.resetBacklogStats();
+
+        double last = 0.0;
+        connect(&engine, &TunerEngine::noteDetected, this, [&last](const QString &, double frequency, double) {
+            last = frequency;
+        });
+
+        // Everything the device delivered during the stall arrives at once
+        const int half = engine.sampleRate() * STALL_MS / 2000;
+        source.setChunkSize(half);
+        QByteArray stalled = source.nextChunk();
+        source.setFrequency(after);
+        stalled += source.nextChunk();
+        engine.ingestAudio(stalled, source.elapsedUSecs());
+
+        QVariantMap stats = engine.backlogStats();
+        QVERIFY2(stats.value("processedBlocks").toLongLong() > 0, qPrintable(policy));
+        QVERIFY2(stats.value("maxBacklogBlocks").toInt() > 1, qPrintable(policy));
+        if (policy == "Process all") {
+            QCOMPARE(stats.value("droppedBlocks").toLongLong(), qint64(0));
+        } else {
+            QVERIFY2(stats.value("droppedBlocks").toLongLong() > 0, qPrintable(policy));
+            QVERIFY2(last > 0.0 && std::abs(1200.0 * std::log2(last / after)) < MAX_CENTS,
+                     qPrintable(QString("%1 ended on %2 Hz").arg(policy).arg(last)));
+        }
+    }
+}
+
+static BacklogTest BACKLOG_TEST;
+
+#include "backlogtest.moc"
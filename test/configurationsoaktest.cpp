@@ -0,0 +1,122 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../tunerengine.h"
+#include "../audio/syntheticsource.h"
+#include "../dsp/fftplan.h"
+#include "../dsp/fixedpoint.h"
+
+#include <QFile>
+#include <QVariantMap>
+#include <unistd.h>
+
+// Hot reconfiguration must not grow memory: the shared plan and window
+// caches keep only the most recently used sizes, and thousands of settings
+// transactions walking through distinct buffer sizes leave resident memory
+// flat after warm-up.
+class ConfigurationSoakTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void planCachesAreBounded();
+    void rssPlateausAcrossSizes();
+
+private:
+    static constexpr int ITERATIONS = 1500;
+    static constexpr int WARMUP_ITERATIONS = 200;
+    static constexpr int SIZE_STRIDE = 389;  // Coprime with ITERATIONS, so no size repeats
+    static constexpr qint64 MAX_GROWTH_BYTES = 8 * 1024 * 1024;
+
+    // Resident set size in bytes, 0 where the platform does not expose it
+    static qint64 residentSetSize();
+};
+
+qint64 ConfigurationSoakTest::residentSetSize()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) return 0;
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) return 0;
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+void ConfigurationSoakTest::planCachesAreBounded()
+{
+    // Sizes nothing else in the suite asks for
+    const int first = 3 * 5 * 7 * 11;
+    std::weak_ptr<const FftPlan> plan = FftPlan::forSize(first);
+    std::weak_ptr<const std::vector<double>> window = HannWindow::forLength(first);
+    std::weak_ptr<const FixedFftPlan> fixedPlan = FixedFftPlan::forSize(1 << 17);
+    std::weak_ptr<const std::vector<int16_t>> fixedWindow = FixedPoint::hannWindow(first);
+
+    // A hit is served from the cache and keeps the entry in front
+    QCOMPARE(FftPlan::forSize(first).get(), plan.lock().get());
+    QCOMPARE(HannWindow::forLength(first).get(), window.lock().get());
+
+    // Nobody holds the first entries, a cache's worth of other sizes evicts them
+    for (int i = 1; i <= FftPlan::CACHED_SIZES; ++i) {
+        FftPlan::forSize(first + i);
+        HannWindow::forLength(first + i);
+        FixedFftPlan::forSize(1 << i);
+        FixedPoint::hannWindow(first + i);
+    }
+    QVERIFY(plan.expired());
+    QVERIFY(window.expired());
+    QVERIFY(fixedPlan.expired());
+    QVERIFY(fixedWindow.expired());
+
+    // An evicted plan lives on while a caller still holds it
+    std::shared_ptr<const FftPlan> held = FftPlan::forSize(first);
+    for (int i = 1; i <= FftPlan::CACHED_SIZES; ++i) FftPlan::forSize(first + i);
+    QCOMPARE(held->size(), first);
+    QVERIFY(FftPlan::forSize(first) != held);
+}
+
+void ConfigurationSoakTest::rssPlateausAcrossSizes()
+{
+    if (residentSetSize() == 0) QSKIP("resident set size is not available on this platform");
+
+    static const int sampleRates[] = {44100, 48000, 22050};
+    static const char *methods[] = {"FFT", "Autocorrelation", "Harmonic sum", "Cepstrum", "Ensemble"};
+    static const char *temperaments[] = {"Equal", "Pythagorean", "Just"};
+
+    TunerEngine engine(nullptr, false);
+    SyntheticSource source;
+    source.setFrequency(65.41);
+    source.setChunkSize(2048);
+
+    qint64 baseline = 0;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        // Every transaction asks for a buffer size, and so FFT and window sizes, not seen
+        // before. Shuffled rather than ascending, so the sizes resident after warm-up
+        // are as large as the ones resident at the end
+        QVariantMap settings;
+        settings["sampleRate"] = sampleRates[i % 3];
+        settings["bufferSize"] = 2048 + 8 * ((i * SIZE_STRIDE) % ITERATIONS);
+        settings["fftPadding"] = 1 + (i / 12) % 4;
+        settings["adaptiveWindow"] = (i / 5) % 2 == 1;
+        settings["detectionMethod"] = methods[(i / 7) % 5];
+        settings["referenceA"] = 440.0 + (i % 5);
+        settings["temperament"] = temperaments[(i / 11) % 3];
+        engine.applySettings(settings);
+
+        source.setSampleRate(engine.sampleRate());
+        source.pump(&engine, 4);
+
+        if (i + 1 == WARMUP_ITERATIONS) {
+            baseline = residentSetSize();
+        }
+    }
+
+    const qint64 growth = residentSetSize() - baseline;
+    qInfo() << ITERATIONS << "reconfigurations, rss growth after warm-up" << growth / 1024 << "KiB";
+    QVERIFY(growth < MAX_GROWTH_BYTES);
+}
+
+static ConfigurationSoakTest CONFIGURATION_SOAK_TEST;
+
+#include "configurationsoaktest.moc"
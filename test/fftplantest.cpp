@@ -0,0 +1,165 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../dsp/fftplan.h"
+#include "../dsp/pitchdetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+// FFT plans of every algorithm against a direct DFT: radix-2, mixed radix
+// 2/3/4/5, Bluestein and the compile-time kernels, including the default
+// 8112-sample buffer padded to 16224, which the old radix-2 recursion got
+// wrong. The kernels are also held to the generic radix-2 plan at every size
+// and the default analysis windows have to land on them.
+class FftPlanTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void algorithmPerSize();
+    void matchesDirectDft();
+    void nextFastSizeIsSmooth();
+    void kernelsMatchGenericPlan();
+    void defaultWindowsUseKernels();
+
+private:
+    static constexpr double MAX_ERROR = 1e-12;         // Relative to the largest output
+    static constexpr double MAX_KERNEL_ERROR = 1e-13;  // Against the generic plan, same rounding order
+    static constexpr int DEFAULT_BUFFER_SIZE = 8112;   // TunerEngine's
+    static constexpr int STROBE_WINDOW = 4096;
+
+    static std::vector<std::complex<double>> randomInput(int size);
+    // Largest difference between plan and direct DFT over the largest output
+    static double relativeError(int size);
+};
+
+std::vector<std::complex<double>> FftPlanTest::randomInput(int size)
+{
+    std::mt19937 rng(size);
+    std::normal_distribution<double> noise;
+    std::vector<std::complex<double>> input(size);
+    for (auto &value : input) value = {noise(rng), noise(rng)};
+    return input;
+}
+
+double FftPlanTest::relativeError(int size)
+{
+    const std::vector<std::complex<double>> input = randomInput(size);
+    std::vector<std::complex<double>> actual = input;
+    FftPlan::forSize(size)->transform(actual.data());
+
+    // Indexed by j * k mod size, which keeps the twiddle angle exact for large sizes
+    std::vector<std::complex<double>> twiddles(size);
+    for (int i = 0; i < size; ++i) twiddles[i] = std::polar(1.0, -2.0 * M_PI * i / size);
+
+    double largest = 0.0;
+    double error = 0.0;
+    for (int k = 0; k < size; ++k) {
+        std::complex<double> expected;
+        for (int j = 0, index = 0; j < size; ++j) {
+            expected += input[j] * twiddles[index];
+            index += k;
+            if (index >= size) index -= size;
+        }
+        largest = std::max(largest, std::abs(expected));
+        error = std::max(error, std::abs(expected - actual[k]));
+    }
+    return error / largest;
+}
+
+void FftPlanTest::algorithmPerSize()
+{
+    QVERIFY(FftPlan::forSize(1024)->algorithm() == FftPlan::Algorithm::Radix2);
+    QVERIFY(FftPlan::forSize(4096)->algorithm() == FftPlan::Algorithm::Specialized);
+    QVERIFY(FftPlan(4096, false).algorithm() == FftPlan::Algorithm::Radix2);
+    QVERIFY(FftPlan::forSize(960)->algorithm() == FftPlan::Algorithm::MixedRadix);
+    QVERIFY(FftPlan::forSize(15360)->algorithm() == FftPlan::Algorithm::MixedRadix);
+    QVERIFY(FftPlan::forSize(1009)->algorithm() == FftPlan::Algorithm::Bluestein);
+    QVERIFY(FftPlan::forSize(16224)->algorithm() == FftPlan::Algorithm::Bluestein);
+}
+
+void FftPlanTest::matchesDirectDft()
+{
+    // Every size up to 256 walks through all three algorithms and odd factor orders
+    for (int size = 1; size <= 256; ++size) {
+        QVERIFY2(relativeError(size) < MAX_ERROR, qPrintable(QString::number(size)));
+    }
+    for (int size : {1000, 1009, 2048, 3375, 4096, 7919, 8192, 15360, 16224}) {
+        const double error = relativeError(size);
+        QVERIFY2(error < MAX_ERROR, qPrintable(QString("%1: %2").arg(size).arg(error)));
+    }
+}
+
+void FftPlanTest::nextFastSizeIsSmooth()
+{
+    QCOMPARE(FftPlan::nextFastSize(1000), 1000);
+    QCOMPARE(FftPlan::nextFastSize(1009), 1024);
+    QCOMPARE(FftPlan::nextFastSize(8112), 8192);
+    QCOMPARE(FftPlan::nextFastSize(16224), 16384);
+    for (int n = 1; n <= 5000; ++n) {
+        const int fast = FftPlan::nextFastSize(n);
+        QVERIFY(fast >= n);
+        QVERIFY(FftPlan::forSize(fast)->algorithm() != FftPlan::Algorithm::Bluestein);
+        for (int smaller = n; smaller < fast; ++smaller) {
+            int rest = smaller;
+            for (int p : {2, 3, 5}) {
+                while (rest % p == 0) rest /= p;
+            }
+            QVERIFY(rest != 1);
+        }
+    }
+}
+
+void FftPlanTest::kernelsMatchGenericPlan()
+{
+    for (int size = FftKernels::SMALLEST; size <= FftKernels::LARGEST; size *= 2) {
+        const FftPlan generic(size, false);
+        const FftPlan specialized(size);
+        QVERIFY(specialized.algorithm() == FftPlan::Algorithm::Specialized);
+
+        const std::vector<std::complex<double>> input = randomInput(size);
+        std::vector<std::complex<double>> expected = input;
+        std::vector<std::complex<double>> actual = input;
+        generic.transform(expected.data());
+        specialized.transform(actual.data());
+        double largest = 0.0;
+        double error = 0.0;
+        for (int i = 0; i < size; ++i) {
+            largest = std::max(largest, std::abs(expected[i]));
+            error = std::max(error, std::abs(expected[i] - actual[i]));
+        }
+        QVERIFY2(error / largest < MAX_KERNEL_ERROR, qPrintable(QString("%1: %2").arg(size).arg(error / largest)));
+    }
+    QVERIFY(!FftKernels::forSize(FftKernels::SMALLEST / 2));
+    QVERIFY(!FftKernels::forSize(FftKernels::LARGEST * 2));
+    QVERIFY(!FftKernels::forSize(15360));
+}
+
+void FftPlanTest::defaultWindowsUseKernels()
+{
+    // The default buffer at 1, 2 (the default), 4 and 8x padding, with every method
+    for (PitchDetector::Method method : {PitchDetector::Method::Fft, PitchDetector::Method::Autocorrelation,
+                                         PitchDetector::Method::HarmonicSum, PitchDetector::Method::Cepstrum,
+                                         PitchDetector::Method::Ensemble}) {
+        for (int padding : {1, 2, 4, 8}) {
+            PitchDetector detector;
+            PitchDetector::Settings settings;
+            settings.fftPadding = padding;
+            settings.method = method;
+            detector.setSettings(settings);
+            const int size = detector.paddedSize(DEFAULT_BUFFER_SIZE);
+            QVERIFY2(FftPlan::forSize(size)->algorithm() == FftPlan::Algorithm::Specialized,
+                     qPrintable(QString("padding %1: %2").arg(padding).arg(size)));
+        }
+    }
+    PitchDetector detector;
+    QCOMPARE(detector.paddedSize(DEFAULT_BUFFER_SIZE), 16384);
+    QVERIFY(FftPlan::forSize(detector.paddedSize(STROBE_WINDOW))->algorithm() == FftPlan::Algorithm::Specialized);
+}
+
+static FftPlanTest FFT_PLAN_TEST;
+
+#include "fftplantest.moc"
@@ -0,0 +1,92 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../dsp/notetable.h"
+#include "../dsp/pitchdetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// The Q15 pipeline against the double one on the same quantized cello-range
+// tones: both have to agree on whether a pitch is present and land within a
+// cent of each other at every padding the integer transform supports.
+class FixedPointTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void matchesDoublePath();
+
+private:
+    static constexpr int SAMPLE_RATE = 48000;
+    static constexpr int WINDOW_SIZE = 8112;
+    static constexpr double MAX_CENTS = 1.0;
+
+    // Four harmonics with a little noise, quantized the way the audio input delivers it
+    static void synthesize(double frequency, double amplitude, std::mt19937 &rng, std::vector<int16_t> &samples);
+};
+
+void FixedPointTest::synthesize(double frequency, double amplitude, std::mt19937 &rng, std::vector<int16_t> &samples)
+{
+    std::normal_distribution<double> noise(0.0, 0.0003);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        double t = static_cast<double>(i) / SAMPLE_RATE;
+        double value = amplitude * (0.6 * std::sin(2 * M_PI * frequency * t)
+                                    + 0.3 * std::sin(2 * M_PI * 2 * frequency * t + 0.5)
+                                    + 0.2 * std::sin(2 * M_PI * 3 * frequency * t + 1.0)
+                                    + 0.1 * std::sin(2 * M_PI * 4 * frequency * t))
+                + noise(rng);
+        samples[i] = static_cast<int16_t>(std::clamp(std::lround(value * 32767), -32768L, 32767L));
+    }
+}
+
+void FixedPointTest::matchesDoublePath()
+{
+    NoteTable noteTable;
+    noteTable.build(440.0, Temperament::Equal, 9, {});
+    std::mt19937 rng(1);
+    std::vector<int16_t> quantized(WINDOW_SIZE);
+    std::vector<double> samples(WINDOW_SIZE);
+
+    for (int padding : {1, 2, 4}) {
+        PitchDetector::Settings settings;
+        settings.sampleRate = SAMPLE_RATE;
+        settings.fftPadding = padding;
+        // The Q15 transform is radix-2 only, give the double path the same size
+        settings.powerOfTwoPadding = true;
+        // Parity of the two pipelines, the integer one has no partial fit
+        settings.partialFit = false;
+
+        PitchDetector floating;
+        PitchDetector fixed;
+        floating.setSettings(settings);
+        fixed.setSettings(settings);
+        floating.setNoteTable(&noteTable);
+        fixed.setNoteTable(&noteTable);
+
+        int compared = 0;
+        for (double frequency = 60.0; frequency < 1000.0; frequency *= 1.0731) {
+            for (double amplitude : {0.5, 0.05, 0.005}) {
+                synthesize(frequency, amplitude, rng, quantized);
+                for (int i = 0; i < WINDOW_SIZE; ++i) samples[i] = quantized[i] / 32768.0;
+
+                const PitchDetector::Result reference = floating.analyze(samples.data(), WINDOW_SIZE);
+                const PitchDetector::Result result = fixed.analyze(quantized.data(), WINDOW_SIZE);
+                const QString where = QString("padding %1, %2 Hz at %3").arg(padding)
+                                      .arg(frequency, 0, 'f', 1).arg(amplitude);
+                QVERIFY2((reference.frequency > 0) == (result.frequency > 0), qPrintable(where));
+                if (reference.frequency <= 0) continue;
+
+                const double cents = std::abs(1200.0 * std::log2(result.frequency / reference.frequency));
+                QVERIFY2(cents <= MAX_CENTS, qPrintable(QString("%1: %2 cents").arg(where).arg(cents)));
+                ++compared;
+            }
+        }
+        QVERIFY(compared > 0);
+    }
+}
+
+static FixedPointTest FIXED_POINT_TEST;
+
+#include "fixedpointtest.moc"
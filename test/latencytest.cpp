@@ -0,0 +1,76 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../tunerengine.h"
+#include "../audio/syntheticsource.h"
+#include "../tools/latencyHistogram.h"
+
+#include <cmath>
+
+// Pitch step latency: a synthetic source paced like a real device feeds an
+// offline engine, the tone jumps between open cello strings and each jump
+// has to reach noteDetected for the new pitch within a few analysis windows.
+class LatencyTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void pitchStepReachesNoteDetected();
+
+private:
+    static constexpr int STEPS = 12;
+    static constexpr int SETTLE_MS = 1000;
+    static constexpr double STEP_CENTS = 50.0;
+    // The step lands inside one window and the tracker moves once the next two agree
+    static constexpr int MAX_WINDOWS = 4;
+};
+
+void LatencyTest::pitchStepReachesNoteDetected()
+{
+    static const double strings[] = {65.41, 98.00, 146.83, 220.00};
+
+    TunerEngine engine(nullptr, false);
+    SyntheticSource source;
+    source.setSampleRate(engine.sampleRate());
+    source.setChunkSize(512);
+    source.setFrequency(strings[0]);
+
+    const qint64 windowUSecs = static_cast<qint64>(engine.bufferSize()) * 1000000 / engine.sampleRate();
+    const int boundMs = static_cast<int>(MAX_WINDOWS * windowUSecs / 1000);
+
+    double target = 0.0;
+    qint64 stepUSecs = -1;
+    LatencyHistogram stepLatency;
+    connect(&engine, &TunerEngine::noteDetected, this, [&](const QString &, double frequency, double) {
+        if (stepUSecs < 0 || std::abs(1200.0 * std::log2(frequency / target)) > STEP_CENTS) return;
+        stepLatency.add(engine.monotonicUSecs() - stepUSecs);
+        stepUSecs = -1;
+    });
+
+    // Paced by a timer, so device-sized chunks arrive in real time
+    source.start(&engine);
+    QTest::qWait(SETTLE_MS);
+    engine.resetLatencyStats();
+
+    for (int step = 1; step <= STEPS; ++step) {
+        target = strings[step % 4];
+        source.setFrequency(target);
+        stepUSecs = engine.monotonicUSecs();
+        QTRY_VERIFY_WITH_TIMEOUT(stepUSecs < 0, boundMs);
+        QTest::qWait(SETTLE_MS);
+    }
+    source.stop();
+
+    qInfo().noquote() << "pitch step -> noteDetected:" << stepLatency.summary();
+    QCOMPARE(stepLatency.count(), qint64(STEPS));
+    QVERIFY(stepLatency.maxUSecs() <= MAX_WINDOWS * windowUSecs);
+
+    // The engine's own stage histograms saw the same windows
+    const QVariantMap stats = engine.latencyStats();
+    for (const char *stage : {"capture", "analysis", "properties"}) {
+        QVERIFY2(stats.value(stage).toMap().value("count").toLongLong() > 0, stage);
+    }
+}
+
+static LatencyTest LATENCY_TEST;
+
+#include "latencytest.moc"
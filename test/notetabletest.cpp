@@ -0,0 +1,112 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../dsp/notetable.h"
+
+#include <cmath>
+
+// Note tables against the closed forms: equal temperament from the
+// reference, pure fifths and 5-limit thirds above the root, custom offsets,
+// and lookups that switch notes exactly at the geometric midpoints.
+class NoteTableTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void equalTemperament();
+    void pythagoreanFifths();
+    void justIntonation();
+    void customOffsets();
+    void nearestSwitchesAtMidpoints();
+
+private:
+    static constexpr double RATIO_TOLERANCE = 1e-12;
+    static constexpr double CENTS_TOLERANCE = 1e-6;
+
+    static double equalTempered(int note, double referenceA) { return referenceA * std::exp2((note - 69) / 12.0); }
+};
+
+void NoteTableTest::equalTemperament()
+{
+    NoteTable table;
+    for (double referenceA : {440.0, 442.0, 415.0}) {
+        table.build(referenceA, Temperament::Equal, 9, {});
+        for (int note = NoteTable::FIRST_NOTE; note < NoteTable::FIRST_NOTE + NoteTable::NOTE_COUNT; ++note) {
+            QVERIFY(std::abs(table.centerFrequency(note) / equalTempered(note, referenceA) - 1.0) < RATIO_TOLERANCE);
+        }
+
+        // Every frequency from C1 to C8 maps to the rounded note, cents without log2 match log2
+        for (double frequency = 32.7; frequency < 4186.0; frequency *= 1.0013) {
+            const double exact = 69.0 + 12.0 * std::log2(frequency / referenceA);
+            const NoteTable::Match match = table.nearest(frequency);
+            QCOMPARE(match.note, static_cast<int>(std::lround(exact)));
+            QVERIFY(std::abs(match.cents - 100.0 * (exact - match.note)) < CENTS_TOLERANCE);
+        }
+    }
+}
+
+void NoteTableTest::pythagoreanFifths()
+{
+    // Rooted on C, the cello's strings C G D A are a chain of pure fifths
+    NoteTable table;
+    table.build(440.0, Temperament::Pythagorean, 0, {});
+    const int strings[] = {36, 43, 50, 57};
+    for (int i = 0; i + 1 < 4; ++i) {
+        QVERIFY(std::abs(table.centerFrequency(strings[i + 1]) / table.centerFrequency(strings[i]) - 1.5)
+                < RATIO_TOLERANCE);
+    }
+    // The root keeps its equal-tempered pitch
+    QVERIFY(std::abs(table.centerFrequency(48) / equalTempered(48, 440.0) - 1.0) < RATIO_TOLERANCE);
+    // The fifth above the root sits 1.96 cents above its equal-tempered pitch
+    QVERIFY(std::abs(table.offsets()[7] - 1200.0 * std::log2(1.5) + 700.0) < CENTS_TOLERANCE);
+}
+
+void NoteTableTest::justIntonation()
+{
+    // Against a D drone: fifth 3/2, major third 5/4, major sixth 5/3, fourth 4/3
+    NoteTable table;
+    table.build(440.0, Temperament::Just, 2, {});
+    const int drone = 50;  // D3
+    const struct {
+        int interval;
+        double ratio;
+    } intervals[] = {{7, 3.0 / 2.0}, {4, 5.0 / 4.0}, {9, 5.0 / 3.0}, {5, 4.0 / 3.0}, {12, 2.0}};
+    for (const auto &interval : intervals) {
+        QVERIFY(std::abs(table.centerFrequency(drone + interval.interval) / table.centerFrequency(drone) - interval.ratio)
+                < RATIO_TOLERANCE);
+    }
+    QVERIFY(std::abs(table.centerFrequency(drone) / equalTempered(drone, 440.0) - 1.0) < RATIO_TOLERANCE);
+}
+
+void NoteTableTest::customOffsets()
+{
+    std::array<double, 12> cents{};
+    for (int pitchClass = 0; pitchClass < 12; ++pitchClass) cents[pitchClass] = 3.0 * pitchClass - 15.0;
+
+    NoteTable table;
+    table.build(440.0, Temperament::Custom, 0, cents);
+    for (int note = 36; note < 84; ++note) {
+        const double expected = equalTempered(note, 440.0) * std::exp2(cents[note % 12] / 1200.0);
+        QVERIFY(std::abs(table.centerFrequency(note) / expected - 1.0) < RATIO_TOLERANCE);
+        // A tone on the shifted centre reads as in tune
+        const NoteTable::Match match = table.nearest(expected);
+        QCOMPARE(match.note, note);
+        QVERIFY(std::abs(match.cents) < CENTS_TOLERANCE);
+    }
+}
+
+void NoteTableTest::nearestSwitchesAtMidpoints()
+{
+    NoteTable table;
+    for (Temperament temperament : {Temperament::Equal, Temperament::Pythagorean, Temperament::Just}) {
+        table.build(440.0, temperament, 0, {});
+        for (int note = NoteTable::FIRST_NOTE; note + 1 < NoteTable::FIRST_NOTE + NoteTable::NOTE_COUNT; ++note) {
+            const double midpoint = std::sqrt(table.centerFrequency(note) * table.centerFrequency(note + 1));
+            QCOMPARE(table.nearest(midpoint * (1.0 - 1e-9)).note, note);
+            QCOMPARE(table.nearest(midpoint * (1.0 + 1e-9)).note, note + 1);
+        }
+    }
+}
+
+static NoteTableTest NOTE_TABLE_TEST;
+
+#include "notetabletest.moc"
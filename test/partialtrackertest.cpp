@@ -0,0 +1,207 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../dsp/notetable.h"
+#include "../dsp/pitchdetector.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Partial fit on synthetic stiff strings of known inharmonicity, one with
+// vibrato and one whose fundamental beats like a wolf tone: the fit recovers
+// B, is at least as accurate as the single strongest peak, and flags the wolf
+// tone there and only there. Clean tones of only a few harmonics, like the
+// synthetic source and the reference tone timbres, leave most partial slots
+// empty: the fit still lands on the pitch under every method, and no slot
+// takes a peak that belongs to a lower one.
+class PartialTrackerTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void fitsStiffStrings();
+    void fitsCleanHarmonicTones();
+
+private:
+    static constexpr int SAMPLE_RATE = 48000;
+    static constexpr int WINDOW_SIZE = 8112;
+    static constexpr int FRAMES = 30;
+    static constexpr int SETTLE_FRAMES = 5;
+    static constexpr int HARMONICS = 16;
+    static constexpr double B_TOLERANCE = 0.2;          // Relative
+    static constexpr double HARMONIC_B_TOLERANCE = 2e-5;  // Absolute, for harmonic tones
+    static constexpr double WOLF_SHARE = 0.5;
+    static constexpr double MAX_CLEAN_CENTS = 2.0;
+
+    struct StringTone {
+        const char *name;
+        double frequency;
+        double inharmonicity;
+        double vibratoCents;  // 5.5 Hz
+        bool wolf;            // Fundamental beating at 3 Hz in level and pitch
+    };
+
+    struct Outcome {
+        double rmsCents = 0.0;
+        double inharmonicity = 0.0;
+        int wolfFrames = 0;
+        int frames = 0;
+    };
+
+    static Outcome analyzeTone(const StringTone &tone, bool partialFit);
+};
+
+PartialTrackerTest::Outcome PartialTrackerTest::analyzeTone(const StringTone &tone, bool partialFit)
+{
+    NoteTable noteTable;
+    noteTable.build(440.0, Temperament::Equal, 9, {});
+    PitchDetector::Settings settings;
+    settings.sampleRate = SAMPLE_RATE;
+    settings.partialFit = partialFit;
+    PitchDetector detector;
+    detector.setSettings(settings);
+    detector.setNoteTable(&noteTable);
+
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 0.01);
+    std::vector<double> samples(WINDOW_SIZE);
+    std::vector<double> phases(HARMONICS + 1, 0.0);
+    Outcome outcome;
+    double squaredCents = 0.0;
+    long long clock = 0;
+
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        const double frameTime = static_cast<double>(clock) / SAMPLE_RATE;
+        const double fundamental = tone.frequency *
+                std::exp2(tone.vibratoCents * std::sin(2 * M_PI * 5.5 * frameTime) / 1200.0);
+        for (int i = 0; i < WINDOW_SIZE; ++i, ++clock) {
+            const double t = static_cast<double>(clock) / SAMPLE_RATE;
+            double value = 0.0;
+            for (int n = 1; n <= HARMONICS; ++n) {
+                double frequency = n * fundamental * std::sqrt(1.0 + tone.inharmonicity * n * n);
+                double amplitude = 1.0 / n;
+                if (tone.wolf && n == 1) {
+                    amplitude *= 1.0 + 0.8 * std::sin(2 * M_PI * 3.0 * t);
+                    frequency *= std::exp2(10.0 * std::sin(2 * M_PI * 3.0 * t + 1.0) / 1200.0);
+                }
+                phases[n] += 2 * M_PI * frequency / SAMPLE_RATE;
+                value += amplitude * std::sin(phases[n]);
+            }
+            samples[i] = 0.2 * value + noise(rng);
+        }
+
+        PitchDetector::Result result = detector.analyze(samples.data(), WINDOW_SIZE);
+        if (frame < SETTLE_FRAMES) continue;
+        const double cents = result.frequency > 0 ? 1200.0 * std::log2(result.frequency / fundamental) : 100.0;
+        squaredCents += cents * cents;
+        outcome.wolfFrames += result.wolfTone ? 1 : 0;
+        outcome.inharmonicity = result.inharmonicity;
+        ++outcome.frames;
+    }
+    outcome.rmsCents = std::sqrt(squaredCents / outcome.frames);
+    return outcome;
+}
+
+void PartialTrackerTest::fitsStiffStrings()
+{
+    static const StringTone tones[] = {
+        {"E2 guitar", 82.41, 1.5e-4, 0.0, false},
+        {"A2 piano", 110.0, 4.0e-4, 0.0, false},
+        {"C2 cello", 65.41, 2.0e-5, 0.0, false},
+        {"A3 harmonic", 220.0, 0.0, 0.0, false},
+        {"D3 vibrato", 146.83, 5.0e-5, 15.0, false},
+        {"F#3 wolf", 185.0, 5.0e-5, 0.0, true}
+    };
+
+    for (const StringTone &tone : tones) {
+        const Outcome single = analyzeTone(tone, false);
+        const Outcome fitted = analyzeTone(tone, true);
+
+        const double bError = std::abs(fitted.inharmonicity - tone.inharmonicity);
+        const double bTolerance = tone.inharmonicity > 0 ? B_TOLERANCE * tone.inharmonicity : HARMONIC_B_TOLERANCE;
+        QVERIFY2(bError <= bTolerance,
+                 qPrintable(QString("%1: B %2").arg(tone.name).arg(fitted.inharmonicity, 0, 'e', 2)));
+        QVERIFY2(fitted.rmsCents <= single.rmsCents,
+                 qPrintable(QString("%1: %2 cents fitted, %3 single peak").arg(tone.name)
+                            .arg(fitted.rmsCents, 0, 'f', 3).arg(single.rmsCents, 0, 'f', 3)));
+        if (tone.wolf) {
+            QVERIFY2(fitted.wolfFrames >= WOLF_SHARE * fitted.frames, tone.name);
+        } else {
+            QVERIFY2(fitted.wolfFrames == 0, tone.name);
+        }
+    }
+}
+
+void PartialTrackerTest::fitsCleanHarmonicTones()
+{
+    static const double notes[] = {65.41, 98.00, 146.83, 220.00, 440.00};  // C2 G2 D3 A3 A4
+    // SyntheticSource's default and the WavetableOscillator timbres, cut to their first partials
+    static const std::vector<double> timbres[] = {
+        {1.0, 0.5, 0.33, 0.25},
+        {1.0, 0.8, 0.55, 0.45, 0.35},
+        {1.0, 0.7, 0.0, 0.5, 0.0, 0.0, 0.0, 0.35}
+    };
+    static const PitchDetector::Method methods[] = {
+        PitchDetector::Method::Fft, PitchDetector::Method::Autocorrelation, PitchDetector::Method::HarmonicSum,
+        PitchDetector::Method::Cepstrum, PitchDetector::Method::Ensemble
+    };
+
+    NoteTable noteTable;
+    noteTable.build(440.0, Temperament::Equal, 9, {});
+    std::vector<double> samples(WINDOW_SIZE);
+    for (const PitchDetector::Method method : methods) {
+        PitchDetector::Settings settings;
+        settings.sampleRate = SAMPLE_RATE;
+        settings.method = method;
+        settings.partialFit = true;
+        for (const std::vector<double> &timbre : timbres) {
+            for (const double note : notes) {
+                PitchDetector detector;
+                detector.setSettings(settings);
+                detector.setNoteTable(&noteTable);
+                const QString name = QString("%1 Hz, %2 partials, method %3").arg(note).arg(timbre.size())
+                        .arg(static_cast<int>(method));
+
+                long long clock = 0;
+                for (int frame = 0; frame < FRAMES; ++frame) {
+                    for (int i = 0; i < WINDOW_SIZE; ++i, ++clock) {
+                        const double t = static_cast<double>(clock) / SAMPLE_RATE;
+                        double value = 0.0;
+                        for (int n = 1; n <= static_cast<int>(timbre.size()); ++n) {
+                            value += timbre[n - 1] * std::sin(2 * M_PI * n * note * t);
+                        }
+                        samples[i] = 0.2 * value;
+                    }
+
+                    PitchDetector::Result result = detector.analyze(samples.data(), WINDOW_SIZE);
+                    const PartialTracker &tracker = detector.partialTracker();
+
+                    // Each slot holds a peak above the one below it, never the same or a lower one
+                    double below = 0.0;
+                    for (int n = 1; n <= PartialTracker::MAX_PARTIALS; ++n) {
+                        const PartialTracker::Partial &partial = tracker.partials()[n - 1];
+                        if (!partial.active) continue;
+                        QVERIFY2(partial.frequency > below + 0.5 * detector.binWidth(),
+                                 qPrintable(QString("%1: partial %2 at %3 Hz, a lower one at %4 Hz")
+                                            .arg(name).arg(n).arg(partial.frequency).arg(below)));
+                        below = partial.frequency;
+                    }
+
+                    if (frame < SETTLE_FRAMES) continue;
+                    const double fitted = tracker.fit().frequency;
+                    const double fitCents = fitted > 0 ? 1200.0 * std::log2(fitted / note) : 100.0;
+                    const double cents = result.frequency > 0 ? 1200.0 * std::log2(result.frequency / note) : 100.0;
+                    QVERIFY2(std::abs(fitCents) <= MAX_CLEAN_CENTS,
+                             qPrintable(QString("%1: frame %2 fitted %3 Hz").arg(name).arg(frame).arg(fitted)));
+                    QVERIFY2(std::abs(cents) <= MAX_CLEAN_CENTS,
+                             qPrintable(QString("%1: frame %2 detected %3 Hz").arg(name).arg(frame)
+                                        .arg(result.frequency)));
+                }
+            }
+        }
+    }
+}
+
+static PartialTrackerTest PARTIAL_TRACKER_TEST;
+
+#include "partialtrackertest.moc"
@@ -0,0 +1,126 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../dsp/peakpicker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+// Top-K peak picking on synthetic spectra made of Gaussian lobes over a flat
+// floor: the K strongest maxima survive in bin order, the log-power parabola
+// lands exactly on each lobe, and peaks under the prominence floor or in the
+// sidelobe range of a much stronger one are dropped.
+class PeakPickerTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void keepsStrongestK();
+    void interpolatesGaussianLobes();
+    void rejectsFloorAndSidelobes();
+
+private:
+    static constexpr int BINS = 4096;
+    static constexpr double FLOOR = 1e-3;
+    static constexpr double LOBE_WIDTH = 0.8;  // Standard deviation of a lobe's power, in bins
+
+    struct Lobe {
+        double bin;
+        double magnitude;
+    };
+
+    // Flat floor with each bin raised to the strongest lobe covering it
+    static std::vector<std::complex<double>> spectrum(const std::vector<Lobe> &lobes);
+};
+
+std::vector<std::complex<double>> PeakPickerTest::spectrum(const std::vector<Lobe> &lobes)
+{
+    std::vector<std::complex<double>> bins(BINS, FLOOR);
+    for (const Lobe &lobe : lobes) {
+        for (int i = std::max(0, int(lobe.bin) - 12); i < std::min(BINS, int(lobe.bin) + 13); ++i) {
+            const double distance = (i - lobe.bin) / LOBE_WIDTH;
+            const double magnitude = lobe.magnitude * std::exp(-0.25 * distance * distance);
+            // Arbitrary phase, only power matters
+            if (magnitude > std::abs(bins[i])) bins[i] = std::polar(magnitude, 0.7 * i);
+        }
+    }
+    return bins;
+}
+
+void PeakPickerTest::keepsStrongestK()
+{
+    std::mt19937 rng(34);
+    std::uniform_real_distribution<double> magnitude(1.0, 100.0);
+    // Centred on bins, so the strongest bins are the strongest lobes
+    std::vector<Lobe> lobes;
+    for (double bin = 40.0; bin < BINS - 40; bin += 40.0) lobes.push_back({bin, magnitude(rng)});
+    const std::vector<std::complex<double>> bins = spectrum(lobes);
+
+    PeakPicker picker;
+    for (int k : {1, 5, 12, PeakPicker::MAX_PEAKS}) {
+        picker.setMaxPeaks(k);
+        QCOMPARE(picker.pick(bins.data(), 1, BINS - 2), k);
+
+        std::vector<Lobe> strongest = lobes;
+        std::sort(strongest.begin(), strongest.end(), [](const Lobe &a, const Lobe &b) { return a.magnitude > b.magnitude; });
+        strongest.resize(k);
+        std::sort(strongest.begin(), strongest.end(), [](const Lobe &a, const Lobe &b) { return a.bin < b.bin; });
+        for (int i = 0; i < k; ++i) {
+            QVERIFY(std::abs(picker.peaks()[i].bin - strongest[i].bin) < 1e-9);
+        }
+    }
+
+    // Asking for more than fit is clamped
+    picker.setMaxPeaks(1000);
+    QCOMPARE(picker.maxPeaks(), int(PeakPicker::MAX_PEAKS));
+}
+
+void PeakPickerTest::interpolatesGaussianLobes()
+{
+    PeakPicker picker;
+    for (double fraction = -0.5; fraction <= 0.5; fraction += 0.125) {
+        const Lobe lobe{1000.0 + fraction, 20.0};
+        const std::vector<std::complex<double>> bins = spectrum({lobe});
+        QCOMPARE(picker.pick(bins.data(), 900, 1100), 1);
+        QVERIFY(std::abs(picker.peaks()[0].bin - lobe.bin) < 1e-9);
+        QVERIFY(std::abs(picker.peaks()[0].magnitude / lobe.magnitude - 1.0) < 1e-9);
+    }
+}
+
+void PeakPickerTest::rejectsFloorAndSidelobes()
+{
+    const double weak = 100.0 * std::pow(10.0, -(PeakPicker::SIDELOBE_DB + 5.0) / 20.0);
+    const std::vector<Lobe> lobes = {
+        {500.0, FLOOR * std::pow(10.0, 15.0 / 20.0)},  // Under the default 20 dB prominence
+        {700.0, FLOOR * std::pow(10.0, 30.0 / 20.0)},
+        {1000.0, 100.0},
+        {1004.0, weak},                                // Sidelobe range of the lobe at 1000
+        {1040.0, weak},                                // Far enough to be a partial of its own
+    };
+    const std::vector<std::complex<double>> bins = spectrum(lobes);
+
+    PeakPicker picker;
+    picker.setMaxPeaks(10);
+    QCOMPARE(picker.pick(bins.data(), 1, BINS - 2), 3);
+    QVERIFY(std::abs(picker.peaks()[0].bin - 700.0) < 1e-9);
+    QVERIFY(std::abs(picker.peaks()[1].bin - 1000.0) < 1e-9);
+    QVERIFY(std::abs(picker.peaks()[2].bin - 1040.0) < 1e-9);
+    QVERIFY(std::abs(picker.noiseFloorDb() - 20.0 * std::log10(FLOOR)) < 1.0);
+
+    // At 8x padding 40 bins are five window bins, inside the sidelobe reach
+    picker.setPadding(8.0);
+    QCOMPARE(picker.pick(bins.data(), 1, BINS - 2), 2);
+    QVERIFY(std::abs(picker.peaks()[1].bin - 1000.0) < 1e-9);
+
+    // A lower prominence lets the 15 dB peak through
+    picker.setPadding(1.0);
+    picker.setProminence(10.0);
+    QCOMPARE(picker.pick(bins.data(), 1, BINS - 2), 4);
+    QVERIFY(std::abs(picker.peaks()[0].bin - 500.0) < 1e-9);
+}
+
+static PeakPickerTest PEAK_PICKER_TEST;
+
+#include "peakpickertest.moc"
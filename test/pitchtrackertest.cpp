@@ -0,0 +1,118 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../dsp/pitchtracker.h"
+
+#include <cmath>
+
+// Step response of the Kalman pitch tracker: an estimate from the first
+// frame, lock on the second, a jump to another note followed within two
+// frames while single-frame octave slips are ignored, and vibrato tracked at
+// its centre.
+class PitchTrackerTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void firstFrameAndLock();
+    void stepToNewNote();
+    void octaveSlipIgnored();
+    void vibratoTracksCentre();
+    void missesAndSkipsAge();
+
+private:
+    static constexpr double CONFIDENCE = 0.8;
+    // 2048 samples at 48 kHz, a short adaptive window
+    static constexpr double FRAME_SECONDS = 2048.0 / 48000.0;
+
+    static double cents(double frequency, double reference) { return 1200.0 * std::log2(frequency / reference); }
+};
+
+void PitchTrackerTest::firstFrameAndLock()
+{
+    PitchTracker tracker;
+    PitchTracker::Estimate estimate = tracker.update(220.0, CONFIDENCE);
+    QVERIFY(std::abs(cents(estimate.frequency, 220.0)) < 1e-9);
+    QVERIFY(estimate.confidence > 0.0);
+    QVERIFY(!estimate.locked);
+
+    // The stability rule this replaced needed a third agreeing frame
+    estimate = tracker.update(220.0, CONFIDENCE);
+    QVERIFY(estimate.locked);
+    QVERIFY(std::abs(cents(estimate.frequency, 220.0)) < 1e-9);
+}
+
+void PitchTrackerTest::stepToNewNote()
+{
+    PitchTracker tracker;
+    for (int frame = 0; frame < 10; ++frame) tracker.update(220.0, CONFIDENCE);
+
+    // One frame of the new note is an outlier, the second agreeing one moves the tracker
+    const double target = 246.94;
+    PitchTracker::Estimate estimate = tracker.update(target, CONFIDENCE);
+    QVERIFY(std::abs(cents(estimate.frequency, 220.0)) < 1e-9);
+    estimate = tracker.update(target, CONFIDENCE);
+    QVERIFY(std::abs(cents(estimate.frequency, target)) < 1e-9);
+    QVERIFY(!estimate.locked);
+    estimate = tracker.update(target, CONFIDENCE);
+    QVERIFY(estimate.locked);
+}
+
+void PitchTrackerTest::octaveSlipIgnored()
+{
+    PitchTracker tracker;
+    for (int frame = 0; frame < 10; ++frame) tracker.update(65.41, CONFIDENCE);
+
+    PitchTracker::Estimate estimate = tracker.update(130.82, CONFIDENCE);
+    QVERIFY(std::abs(cents(estimate.frequency, 65.41)) < 1e-9);
+    QVERIFY(estimate.locked);
+    estimate = tracker.update(65.41, CONFIDENCE);
+    QVERIFY(std::abs(cents(estimate.frequency, 65.41)) < 1e-9);
+
+    // Alternating slips never agree with each other either
+    for (int frame = 0; frame < 10; ++frame) {
+        estimate = tracker.update(frame % 2 ? 130.82 : 32.70, CONFIDENCE);
+        QVERIFY(std::abs(cents(estimate.frequency, 65.41)) < 1e-9);
+    }
+}
+
+void PitchTrackerTest::vibratoTracksCentre()
+{
+    // +-35 cents at 5.5 Hz, far wider than the old 15 cent stability window.
+    // Each detection is the mean pitch over its window
+    const double centre = 146.83;
+    const double depth = 35.0;
+    PitchTracker tracker;
+    double worst = 0.0;
+    for (int frame = 0; frame < 200; ++frame) {
+        const double start = 2 * M_PI * 5.5 * frame * FRAME_SECONDS;
+        const double end = 2 * M_PI * 5.5 * (frame + 1) * FRAME_SECONDS;
+        const double vibrato = depth * (std::cos(start) - std::cos(end)) / (end - start);
+        const PitchTracker::Estimate estimate = tracker.update(centre * std::exp2(vibrato / 1200.0), CONFIDENCE);
+        if (frame < 5) continue;
+        QVERIFY(estimate.locked);
+        worst = std::max(worst, std::abs(cents(estimate.frequency, centre)));
+    }
+    qInfo() << "vibrato +-35 cents, worst distance from the centre" << worst << "cents";
+    QVERIFY(worst < depth / 3);
+}
+
+void PitchTrackerTest::missesAndSkipsAge()
+{
+    PitchTracker tracker;
+    for (int frame = 0; frame < 10; ++frame) tracker.update(98.0, CONFIDENCE);
+    QVERIFY(tracker.current().locked);
+
+    // Dropped frames widen the estimate until it no longer counts as locked
+    tracker.skip(20);
+    QVERIFY(!tracker.current().locked);
+    QVERIFY(std::abs(cents(tracker.current().frequency, 98.0)) < 1e-9);
+
+    // A few misses keep the estimate, more end the note
+    for (int miss = 0; miss < 4; ++miss) QVERIFY(tracker.miss().frequency > 0.0);
+    QCOMPARE(tracker.miss().frequency, 0.0);
+    QCOMPARE(tracker.current().frequency, 0.0);
+}
+
+static PitchTrackerTest PITCH_TRACKER_TEST;
+
+#include "pitchtrackertest.moc"
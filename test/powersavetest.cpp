@@ -0,0 +1,69 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../tunerengine.h"
+#include "../audio/syntheticsource.h"
+
+#include <QVariantMap>
+
+// Power save: an offline engine fed a tone, then silence past the idle delay,
+// then the tone again has to go idle, stay idle to the end of the silence and
+// wake on the first block of the tone, spending less CPU per second of audio
+// while idle than while analyzing.
+class PowerSaveTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void idlesOnSilenceAndWakesOnTone();
+
+private:
+    static constexpr int TONE_SECONDS = 5;
+    static constexpr int SILENCE_SECONDS = 30;
+    static constexpr int CHUNK_SIZE = 1024;
+};
+
+void PowerSaveTest::idlesOnSilenceAndWakesOnTone()
+{
+    TunerEngine engine(nullptr, false);
+    SyntheticSource source;
+    source.setFrequency(65.41);
+    source.setSampleRate(engine.sampleRate());
+    source.setChunkSize(CHUNK_SIZE);
+    QVERIFY(SILENCE_SECONDS > engine.idleDelay());
+
+    const int chunksPerSecond = engine.sampleRate() / CHUNK_SIZE;
+    bool wentIdle = false;
+    connect(&engine, &TunerEngine::idleChanged, this, [&engine, &wentIdle]() {
+        if (engine.idle()) wentIdle = true;
+    });
+
+    // Warm plans and tables outside the measurement
+    source.pump(&engine, chunksPerSecond);
+    engine.resetPowerStats();
+
+    source.pump(&engine, TONE_SECONDS * chunksPerSecond);
+    QVERIFY(!engine.idle());
+    const double amplitude = source.amplitude();
+    source.setAmplitude(0.0);
+    source.pump(&engine, SILENCE_SECONDS * chunksPerSecond);
+    QVERIFY(wentIdle);
+    QVERIFY(engine.idle());
+    source.setAmplitude(amplitude);
+    source.pump(&engine, 1);
+    QVERIFY(!engine.idle());
+
+    QVariantMap stats = engine.powerStats();
+    qInfo().noquote() << QString("active %1 ms, idle %2 ms CPU per second of audio")
+                         .arg(stats["activeCpuMsPerSecond"].toDouble(), 0, 'f', 2)
+                         .arg(stats["idleCpuMsPerSecond"].toDouble(), 0, 'f', 2);
+    QVERIFY(stats["activeSeconds"].toDouble() > 0.0);
+    QVERIFY(stats["idleSeconds"].toDouble() > 0.0);
+    // Thread CPU time is only measured on Linux, elsewhere both read 0
+    if (stats["activeCpuMsPerSecond"].toDouble() > 0.0) {
+        QVERIFY(stats["idleCpuMsPerSecond"].toDouble() < stats["activeCpuMsPerSecond"].toDouble());
+    }
+}
+
+static PowerSaveTest POWER_SAVE_TEST;
+
+#include "powersavetest.moc"
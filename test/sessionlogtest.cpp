@@ -0,0 +1,135 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../session/sessionlog.h"
+
+#include <QTemporaryDir>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Session log intonation queries against a scan of every frame: a synthetic
+// practice session with note changes, pauses and slow drift is recorded, then
+// the whole session and random sub-ranges must sum to the same per-note
+// totals, live and from the reopened file.
+class SessionLogTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void queriesMatchFrameScan();
+
+private:
+    static constexpr int MINUTES = 20;
+    static constexpr qint64 HOP_USECS = 42667;  // 2048 samples at 48 kHz
+    static constexpr int FRAMES_PER_NOTE = 500;
+    static constexpr double DRIFT_CENTS_PER_MINUTE = 0.5;
+    static constexpr int QUERIES = 20;
+    static constexpr double MAX_ERROR = 1e-6;
+
+    struct NoteTotals {
+        int frames = 0;
+        double seconds = 0.0;
+        double inTuneSeconds = 0.0;
+        double sumCents = 0.0;
+    };
+    using Totals = std::array<NoteTotals, SessionLogFormat::NOTE_COUNT>;
+
+    // What the summaries must add up to, from every frame in [from, to)
+    static Totals scan(const std::vector<SessionFrame> &frames, qint64 fromUSecs, qint64 toUSecs);
+    // Largest difference between the query result and the scan, 1 for a missing or extra note
+    static double error(const std::vector<NoteIntonation> &notes, const Totals &expected);
+};
+
+SessionLogTest::Totals SessionLogTest::scan(const std::vector<SessionFrame> &frames, qint64 fromUSecs, qint64 toUSecs)
+{
+    Totals totals{};
+    qint64 previous = -1;
+    for (const SessionFrame &frame : frames) {
+        if (frame.timestampUSecs >= fromUSecs && frame.timestampUSecs < toUSecs) {
+            NoteTotals &note = totals[frame.midiNote];
+            double duration = previous < 0 ? 0.0 :
+                    std::min(frame.timestampUSecs - previous, SessionLogFormat::MAX_FRAME_GAP_USECS) / 1e6;
+            ++note.frames;
+            note.seconds += duration;
+            if (std::abs(frame.cents) <= SessionLogFormat::IN_TUNE_CENTS) note.inTuneSeconds += duration;
+            note.sumCents += frame.cents;
+        }
+        previous = frame.timestampUSecs;
+    }
+    return totals;
+}
+
+double SessionLogTest::error(const std::vector<NoteIntonation> &notes, const Totals &expected)
+{
+    int expectedNotes = 0;
+    for (const NoteTotals &totals : expected) expectedNotes += totals.frames > 0;
+    double error = expectedNotes == static_cast<int>(notes.size()) ? 0.0 : 1.0;
+    for (const NoteIntonation &note : notes) {
+        const NoteTotals &totals = expected[note.midiNote];
+        error = std::max({error, std::abs(note.frames - totals.frames) * 1.0,
+                          std::abs(note.seconds - totals.seconds),
+                          std::abs(note.inTuneSeconds - totals.inTuneSeconds),
+                          totals.frames > 0 ? std::abs(note.meanCents - totals.sumCents / totals.frames) : 1.0});
+    }
+    return error;
+}
+
+void SessionLogTest::queriesMatchFrameScan()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("session.ctlog");
+    SessionLog log;
+    QVERIFY(log.start(path));
+
+    // Notes change every few seconds with pauses between some of them, the pitch drifts slowly sharp
+    std::mt19937 rng(44);
+    std::normal_distribution<double> scatter(0.0, 4.0);
+    std::vector<SessionFrame> frames;
+    const qint64 sessionUSecs = static_cast<qint64>(MINUTES) * 60 * 1000000;
+    qint64 timestamp = 0;
+    int midiNote = 48;
+    for (int i = 0; timestamp < sessionUSecs; ++i) {
+        timestamp += HOP_USECS;
+        if (i % FRAMES_PER_NOTE == 0) {
+            midiNote = 36 + static_cast<int>(rng() % 30);
+            if (rng() % 5 == 0) timestamp += 3000000;
+        }
+        SessionFrame frame;
+        frame.timestampUSecs = timestamp;
+        frame.midiNote = static_cast<qint16>(midiNote);
+        frame.cents = static_cast<float>(scatter(rng) + DRIFT_CENTS_PER_MINUTE * timestamp / 60e6);
+        frame.frequency = 440.0f;
+        frame.levelDb = -20.0f;
+        frame.confidence = 0.9f;
+        frames.push_back(frame);
+        log.append(frame);
+
+        // Keeps the queue from overflowing, the log is written far faster than real time anyway
+        if (i % (SessionLog::QUEUE_CAPACITY / 2) == 0) log.durationUSecs();
+    }
+    QCOMPARE(log.droppedFrames(), quint64(0));
+
+    for (int query = 0; query < QUERIES; ++query) {
+        qint64 from = 0;
+        qint64 to = -1;
+        if (query > 0) {
+            from = std::uniform_int_distribution<qint64>(0, timestamp)(rng);
+            to = std::uniform_int_distribution<qint64>(from, timestamp)(rng);
+        }
+        const double queryError = error(log.intonation(from, to), scan(frames, from, to < 0 ? timestamp + 1 : to));
+        QVERIFY2(queryError < MAX_ERROR, qPrintable(QString("%1 - %2: %3").arg(from).arg(to).arg(queryError)));
+    }
+
+    log.stop();
+    SessionLogReader reader;
+    QVERIFY(reader.open(path));
+    QCOMPARE(reader.frameCount(), static_cast<qint64>(frames.size()));
+    QVERIFY(error(reader.intonation(), scan(frames, 0, timestamp + 1)) < MAX_ERROR);
+}
+
+static SessionLogTest SESSION_LOG_TEST;
+
+#include "sessionlogtest.moc"
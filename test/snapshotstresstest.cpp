@@ -0,0 +1,156 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../tunerengine.h"
+#include "../audio/syntheticsource.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <set>
+#include <vector>
+
+// Result snapshots under load: an offline engine analyzes a tone jumping
+// between two notes as fast as the CPU allows while reader threads take
+// resultSnapshot() in a loop. Every snapshot must be one frame, frame indices
+// and timestamps never go back, and spectra read in place are either intact
+// or flagged by spectrumUnchanged(). Spectrum snapshots for renderers come
+// from a pool and are only reused once nobody holds them.
+class SnapshotStressTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void readersSeeWholeFrames();
+    void spectrumSnapshotsAreRecycled();
+
+private:
+    static constexpr int READERS = 4;
+    static constexpr int DURATION_MS = 3000;
+    static constexpr int CHUNKS_PER_NOTE = 6;
+    static constexpr double CENTS_TOLERANCE = 0.01;
+
+    struct ReaderStats {
+        qint64 reads = 0;
+        qint64 frames = 0;         // Distinct frames seen
+        qint64 inconsistent = 0;
+        qint64 spectraInPlace = 0;
+        qint64 spectraRecycled = 0;
+    };
+
+    // Equal temperament at A4 = 440 Hz, the engine's defaults
+    static bool consistent(const ResultSnapshot &snapshot);
+    static void readSnapshots(const TunerEngine &engine, const std::atomic<bool> &running, ReaderStats &stats);
+};
+
+bool SnapshotStressTest::consistent(const ResultSnapshot &snapshot)
+{
+    if (snapshot.frequency <= 0.0f) return snapshot.midiNote == -1 && snapshot.cents == 0.0f;
+    const double note = 69.0 + 12.0 * std::log2(snapshot.frequency / 440.0);
+    if (std::lround(note) != snapshot.midiNote) return false;
+    return std::abs((note - snapshot.midiNote) * 100.0 - snapshot.cents) < CENTS_TOLERANCE;
+}
+
+void SnapshotStressTest::readSnapshots(const TunerEngine &engine, const std::atomic<bool> &running, ReaderStats &stats)
+{
+    ResultSnapshot previous;
+    while (running.load(std::memory_order_relaxed)) {
+        const ResultSnapshot snapshot = engine.resultSnapshot();
+        ++stats.reads;
+        if (snapshot.frameIndex == 0) continue;
+
+        bool ok = consistent(snapshot) && snapshot.frameIndex >= previous.frameIndex;
+        if (snapshot.frameIndex > previous.frameIndex) {
+            ++stats.frames;
+            ok = ok && snapshot.timestampUSecs >= previous.timestampUSecs;
+        }
+        if (!ok) ++stats.inconsistent;
+
+        // Touch every bin in place, then ask whether the ring came round meanwhile
+        if (snapshot.spectrum.data) {
+            float strongest = 0.0f;
+            for (int i = 0; i < snapshot.spectrum.count; ++i) strongest = std::max(strongest, snapshot.spectrum.value(i));
+            if (engine.spectrumUnchanged(snapshot) && std::isfinite(strongest)) {
+                ++stats.spectraInPlace;
+            } else {
+                ++stats.spectraRecycled;
+            }
+        }
+        previous = snapshot;
+    }
+}
+
+void SnapshotStressTest::readersSeeWholeFrames()
+{
+    static const double notes[] = {65.41, 98.00};
+
+    TunerEngine engine(nullptr, false);
+    engine.setPowerSave(false);
+    SyntheticSource source;
+    source.setSampleRate(engine.sampleRate());
+    source.setChunkSize(1024);
+
+    std::atomic<bool> running{true};
+    std::vector<ReaderStats> stats(READERS);
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int i = 0; i < READERS; ++i) {
+        threads.emplace_back(QThread::create([&engine, &running, &stats, i]() {
+            readSnapshots(engine, running, stats[i]);
+        }));
+        threads.back()->start();
+    }
+
+    // Analysis runs synchronously in pump(), as fast as it goes
+    QElapsedTimer timer;
+    timer.start();
+    int chunk = 0;
+    while (timer.elapsed() < DURATION_MS) {
+        source.setFrequency(notes[chunk++ / CHUNKS_PER_NOTE % 2]);
+        source.pump(&engine, 1);
+    }
+    running = false;
+    for (auto &thread : threads) thread->wait();
+
+    QVERIFY(engine.resultSnapshot().frameIndex > 0);
+    for (const ReaderStats &s : stats) {
+        QCOMPARE(s.inconsistent, qint64(0));
+        QVERIFY(s.frames > 0);
+        QVERIFY(s.spectraInPlace > 0);
+    }
+}
+
+void SnapshotStressTest::spectrumSnapshotsAreRecycled()
+{
+    TunerEngine engine(nullptr, false);
+    engine.setPowerSave(false);
+    SyntheticSource source;
+    source.setSampleRate(engine.sampleRate());
+    source.setFrequency(65.41);
+    source.setChunkSize(engine.bufferSize());
+
+    source.pump(&engine, 4);
+    QVERIFY(engine.latestSpectrum());
+
+    // Without renderers two snapshots take turns: the latest and the one being filled
+    std::set<const SpectrumSnapshot *> seen;
+    for (int i = 0; i < 50; ++i) {
+        source.pump(&engine, 1);
+        seen.insert(engine.latestSpectrum().get());
+    }
+    QVERIFY(seen.size() <= 2);
+
+    // A held snapshot is never written again, however many frames follow
+    std::shared_ptr<const SpectrumSnapshot> held = engine.latestSpectrum();
+    const qint64 frameIndex = held->frameIndex;
+    const std::vector<float> magnitudes = held->magnitudes;
+    source.setFrequency(98.00);
+    source.pump(&engine, 50);
+    QCOMPARE(held->frameIndex, frameIndex);
+    QVERIFY(held->magnitudes == magnitudes);
+    QVERIFY(engine.latestSpectrum() != held);
+}
+
+static SnapshotStressTest SNAPSHOT_STRESS_TEST;
+
+#include "snapshotstresstest.moc"
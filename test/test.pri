@@ -0,0 +1,18 @@
+# QtTest cases, each registers itself with TestSuite and testMain.cpp runs them all
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+        $$PWD/adaptivewindowtest.cpp \
+        $$PWD/backlogtest.cpp \
+        $$PWD/configurationsoaktest.cpp \
+        $$PWD/fftplantest.cpp \
+        $$PWD/fixedpointtest.cpp \
+        $$PWD/latencytest.cpp \
+        $$PWD/notetabletest.cpp \
+        $$PWD/partialtrackertest.cpp \
+        $$PWD/peakpickertest.cpp \
+        $$PWD/pitchtrackertest.cpp \
+        $$PWD/powersavetest.cpp \
+        $$PWD/sessionlogtest.cpp \
+        $$PWD/snapshotstresstest.cpp \
+        $$PWD/toneloopbacktest.cpp \
@@ -0,0 +1,80 @@
+#include <QtTest/QtTest>
+#include "suite.hpp"
+#include "../tunerengine.h"
+#include "../audio/syntheticsource.h"
+#include "../tools/latencyHistogram.h"
+
+#include <cmath>
+
+// Reference tone loopback: an offline engine's own tone generator feeds its
+// input through the synthetic source, paced like a real device. The tone
+// steps through the cello's open strings and A4 in the harmonic timbres (the
+// FFT detector looks for a harmonic series, a sine has none) and each step
+// has to reach noteDetected at the note table pitch; switched off, the level
+// has to fall below the threshold once the fade has played. The drone fifth
+// is left out, with it the pair shares a fundamental an octave below.
+class ToneLoopbackTest : public TestSuite
+{
+    Q_OBJECT
+
+private slots:
+    void toneStepsReachNoteDetected();
+
+private:
+    static constexpr int STEPS = 15;
+    static constexpr int SETTLE_MS = 500;
+    static constexpr int BOUND_MS = 750;
+    static constexpr double MAX_CENTS = 10.0;
+};
+
+void ToneLoopbackTest::toneStepsReachNoteDetected()
+{
+    static const int notes[] = {36, 43, 50, 57, 69};  // C2 G2 D3 A3 A4
+
+    TunerEngine engine(nullptr, false);
+    SyntheticSource source;
+    source.setSampleRate(engine.sampleRate());
+    source.setChunkSize(512);
+    source.setGenerator(&engine.toneGenerator());
+
+    double detected = 0.0;
+    connect(&engine, &TunerEngine::noteDetected, this, [&detected](const QString &, double frequency, double) {
+        detected = frequency;
+    });
+    auto onTarget = [&detected](double target) {
+        return detected > 0.0 && std::abs(1200.0 * std::log2(detected / target)) <= MAX_CENTS;
+    };
+
+    QStringList timbres = engine.toneTimbres();
+    timbres.removeAll("Sine");
+    QVERIFY(!timbres.isEmpty());
+    engine.setToneNote(notes[0]);
+    engine.setToneEnabled(true);
+    source.start(&engine);
+    QTest::qWait(SETTLE_MS);
+
+    LatencyHistogram stepLatency;
+    for (int step = 1; step <= STEPS; ++step) {
+        engine.setToneTimbre(timbres.at(step % timbres.size()));
+        engine.setToneNote(notes[step % 5]);
+        const double target = engine.toneFrequency();
+        detected = 0.0;
+
+        const qint64 stepUSecs = engine.monotonicUSecs();
+        const QString name = engine.toneTimbre() + " " + engine.toneNoteName();
+        QTRY_VERIFY2_WITH_TIMEOUT(onTarget(target), qPrintable(QString("%1, last %2 Hz").arg(name).arg(detected)),
+                                  BOUND_MS);
+        stepLatency.add(engine.monotonicUSecs() - stepUSecs);
+        QTest::qWait(SETTLE_MS);
+    }
+    qInfo().noquote() << "tone step -> noteDetected:" << stepLatency.summary();
+
+    // The fade out has to reach the analysis too
+    engine.setToneEnabled(false);
+    QTRY_VERIFY_WITH_TIMEOUT(engine.signalLevel() < engine.dbThreshold(), BOUND_MS);
+    source.stop();
+}
+
+static ToneLoopbackTest TONE_LOOPBACK_TEST;
+
+#include "toneloopbacktest.moc"
@@ -44,6 +44,6 @@ int main(int argc, char *argv[])
     for (auto it = suite.begin(); it != suite.end(); ++it) {
         runTest(*it);
     }
-    return 0;
+    return status;
 }
 #endif
@@ -0,0 +1,90 @@
+#include "latencyHistogram.h"
+
+#include <QVariantList>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+void LatencyHistogram::add(qint64 usecs)
+{
+    usecs = std::max<qint64>(usecs, 0);
+    ++m_buckets[bucketIndex(usecs)];
+    ++m_count;
+    m_sum += usecs;
+    m_max = std::max(m_max, usecs);
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+}
+
+int LatencyHistogram::bucketIndex(qint64 usecs)
+{
+    // Below 4 us each value has its own bucket, above that the two bits after
+    // the leading one pick the quarter of the octave
+    if (usecs < SUB_BUCKETS) return static_cast<int>(usecs);
+    int octave = std::bit_width(static_cast<quint64>(usecs)) - 1;
+    int sub = static_cast<int>(usecs >> (octave - 2)) & (SUB_BUCKETS - 1);
+    return std::min((octave - 1) * SUB_BUCKETS + sub, BUCKET_COUNT - 1);
+}
+
+qint64 LatencyHistogram::bucketUpperUSecs(int index)
+{
+    if (index < SUB_BUCKETS) return index + 1;
+    int octave = index / SUB_BUCKETS + 1;
+    int sub = index % SUB_BUCKETS;
+    return static_cast<qint64>(SUB_BUCKETS + sub + 1) << (octave - 2);
+}
+
+qint64 LatencyHistogram::percentileUSecs(double p) const
+{
+    if (m_count == 0) return 0;
+    qint64 rank = std::max<qint64>(1, static_cast<qint64>(std::ceil(std::clamp(p, 0.0, 1.0) * m_count)));
+    qint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) return std::min(bucketUpperUSecs(i), m_max);
+    }
+    return m_max;
+}
+
+QVariantMap LatencyHistogram::toVariantMap() const
+{
+    QVariantMap map;
+    map["count"] = m_count;
+    map["meanMs"] = meanUSecs() / 1000.0;
+    map["p50Ms"] = percentileUSecs(0.5) / 1000.0;
+    map["p90Ms"] = percentileUSecs(0.9) / 1000.0;
+    map["p99Ms"] = percentileUSecs(0.99) / 1000.0;
+    map["maxMs"] = m_max / 1000.0;
+
+    QVariantList buckets;
+    if (m_count > 0) {
+        int first = 0;
+        while (m_buckets[first] == 0) ++first;
+        int last = bucketIndex(m_max);
+        for (int i = first; i <= last; ++i) {
+            QVariantMap bucket;
+            bucket["upperMs"] = bucketUpperUSecs(i) / 1000.0;
+            bucket["count"] = m_buckets[i];
+            buckets.append(bucket);
+        }
+    }
+    map["buckets"] = buckets;
+    return map;
+}
+
+QString LatencyHistogram::summary() const
+{
+    return QString("n %1 mean %2 p50 %3 p90 %4 p99 %5 max %6 ms")
+            .arg(m_count)
+            .arg(meanUSecs() / 1000.0, 0, 'f', 1)
+            .arg(percentileUSecs(0.5) / 1000.0, 0, 'f', 1)
+            .arg(percentileUSecs(0.9) / 1000.0, 0, 'f', 1)
+            .arg(percentileUSecs(0.99) / 1000.0, 0, 'f', 1)
+            .arg(m_max / 1000.0, 0, 'f', 1);
+}
@@ -0,0 +1,44 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QString>
+#include <QVariantMap>
+#include <array>
+
+// Log-linear histogram of latencies in microseconds: four buckets per octave
+// from 1 us up to about a minute, so adding a sample is a few integer
+// operations and never allocates. Percentiles report the upper edge of their
+// bucket, at most 25% above the true value.
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKETS = 4;
+    static constexpr int OCTAVES = 26;
+    static constexpr int BUCKET_COUNT = SUB_BUCKETS * OCTAVES;
+
+    void add(qint64 usecs);
+    void reset();
+
+    qint64 count() const { return m_count; }
+    qint64 maxUSecs() const { return m_max; }
+    double meanUSecs() const { return m_count > 0 ? static_cast<double>(m_sum) / m_count : 0.0; }
+    // p in [0, 1]
+    qint64 percentileUSecs(double p) const;
+
+    // count, meanMs, p50Ms, p90Ms, p99Ms, maxMs and buckets, a list of
+    // {upperMs, count} covering the occupied range
+    QVariantMap toVariantMap() const;
+    // One log line, "n 120 mean 4.1 p50 3.9 p90 6.0 p99 9.8 max 12.3 ms"
+    QString summary() const;
+
+private:
+    static int bucketIndex(qint64 usecs);
+    static qint64 bucketUpperUSecs(int index);
+
+    std::array<qint64, BUCKET_COUNT> m_buckets{};
+    qint64 m_count = 0;
+    qint64 m_sum = 0;
+    qint64 m_max = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,57 @@
+#include "startupProfile.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <unistd.h>
+
+namespace {
+
+QElapsedTimer s_timer;
+double s_offsetMs = 0.0;  // Time spent between exec() and begin()
+QVariantMap s_milestones;
+
+double processAgeAtBeginMs()
+{
+#ifdef Q_OS_LINUX
+    // Field 22 of /proc/self/stat is the start time in clock ticks since boot
+    QFile stat("/proc/self/stat");
+    QFile uptime("/proc/uptime");
+    if (!stat.open(QIODevice::ReadOnly) || !uptime.open(QIODevice::ReadOnly)) return 0.0;
+    QByteArray line = stat.readAll();
+    QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 20) return 0.0;
+    double startSeconds = fields.at(19).toDouble() / sysconf(_SC_CLK_TCK);
+    double uptimeSeconds = uptime.readAll().split(' ').value(0).toDouble();
+    return qMax(0.0, (uptimeSeconds - startSeconds) * 1000.0);
+#else
+    return 0.0;
+#endif
+}
+
+}
+
+namespace StartupProfile {
+
+void begin()
+{
+    s_offsetMs = processAgeAtBeginMs();
+    s_timer.start();
+    mark("main");
+}
+
+void mark(const char *milestone)
+{
+    if (!s_timer.isValid() || s_milestones.contains(milestone)) return;
+
+    double ms = s_offsetMs + s_timer.nsecsElapsed() / 1.0e6;
+    s_milestones.insert(milestone, ms);
+    qInfo().noquote() << "startup:" << milestone << QString::number(ms, 'f', 1) << "ms";
+}
+
+QVariantMap milestones()
+{
+    return s_milestones;
+}
+
+}
@@ -0,0 +1,17 @@
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+#include <QVariantMap>
+
+// Startup timing: process start -> first frame -> first audio block -> first note.
+// Each milestone is logged once, in milliseconds since the process was started.
+namespace StartupProfile {
+
+// Call first thing in main()
+void begin();
+void mark(const char *milestone);
+QVariantMap milestones();
+
+}
+
+#endif // STARTUPPROFILE_H
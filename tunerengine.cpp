@@ -1,56 +1,233 @@
 #include "tunerengine.h"
+#include "dsp/fftplan.h"
+#include "dsp/fixedpoint.h"
+#include "config/autoconfig.h"
+#include "audio/audioinputsink.h"
 #include <QDebug>
 #include <QtMath>
 #include <QMediaDevices>
 #include <QAudioDevice>
 #include <QAudioSource>
+#include <QAudioSink>
+#include <QTimer>
 #include <QIODevice>
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
 #include <algorithm>
 #include <stdlib.h>
+#ifdef Q_OS_LINUX
+#include <time.h>
+#endif
+
+namespace {
+
+struct DetectionMethod {
+    const char *name;
+    PitchDetector::Method method;
+};
+
+constexpr DetectionMethod DETECTION_METHODS[] = {
+    {"FFT", PitchDetector::Method::Fft},
+    {"Autocorrelation", PitchDetector::Method::Autocorrelation},
+    {"Harmonic sum", PitchDetector::Method::HarmonicSum},
+    {"Cepstrum", PitchDetector::Method::Cepstrum},
+    {"Ensemble", PitchDetector::Method::Ensemble}
+};
+
+struct BacklogPolicyName {
+    const char *name;
+    TunerEngine::BacklogPolicy policy;
+};
+
+constexpr BacklogPolicyName BACKLOG_POLICIES[] = {
+    {"Process all", TunerEngine::BacklogPolicy::ProcessAll},
+    {"Latest only", TunerEngine::BacklogPolicy::LatestOnly},
+    {"Skip to newest", TunerEngine::BacklogPolicy::SkipToNewest}
+};
+
+struct ToneTimbre {
+    const char *name;
+    WavetableOscillator::Timbre timbre;
+};
+
+constexpr ToneTimbre TONE_TIMBRES[] = {
+    {"Sine", WavetableOscillator::Timbre::Sine},
+    {"Cello", WavetableOscillator::Timbre::Cello},
+    {"Organ", WavetableOscillator::Timbre::Organ}
+};
+
+// Interned note names indexed by MIDI note number, so lookups never build strings
+const QStringList &noteNameTable()
+{
+    static const QStringList names = [] {
+        static const char *pitchNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+        QStringList list;
+        for (int note = 0; note < 128; ++note) {
+            list.append(QString(pitchNames[note % 12]) + QString::number(note / 12 - 1));
+        }
+        return list;
+    }();
+    return names;
+}
 
-TunerEngine::TunerEngine(QObject *parent)
+// CPU time consumed by the calling thread, 0 where it cannot be measured
+qint64 threadCpuNsecs()
+{
+#ifdef Q_OS_LINUX
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return static_cast<qint64>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+#endif
+    return 0;
+}
+
+// Indexed by TunerEngine::LatencyStage
+const char *const latencyStageNames[] = {"capture", "analysis", "properties", "render", "total"};
+
+}
+
+TunerEngine::TunerEngine(QObject *parent, bool openAudioInput)
     : QObject(parent)
+    , m_openAudioInput(openAudioInput)
     , m_audioSource(nullptr)
     , m_audioDevice(nullptr)
-    , m_fftBuffer(m_bufferSize)
+    , m_inputSink(new AudioInputSink(this, this))
 {
-    setupAudioInput();
+    m_monotonicClock.start();
+
+    // Settings changes are recorded so a capture replays with what was active
+    connect(this, &TunerEngine::sampleRateChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::bufferSizeChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::fftPaddingChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::detectionMethodChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::dbThresholdChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::adaptiveWindowChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::maxPeaksChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::referenceAChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::temperamentChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::strobeModeChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::fixedPointChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::instrumentChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::targetStringChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::powerSaveChanged, this, &TunerEngine::recordCaptureSettings);
+    connect(this, &TunerEngine::backlogPolicyChanged, this, &TunerEngine::recordCaptureSettings);
+
+    m_spectrumRing.allocate(SPECTRUM_SLOTS, SPECTRUM_SLOT_BINS);
+    for (auto &pooled : m_spectrumPool) {
+        pooled = std::make_shared<SpectrumSnapshot>();
+        pooled->magnitudes.reserve(SPECTRUM_SLOT_BINS);
+    }
+
+    m_toneGenerator.oscillator().setTimbre(WavetableOscillator::Timbre::Cello);
+    m_toneGenerator.oscillator().setLevel(m_toneVolume);
+    m_toneGenerator.oscillator().setFadeSeconds(TONE_FADE_MS / 1000.0);
+
+    rebuildNoteTable();
+    configureIdleMonitor();
+    m_detector.setNoteTable(&m_noteTable);
+
+    m_backgroundPool.setMaxThreadCount(1);
+    probeAudioInput();
+    warmUpAnalysis();
 }
 
 TunerEngine::~TunerEngine()
 {
+    // Queued probe results die with this object, only a running task must finish
+    m_backgroundPool.waitForDone();
     stop();
+    stopCapture();
+    stopResultServer();
+    stopSession();
     delete m_audioSource;
+    // Pulls from m_toneGenerator, which goes before the children do
+    delete m_toneSink;
 }
 
-void TunerEngine::setupAudioInput()
+void TunerEngine::probeAudioInput()
+{
+    if (!m_openAudioInput) return;
+
+    m_inputProbed = false;
+    m_backgroundPool.start([this]() {
+        // QAudioDevice is a plain value, only the QAudioSource has to be made on the GUI thread
+        QAudioDevice device = QMediaDevices::defaultAudioInput();
+        QMetaObject::invokeMethod(this, [this, device]() {
+            onAudioInputProbed(device);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void TunerEngine::onAudioInputProbed(const QAudioDevice &device)
 {
+    m_inputDevice = device;
+    m_inputProbed = true;
     updateMaximumSampleRate();
 
+    // Settings applied while probing are already in place, the source is built once
+    setupAudioInput();
+    if (m_startPending) {
+        m_startPending = false;
+        start();
+    }
+    emit audioInputOpened();
+
+    // A different input device is a different fingerprint
+    autoConfigureIfNeeded();
+}
+
+void TunerEngine::warmUpAnalysis()
+{
+    // The caches are thread safe, a block arriving first simply builds the plan itself
+    m_detector.setSettings(detectorSettings());
+    int windowSize = m_strobeMode ? STROBE_WINDOW : m_targetString >= 0 ? m_targetWindowSize : m_bufferSize;
+    int paddedSize = m_detector.paddedSize(windowSize);
+    bool fixed = fixedPointActive();
+    m_backgroundPool.start([windowSize, paddedSize, fixed]() {
+        if (fixed) {
+            FixedPoint::hannWindow(windowSize);
+            FixedFftPlan::forSize(paddedSize);
+        } else {
+            HannWindow::forLength(windowSize);
+            FftPlan::forSize(paddedSize);
+        }
+    });
+}
+
+void TunerEngine::setupAudioInput()
+{
+    if (!m_openAudioInput || !m_inputProbed) return;
+
     QAudioFormat format;
     format.setSampleRate(m_sampleRate);
     format.setChannelCount(1);
     format.setSampleFormat(QAudioFormat::Int16);
 
-    // Get default audio input device
-    QMediaDevices* devices = new QMediaDevices(this);
-    QAudioDevice inputDevice = devices->defaultAudioInput();
-    
-    if (!inputDevice.isFormatSupported(format)) {
+    // Release the previous source before creating a new one
+    if (m_audioSource) {
+        stop();
+        delete m_audioSource;
+        m_audioSource = nullptr;
+    }
+
+    if (!m_inputDevice.isFormatSupported(format)) {
         qWarning() << "Default format not supported, trying to use nearest";
-        format = inputDevice.preferredFormat();
+        format = m_inputDevice.preferredFormat();
         m_sampleRate = format.sampleRate();
         emit sampleRateChanged();
     }
 
-    m_audioSource = new QAudioSource(inputDevice, format, this);
+    m_audioSource = new QAudioSource(m_inputDevice, format, this);
+    if (m_deviceBufferSize > 0) {
+        m_audioSource->setBufferSize(m_deviceBufferSize * static_cast<qsizetype>(sizeof(qint16)));
+    }
 }
 
 void TunerEngine::updateMaximumSampleRate()
 {
-    QMediaDevices* devices = new QMediaDevices(this);
-    QAudioDevice inputDevice = devices->defaultAudioInput();
-    QAudioFormat format = inputDevice.preferredFormat();
+    QAudioFormat format = m_inputDevice.preferredFormat();
     
     int maxRate = format.sampleRate();
     if (m_maximumSampleRate != maxRate) {
@@ -58,81 +235,561 @@ void TunerEngine::updateMaximumSampleRate()
         emit maximumSampleRateChanged();
     }
     qDebug() << "Maximum sample rate:" << m_maximumSampleRate;
+}
+
+void TunerEngine::beginConfiguration()
+{
+    ++m_configurationDepth;
+}
+
+void TunerEngine::endConfiguration()
+{
+    if (m_configurationDepth == 0 || --m_configurationDepth > 0) return;
+
+    int flags = m_pendingRebuild;
+    m_pendingRebuild = 0;
+    rebuild(flags);
+    recordCaptureSettings();
+}
+
+void TunerEngine::applySettings(const QVariantMap &settings)
+{
+    beginConfiguration();
+    if (settings.contains("sampleRate")) setSampleRate(settings.value("sampleRate").toInt());
+    if (settings.contains("bufferSize")) setBufferSize(settings.value("bufferSize").toInt());
+    if (settings.contains("deviceBufferSize")) setDeviceBufferSize(settings.value("deviceBufferSize").toInt());
+    if (settings.contains("fftPadding")) setFftPadding(settings.value("fftPadding").toInt());
+    if (settings.contains("adaptiveWindow")) setAdaptiveWindow(settings.value("adaptiveWindow").toBool());
+    if (settings.contains("detectionMethod")) setDetectionMethod(settings.value("detectionMethod").toString());
+    if (settings.contains("dbThreshold")) setDbThreshold(settings.value("dbThreshold").toDouble());
+    if (settings.contains("maxPeaks")) setMaxPeaks(settings.value("maxPeaks").toInt());
+    if (settings.contains("referenceA")) setReferenceA(settings.value("referenceA").toDouble());
+    if (settings.contains("temperament")) setTemperament(settings.value("temperament").toString());
+    if (settings.contains("temperamentRoot")) setTemperamentRoot(settings.value("temperamentRoot").toInt());
+    if (settings.contains("customCents")) setCustomCents(settings.value("customCents").toList());
+    if (settings.contains("instrument")) setInstrument(settings.value("instrument").toString());
+    if (settings.contains("targetString")) setTargetString(settings.value("targetString").toInt());
+    if (settings.contains("strobeMode")) setStrobeMode(settings.value("strobeMode").toBool());
+    if (settings.contains("fixedPoint")) setFixedPoint(settings.value("fixedPoint").toBool());
+    if (settings.contains("powerSave")) setPowerSave(settings.value("powerSave").toBool());
+    if (settings.contains("idleDelay")) setIdleDelay(settings.value("idleDelay").toDouble());
+    if (settings.contains("backlogPolicy")) setBacklogPolicy(settings.value("backlogPolicy").toString());
+    if (settings.contains("toneNote")) setToneNote(settings.value("toneNote").toInt());
+    if (settings.contains("toneFifth")) setToneFifth(settings.value("toneFifth").toBool());
+    if (settings.contains("toneTimbre")) setToneTimbre(settings.value("toneTimbre").toString());
+    if (settings.contains("toneVolume")) setToneVolume(settings.value("toneVolume").toDouble());
+    if (settings.contains("toneEnabled")) setToneEnabled(settings.value("toneEnabled").toBool());
+    // Last, a cached profile overrides the sample rate, buffer size, padding and method above
+    if (settings.contains("autoConfigure")) setAutoConfigure(settings.value("autoConfigure").toBool());
+    endConfiguration();
+}
 
-    delete devices;
+void TunerEngine::requestRebuild(int flags)
+{
+    if (m_configurationDepth > 0) {
+        m_pendingRebuild |= flags;
+    } else {
+        rebuild(flags);
+    }
+}
+
+void TunerEngine::rebuild(int flags)
+{
+    // Depends on the rate, the reference and the target string
+    m_targetWindowSize = targetWindowSize();
+
+    if (flags & RebuildAudio) {
+        // Reconfigure audio input with new sample rate, resuming only if it was running
+        bool wasRunning = m_audioDevice != nullptr || m_startPending;
+        stop();
+        setupAudioInput();
+        if (wasRunning) start();
+    }
+
+    if (flags & (RebuildAudio | RebuildAnalysis)) {
+        // Clear accumulation buffer to avoid processing with wrong size
+        m_accumulationBuffer.clear();
+        m_chunkTimeCount = 0;
+        m_pendingWindowSize = 0;
+        m_detector.resetPhase();
+        configureIdleMonitor();
+
+        // Warm the cached plans for the fixed window so the next block does not build them
+        warmUpAnalysis();
+    }
+
+    if (flags & RebuildNoteTable) {
+        rebuildNoteTable();
+    }
 }
 
 void TunerEngine::start()
 {
+    if (m_openAudioInput && !m_inputProbed) {
+        m_startPending = true;
+        return;
+    }
     if (m_audioSource && !m_audioDevice) {
         m_accumulationBuffer.clear(); // Clear the accumulation buffer when starting
-        m_audioDevice = m_audioSource->start();
-        connect(m_audioDevice, &QIODevice::readyRead, this, &TunerEngine::processAudioInput);
+        m_chunkTimeCount = 0;
+        m_deviceReadSamples = 0;
+        // Push mode: the backend writes each period into the sink, no intermediate buffers
+        if (!m_inputSink->isOpen()) m_inputSink->open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+        m_audioSource->start(m_inputSink);
+        m_audioDevice = m_inputSink;
+        emit deviceBufferSizeChanged();
     }
 }
 
 void TunerEngine::stop()
 {
+    m_startPending = false;
     if (m_audioSource) {
         m_audioSource->stop();
-        if (m_audioDevice) {
-            disconnect(m_audioDevice, &QIODevice::readyRead, this, &TunerEngine::processAudioInput);
-            m_audioDevice = nullptr;
-        }
-        m_accumulationBuffer.clear(); // Clear the accumulation buffer when stopping
+        m_audioDevice = nullptr;
     }
+    // Also cleared without a device, so replays see the same restarts as the capture
+    m_accumulationBuffer.clear(); // Clear the accumulation buffer when stopping
+    m_chunkTimeCount = 0;
+    m_pendingWindowSize = 0;
+    m_pitchTracker.reset();
+    m_detector.resetPhase();
+
+    // A restarted stream begins with full analysis
+    bool wasIdle = m_idleMonitor.isIdle();
+    m_idleMonitor.reset();
+    if (wasIdle) emit idleChanged();
 }
 
-void TunerEngine::processAudioInput()
+void TunerEngine::ingestDeviceAudio(const char *data, qint64 size)
 {
     if (!m_audioDevice) return;
+    const int count = static_cast<int>(size / 2);
+
+    // processedUSecs counts what the device captured, the part not delivered
+    // yet is how old the newest sample of this write already is
+    m_deviceReadSamples += count;
+    qint64 deviceDelay = m_audioSource->processedUSecs() - m_deviceReadSamples * 1000000 / m_sampleRate;
+    ingestSamples(reinterpret_cast<const qint16*>(data), count, monotonicUSecs(), std::max<qint64>(deviceDelay, 0));
+}
+
+void TunerEngine::ingestAudio(const QByteArray &chunk, qint64 arrivalUSecs, qint64 deviceDelayUSecs)
+{
+    ingestSamples(reinterpret_cast<const qint16*>(chunk.constData()), static_cast<int>(chunk.size() / 2),
+                  arrivalUSecs, deviceDelayUSecs);
+}
 
-    // Read available data and add it to accumulation buffer
-    QByteArray buffer = m_audioDevice->readAll();
-    m_accumulationBuffer.append(buffer);
+void TunerEngine::ingestSamples(const qint16 *samples, int count, qint64 arrivalUSecs, qint64 deviceDelayUSecs)
+{
+    const qint64 cpuStart = threadCpuNsecs();
+    PowerCounter &counter = m_idleMonitor.isIdle() ? m_idlePower : m_activePower;
+
+    if (m_captureWriter.isOpen()) {
+        m_captureWriter.writeAudio(arrivalUSecs, QByteArray::fromRawData(reinterpret_cast<const char*>(samples),
+                                                                         count * 2));
+    }
+
+    // The one copy on the way in; a full ring drops its oldest samples, which
+    // breaks phase continuity
+    int dropped = m_accumulationBuffer.write(samples, count);
+    if (dropped > 0) {
+        m_sampleClock += dropped;
+        m_pendingWindowSize = 0;
+        m_detector.resetPhase();
+    }
+
+    // Replayed and synthetic chunks carry their own time base, latency always uses the engine clock
+    while (m_chunkTimeCount > 0 && chunkTime(0).endSample <= m_sampleClock) {
+        m_firstChunkTime = (m_firstChunkTime + 1) % CHUNK_TIME_CAPACITY;
+        --m_chunkTimeCount;
+    }
+    pushChunkTime(m_sampleClock + m_accumulationBuffer.size(), monotonicUSecs() - deviceDelayUSecs);
 
-    // Process data when we have enough samples
-    while (m_accumulationBuffer.size() >= m_bufferSize * 2) {
-        processAccumulatedData();
+    // Idle blocks only go through the envelope scan, a wake-up hands the
+    // rest of the block to full analysis, which may send it idle again
+    while (!m_idleMonitor.isIdle() || scanIdle()) {
+        analyzeAccumulation();
+        if (!m_idleMonitor.isIdle()) break;
     }
+
+    counter.cpuNsecs += threadCpuNsecs() - cpuStart;
+    counter.samples += count;
 }
 
-void TunerEngine::processAccumulatedData()
+void TunerEngine::analyzeAccumulation()
 {
-    QVector<double> samples;
-    samples.reserve(m_bufferSize);
+    if (m_strobeMode) {
+        // Overlapping frames, each hop keeps the rest of the window for the next one
+        while (m_accumulationBuffer.size() >= STROBE_WINDOW && !m_idleMonitor.isIdle()) {
+            dropBacklog(STROBE_WINDOW, STROBE_HOP);
+            processAccumulatedData(STROBE_WINDOW, STROBE_HOP);
+        }
+        return;
+    }
 
-    // Convert bytes to doubles
-    const qint16* data = reinterpret_cast<const qint16*>(m_accumulationBuffer.constData());
-    for (int i = 0; i < m_bufferSize; ++i) {
-        samples.append(data[i] / 32768.0); // Normalize to [-1, 1]
+    if (m_targetString >= 0) {
+        // A single string needs one fixed window sized to its lowest pitch
+        while (m_accumulationBuffer.size() >= m_targetWindowSize && !m_idleMonitor.isIdle()) {
+            dropBacklog(m_targetWindowSize, m_targetWindowSize);
+            processAccumulatedData(m_targetWindowSize, m_targetWindowSize);
+        }
+        return;
     }
 
-    // Remove the processed data from the accumulation buffer
-    m_accumulationBuffer.remove(0, m_bufferSize * 2);
+    if (!m_adaptiveWindow) {
+        // Process data when we have enough samples
+        while (m_accumulationBuffer.size() >= m_bufferSize && !m_idleMonitor.isIdle()) {
+            dropBacklog(m_bufferSize, m_bufferSize);
+            processAccumulatedData(m_bufferSize, m_bufferSize);
+        }
+        return;
+    }
+
+    // Adaptive mode: size each window from a short probe, wait for more data if needed
+    while (m_accumulationBuffer.size() >= ADAPTIVE_PROBE_SIZE && !m_idleMonitor.isIdle()) {
+        if (m_pendingWindowSize == 0) {
+            // The next window is not sized yet, the last one stands in for the backlog
+            dropBacklog(m_analysisWindowSize, m_analysisWindowSize);
+            m_pendingWindowSize = selectAdaptiveWindowSize();
+        }
+        if (m_accumulationBuffer.size() < m_pendingWindowSize) {
+            break;
+        }
+        int windowSize = m_pendingWindowSize;
+        m_pendingWindowSize = 0;
+        processAccumulatedData(windowSize, windowSize);
+    }
+}
+
+void TunerEngine::dropBacklog(int windowSize, int hopSize)
+{
+    const int buffered = m_accumulationBuffer.size();
+    const int pending = buffered >= windowSize ? (buffered - windowSize) / hopSize + 1 : 0;
+    if (pending > m_maxBacklogBlocks) {
+        m_maxBacklogBlocks = pending;
+        m_maxBacklogSamples = buffered;
+    }
 
-    // Calculate and emit signal level
-    double dbLevel = calculateDBFS(samples);
+    // Only a second complete window behind the first makes the first one stale
+    if (m_backlogPolicy == BacklogPolicy::ProcessAll || buffered < 2 * windowSize) return;
+
+    const int stale = (buffered - windowSize) / hopSize;
+    const int samples = stale * hopSize;
+    m_accumulationBuffer.consume(samples);
+    m_sampleClock += samples;
+    // Reported through backlogStats and the periodic log, a long stall drops on every block
+    m_droppedBlocks += stale;
+    m_pendingWindowSize = 0;
+    // Phase refinement needs consecutive hops
+    m_detector.resetPhase();
+    if (m_backlogPolicy == BacklogPolicy::SkipToNewest) {
+        m_pitchTracker.skip(stale);
+    }
+}
+
+void TunerEngine::configureIdleMonitor()
+{
+    m_idleMonitor.configure(m_sampleRate, m_dbThreshold, m_idleDelay);
+}
+
+void TunerEngine::enterIdle()
+{
+    m_pendingWindowSize = 0;
+    m_idleLevelSamples = 0;
+    emit idleChanged();
+    qDebug() << "Power save: idle after" << m_idleDelay << "s below threshold";
+}
+
+bool TunerEngine::scanIdle()
+{
+    const int count = m_accumulationBuffer.size();
+    const qint16 *data = m_accumulationBuffer.data();
+    const int wakeOffset = m_idleMonitor.scan(data, count);
+    const int consumed = wakeOffset < 0 ? count : wakeOffset;
+    m_sampleClock += consumed;
+
+    // The meter only needs a few updates per second while nobody plays
+    m_idleLevelSamples += consumed;
+    if (wakeOffset >= 0 || m_idleLevelSamples * IDLE_LEVEL_UPDATES_PER_SECOND >= m_sampleRate) {
+        m_idleLevelSamples = 0;
+        double dbLevel = m_idleMonitor.takeLevelDb();
+        if (m_signalLevel != dbLevel) {
+            m_signalLevel = dbLevel;
+            emit signalLevelChanged();
+            emit signalLevel(dbLevel);
+        }
+        m_result = ResultRecord();
+        m_result.timestampUSecs = captureTimeOf(m_sampleClock - 1);
+        m_result.levelDb = static_cast<float>(dbLevel);
+        if (m_resultServer.isRunning()) {
+            m_result.sequence = m_resultSequence++;
+            m_resultServer.publish(m_result);
+        }
+        publishSnapshot(true);
+    }
+
+    if (wakeOffset < 0) {
+        m_accumulationBuffer.clear();
+        return false;
+    }
+    m_accumulationBuffer.consume(wakeOffset);
+    m_detector.resetPhase();
+    emit idleChanged();
+    return true;
+}
+
+bool TunerEngine::startCapture(const QString &path)
+{
+    QString capturePath = path;
+    if (capturePath.isEmpty()) {
+        QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+        dir.mkpath("captures");
+        capturePath = dir.filePath("captures/capture-" +
+                                   QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".ctcap");
+    }
+
+    if (!m_captureWriter.open(capturePath)) return false;
+    recordCaptureSettings();
+    qDebug() << "Capturing raw input to" << capturePath;
+    emit capturingChanged();
+    return true;
+}
+
+bool TunerEngine::startSession(const QString &path)
+{
+    QString sessionPath = path;
+    if (sessionPath.isEmpty()) {
+        QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+        dir.mkpath("sessions");
+        sessionPath = dir.filePath("sessions/session-" +
+                                   QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".ctlog");
+    }
+
+    if (!m_sessionLog.start(sessionPath)) return false;
+    m_sessionStartUSecs = monotonicUSecs();
+    qDebug() << "Logging practice session to" << sessionPath;
+    emit sessionRecordingChanged();
+    return true;
+}
+
+void TunerEngine::stopSession()
+{
+    if (m_sessionLog.isRecording()) {
+        m_sessionLog.stop();
+        qDebug() << "Session written to" << m_sessionLog.path();
+        emit sessionRecordingChanged();
+    }
+}
+
+QVariantMap TunerEngine::sessionStatistics(double fromSeconds, double toSeconds)
+{
+    const qint64 toUSecs = toSeconds < 0 ? -1 : static_cast<qint64>(toSeconds * 1e6);
+    QVariantList notes;
+    for (const NoteIntonation &intonation : m_sessionLog.intonation(static_cast<qint64>(fromSeconds * 1e6), toUSecs)) {
+        QVariantList timeline;
+        for (const auto &[seconds, cents] : intonation.timeline) {
+            timeline.append(QVariantMap{{"seconds", seconds}, {"cents", cents}});
+        }
+        QVariantMap note;
+        note["note"] = noteNameTable().value(intonation.midiNote);
+        note["midiNote"] = intonation.midiNote;
+        note["frames"] = intonation.frames;
+        note["seconds"] = intonation.seconds;
+        note["inTuneSeconds"] = intonation.inTuneSeconds;
+        note["inTuneFraction"] = intonation.seconds > 0 ? intonation.inTuneSeconds / intonation.seconds : 0.0;
+        note["meanCents"] = intonation.meanCents;
+        note["stddevCents"] = intonation.stddevCents;
+        note["driftCentsPerMinute"] = intonation.driftCentsPerMinute;
+        note["timeline"] = timeline;
+        notes.append(note);
+    }
+
+    QVariantMap statistics;
+    statistics["durationSeconds"] = m_sessionLog.durationUSecs() / 1e6;
+    statistics["inTuneCents"] = SessionLogFormat::IN_TUNE_CENTS;
+    statistics["droppedFrames"] = static_cast<qulonglong>(m_sessionLog.droppedFrames());
+    statistics["notes"] = notes;
+    return statistics;
+}
+
+bool TunerEngine::startResultServer(int port)
+{
+    if (!m_resultServer.start(static_cast<quint16>(port))) return false;
+    m_resultSequence = 0;
+    emit resultServerRunningChanged();
+    return true;
+}
+
+void TunerEngine::stopResultServer()
+{
+    if (!m_resultServer.isRunning()) return;
+    m_resultServer.stop();
+    emit resultServerRunningChanged();
+}
+
+void TunerEngine::stopCapture()
+{
+    if (m_captureWriter.isOpen()) {
+        qDebug() << "Capture written to" << m_captureWriter.path();
+        m_captureWriter.close();
+        emit capturingChanged();
+    }
+}
+
+CaptureSettings TunerEngine::captureSettings() const
+{
+    CaptureSettings settings;
+    settings.sampleRate = m_sampleRate;
+    settings.bufferSize = m_bufferSize;
+    settings.fftPadding = m_fftPadding;
+    settings.detectionMethod = m_detectionMethod;
+    settings.dbThreshold = m_dbThreshold;
+    settings.adaptiveWindow = m_adaptiveWindow;
+    settings.maxPeaks = m_maxPeaks;
+    settings.referenceA = m_referenceA;
+    settings.temperament = m_temperament;
+    settings.temperamentRoot = m_temperamentRoot;
+    settings.customCents = QList<double>(m_customCents.begin(), m_customCents.end());
+    settings.instrument = m_instrument;
+    settings.targetString = m_targetString;
+    settings.strobeMode = m_strobeMode;
+    settings.powerSave = m_powerSave;
+    settings.idleDelay = m_idleDelay;
+    settings.fixedPoint = m_fixedPoint;
+    settings.backlogPolicy = m_backlogPolicyName;
+    return settings;
+}
+
+void TunerEngine::recordCaptureSettings()
+{
+    // Inside a transaction the record is written once by endConfiguration()
+    if (m_captureWriter.isOpen() && m_configurationDepth == 0) {
+        m_captureWriter.writeSettings(m_monotonicClock.nsecsElapsed() / 1000, captureSettings());
+    }
+}
+
+int TunerEngine::selectAdaptiveWindowSize()
+{
+    m_samples.resize(ADAPTIVE_PROBE_SIZE);
+    const qint16* data = m_accumulationBuffer.data();
+    for (int i = 0; i < ADAPTIVE_PROBE_SIZE; ++i) {
+        m_samples[i] = data[i] / 32768.0;
+    }
+
+    // Silence only needs a level update, keep the hop short
+    if (PitchDetector::levelDb(m_samples.data(), ADAPTIVE_PROBE_SIZE) <= m_dbThreshold) {
+        return ADAPTIVE_PROBE_SIZE;
+    }
+
+    m_detector.setSettings(detectorSettings());
+    double coarseFrequency = m_detector.coarsePitch(m_samples.data(), ADAPTIVE_PROBE_SIZE);
+    if (coarseFrequency <= 0) {
+        return std::clamp(m_bufferSize, ADAPTIVE_MIN_WINDOW, ADAPTIVE_MAX_WINDOW);
+    }
+
+    // Fixed number of periods, rounded up so only a few window tables get cached
+    int periodsLength = qCeil(ADAPTIVE_PERIODS * m_sampleRate / coarseFrequency);
+    int windowSize = ((periodsLength + ADAPTIVE_WINDOW_STEP - 1) / ADAPTIVE_WINDOW_STEP) * ADAPTIVE_WINDOW_STEP;
+    return std::clamp(windowSize, ADAPTIVE_MIN_WINDOW, ADAPTIVE_MAX_WINDOW);
+}
+
+void TunerEngine::processAccumulatedData(int windowSize, int hopSize)
+{
+    ++m_processedBlocks;
+
+    // Age of the newest sample in the window when its analysis starts
+    const qint64 analysisStartUSecs = monotonicUSecs();
+    const qint64 captureUSecs = captureTimeOf(m_sampleClock + windowSize - 1);
+    recordLatency(CaptureLatency, analysisStartUSecs - captureUSecs);
+
+    // Level and per-window detection happen in the DSP core
+    m_detector.setSettings(detectorSettings());
+    const qint16* data = m_accumulationBuffer.data();
+    PitchDetector::Result detection;
+    if (fixedPointActive()) {
+        // The integer pipeline reads the raw samples before they leave the buffer
+        detection = m_detector.analyze(reinterpret_cast<const int16_t*>(data), windowSize);
+    } else {
+        // Convert bytes to doubles
+        m_samples.resize(windowSize);
+        for (int i = 0; i < windowSize; ++i) {
+            m_samples[i] = data[i] / 32768.0; // Normalize to [-1, 1]
+        }
+        detection = m_detector.analyze(m_samples.data(), windowSize);
+    }
+
+    // Remove the processed data from the accumulation buffer, overlapping frames keep their tail
+    m_accumulationBuffer.consume(hopSize);
+    m_sampleClock += hopSize;
+
+    if (m_analysisWindowSize != windowSize) {
+        m_analysisWindowSize = windowSize;
+        emit analysisWindowSizeChanged();
+    }
+
+    // Streamed result for this window, filled in as the analysis goes
+    m_result = ResultRecord();
+    m_result.timestampUSecs = captureUSecs;
+
+    if (detection.spectrumValid) {
+        publishSpectrum();
+    }
+    if (detection.aboveThreshold) {
+        updatePeaks(m_detector.peaks());
+    }
+    updatePartials(detection);
+
+    // Emit signal level
+    double dbLevel = detection.levelDb;
+    m_result.levelDb = static_cast<float>(dbLevel);
     if (m_signalLevel != dbLevel) {
         m_signalLevel = dbLevel;
         emit signalLevelChanged();
         emit signalLevel(dbLevel);
     }
 
-    // Only process frequency if signal is above threshold
-    if (dbLevel > m_dbThreshold) {
-        double detectedFrequency;
-        
-        // Use selected detection method
-        if (m_detectionMethod == "FFT") {
-            detectedFrequency = detectFrequencyFFT(samples);
-        } else {
-            detectedFrequency = detectFrequencyAutocorrelation(samples);
-        }
+    updateStrobe(detection);
+
+    if (m_powerSave && m_idleMonitor.frameAnalyzed(hopSize, detection.aboveThreshold)) {
+        enterIdle();
+    }
 
-        if (detectedFrequency > 0) {
+    // The tracker only adds microseconds, its frames to lock show up in audio time instead
+    const qint64 resultUSecs = monotonicUSecs();
+    recordLatency(AnalysisLatency, resultUSecs - analysisStartUSecs);
+
+    if (!detection.aboveThreshold) {
+        m_pitchTracker.reset();
+        setPitchConfidence(0.0);
+        updateLockTime(QString(), false, false, hopSize);
+    } else {
+        // The tracker smooths per-frame detections and reports from the first frame
+        PitchTracker::Estimate estimate = m_pitchTracker.update(detection.frequency, detection.confidence);
+        double detectedFrequency = estimate.frequency;
+        setPitchConfidence(estimate.confidence);
+        m_result.confidence = static_cast<float>(estimate.confidence);
+        m_result.flags = estimate.locked ? ResultRecord::Locked : 0;
+
+        if (detectedFrequency <= 0) {
+            updateLockTime(QString(), false, true, hopSize);
+        } else {
             double cents;
             QString note = frequencyToNote(detectedFrequency, cents);
+            updateLockTime(note, estimate.locked, true, hopSize);
+            m_result.frequency = static_cast<float>(detectedFrequency);
+            m_result.cents = static_cast<float>(cents);
+            m_result.midiNote = static_cast<qint16>(m_noteTable.nearest(detectedFrequency).note);
+
+            if (m_sessionLog.isRecording()) {
+                SessionFrame frame;
+                frame.timestampUSecs = captureUSecs - m_sessionStartUSecs;
+                frame.frequency = m_result.frequency;
+                frame.cents = m_result.cents;
+                frame.levelDb = m_result.levelDb;
+                frame.confidence = m_result.confidence;
+                frame.midiNote = m_result.midiNote;
+                m_sessionLog.append(frame);
+            }
             
             // Update properties
             bool changed = false;
@@ -154,6 +811,12 @@ void TunerEngine::processAccumulatedData()
             
             if (changed) {
                 emit noteDetected(note, detectedFrequency, cents);
+
+                // QML bindings run synchronously in the emits above
+                const qint64 propertiesUSecs = monotonicUSecs();
+                recordLatency(PropertiesLatency, propertiesUSecs - resultUSecs);
+                m_pendingFrameCaptureUSecs = captureUSecs;
+                m_pendingFramePropertiesUSecs = propertiesUSecs;
             }
             
             // Add detailed debug output
@@ -173,47 +836,67 @@ void TunerEngine::processAccumulatedData()
             }
         }
     }
+
+    if (m_resultServer.isRunning()) {
+        m_result.sequence = m_resultSequence++;
+        m_resultServer.publish(m_result);
+    }
+    publishSnapshot(false);
+
+    reportLatency(monotonicUSecs());
 }
 
-double TunerEngine::calculateDBFS(const QVector<double>& samples)
+void TunerEngine::updateLockTime(const QString& note, bool detected, bool aboveThreshold, int newSamples)
 {
-    if (samples.isEmpty()) return -90.0; // Return minimal level if no samples
+    if (!aboveThreshold) {
+        m_onsetSample = -1;
+        m_locked = false;
+        return;
+    }
 
-    // Calculate RMS (Root Mean Square)
-    double sum = 0.0;
-    for (double sample : samples) {
-        sum += sample * sample;
+    // Onset is the start of the new samples in the first block above threshold
+    if (m_onsetSample < 0) {
+        m_onsetSample = m_sampleClock - newSamples;
     }
-    double rms = std::sqrt(sum / samples.size());
 
-    // Convert to dBFS (0 dBFS = maximum level = 1.0)
-    double dbFS = 20 * std::log10(rms);
-    
-    // Clamp the lower bound to -90 dB
-    return std::max(dbFS, -90.0);
+    if (detected && !m_locked) {
+        m_locked = true;
+        m_lastLockTime = (m_sampleClock - m_onsetSample) * 1000.0 / m_sampleRate;
+        m_lockTimes[note] = m_lastLockTime;
+        emit lockTimeChanged();
+        qDebug() << "Time to lock on" << note << ":" << QString::number(m_lastLockTime, 'f', 1) << "ms"
+                 << (m_adaptiveWindow ? "(adaptive window)" : "(fixed window)");
+    }
 }
 
-void TunerEngine::updatePeaks(const QVector<Peak>& peaks)
+void TunerEngine::updatePeaks(const std::vector<PitchDetector::Peak>& peaks)
 {
     m_peaks.clear();
-    qsizetype count = std::min(peaks.size(), static_cast<qsizetype>(m_maxPeaks));
+    int count = std::min(static_cast<int>(peaks.size()), m_maxPeaks);
     
-    if (peaks.isEmpty()) {
+    if (peaks.empty()) {
         emit peaksChanged();
         return;
     }
     
     // Find maximum amplitude for normalization
     double maxAmplitude = 0.0;
-    for (const Peak& peak : peaks) {
+    for (const PitchDetector::Peak& peak : peaks) {
         maxAmplitude = std::max(maxAmplitude, peak.amplitude);
     }
     
     // Avoid division by zero
     if (maxAmplitude <= 0.0) maxAmplitude = 1.0;
     
+    // The result stream carries the first MAX_PEAKS of them
+    m_result.peakCount = static_cast<quint8>(std::min(count, ResultRecord::MAX_PEAKS));
+    for (int i = 0; i < m_result.peakCount; ++i) {
+        m_result.peaks[i].frequency = static_cast<float>(peaks[i].frequency);
+        m_result.peaks[i].amplitude = static_cast<float>(peaks[i].amplitude / maxAmplitude);
+    }
+
     // Add normalized peaks to the list
-    for (qsizetype i = 0; i < count; ++i) {
+    for (int i = 0; i < count; ++i) {
         QVariantMap peak;
         peak["frequency"] = peaks[i].frequency;
         // Normalize amplitude to [0,1] range
@@ -225,139 +908,236 @@ void TunerEngine::updatePeaks(const QVector<Peak>& peaks)
     emit peaksChanged();
 }
 
-double TunerEngine::detectFrequencyAutocorrelation(const QVector<double>& samples)
+void TunerEngine::updatePartials(const PitchDetector::Result &detection)
 {
-    int maxPeriod = m_sampleRate / 50;  // Minimum frequency of 50 Hz
-    int minPeriod = m_sampleRate / 1500; // Maximum frequency around 1500 Hz
+    // Silence and the integer pipeline leave no tracks, one last emit clears the view
+    const bool hadPartials = !m_partials.isEmpty();
+    m_partials.clear();
+    const auto &partials = m_detector.partialTracker().partials();
+    for (int i = 0; i < static_cast<int>(partials.size()); ++i) {
+        if (!partials[i].active) continue;
+        QVariantMap partial;
+        partial["harmonic"] = i + 1;
+        partial["frequency"] = partials[i].frequency;
+        partial["amplitude"] = partials[i].amplitude;
+        partial["deviationCents"] = partials[i].deviationCents;
+        partial["unstable"] = partials[i].unstable;
+        m_partials.append(partial);
+    }
+    if (m_partials.isEmpty() && !hadPartials) return;
 
-    QVector<Peak> peaks;
+    m_inharmonicity = m_partials.isEmpty() ? 0.0 : detection.inharmonicity;
+    if (m_wolfTone != (detection.wolfTone && !m_partials.isEmpty())) {
+        m_wolfTone = !m_wolfTone;
+        qDebug() << (m_wolfTone ? "Wolf tone on" : "Wolf tone gone") << m_currentNote;
+    }
+    emit partialsChanged();
+}
 
-    // Find correlation peaks
-    double lastCorrelation = 0;
-    bool rising = false;
-    
-    for (int period = minPeriod; period <= maxPeriod; ++period) {
-        double correlation = 0;
-        int validSamples = 0;
-
-        // Normalized autocorrelation
-        for (int i = 0; i < m_bufferSize - period; ++i) {
-            correlation += samples[i] * samples[i + period];
-            validSamples++;
-        }
+QString TunerEngine::frequencyToNote(double frequency, double& cents)
+{
+    NoteTable::Match match = m_noteTable.nearest(frequency);
+    cents = match.cents;
+    return noteNameTable().at(match.note);
+}
 
-        // Normalize by the number of samples
-        if (validSamples > 0) {
-            correlation /= validSamples;
-        }
+void TunerEngine::rebuildNoteTable()
+{
+    Temperament temperament = Temperament::Equal;
+    if (m_temperament == "Pythagorean") {
+        temperament = Temperament::Pythagorean;
+    } else if (m_temperament == "Just") {
+        temperament = Temperament::Just;
+    } else if (m_temperament == "Custom") {
+        temperament = Temperament::Custom;
+    }
+    m_noteTable.build(m_referenceA, temperament, m_temperamentRoot, m_customCents);
+    updateToneFrequencies();
+}
 
-        // Detect peaks
-        if (rising && correlation < lastCorrelation) {
-            // We just passed a peak
-            double frequency = static_cast<double>(m_sampleRate) / (period - 1);
-            peaks.append({frequency, std::abs(lastCorrelation), 0});
-            rising = false;
-        } else if (correlation > lastCorrelation) {
-            rising = true;
+void TunerEngine::setToneEnabled(bool enabled)
+{
+    if (m_toneEnabled == enabled) return;
+    m_toneEnabled = enabled;
+    m_toneGenerator.oscillator().setGate(enabled);
+    if (enabled) {
+        startToneOutput();
+    } else {
+        // Let the fade out play, then give the output device back
+        QTimer::singleShot(TONE_FADE_MS + TONE_BUFFER_USECS / 1000 * 2, this, &TunerEngine::stopIdleToneOutput);
+    }
+    emit toneChanged();
+}
+
+void TunerEngine::setToneNote(int midiNote)
+{
+    midiNote = std::clamp(midiNote, NoteTable::FIRST_NOTE, NoteTable::FIRST_NOTE + NoteTable::NOTE_COUNT - 1 - TONE_FIFTH);
+    if (m_toneNote != midiNote) {
+        m_toneNote = midiNote;
+        updateToneFrequencies();
+    }
+}
+
+QString TunerEngine::toneNoteName() const
+{
+    return noteNameTable().at(m_toneNote);
+}
+
+void TunerEngine::setToneFifth(bool enabled)
+{
+    if (m_toneFifth != enabled) {
+        m_toneFifth = enabled;
+        updateToneFrequencies();
+    }
+}
+
+void TunerEngine::setToneTimbre(const QString &timbre)
+{
+    if (m_toneTimbre == timbre) return;
+    for (const ToneTimbre &entry : TONE_TIMBRES) {
+        if (timbre == QLatin1String(entry.name)) {
+            m_toneTimbre = timbre;
+            m_toneGenerator.oscillator().setTimbre(entry.timbre);
+            emit toneChanged();
+            return;
         }
+    }
+    qWarning() << "Unknown tone timbre" << timbre;
+}
 
-        lastCorrelation = correlation;
+QStringList TunerEngine::toneTimbres() const
+{
+    QStringList names;
+    for (const ToneTimbre &entry : TONE_TIMBRES) {
+        names.append(QString::fromLatin1(entry.name));
     }
+    return names;
+}
 
-    if (peaks.isEmpty()) {
-        updatePeaks(QVector<Peak>());
-        return 0;
+void TunerEngine::setToneVolume(double volume)
+{
+    volume = std::clamp(volume, 0.0, 1.0);
+    if (m_toneVolume != volume) {
+        m_toneVolume = volume;
+        m_toneGenerator.oscillator().setLevel(volume);
+        emit toneChanged();
     }
+}
 
-    // Sort peaks by correlation strength initially
-    std::sort(peaks.begin(), peaks.end(), 
-              [](const Peak& a, const Peak& b) { return a.amplitude > b.amplitude; });
+void TunerEngine::updateToneFrequencies()
+{
+    // The oscillator ramps between pitches on its own, nothing here touches the audio thread
+    WavetableOscillator &oscillator = m_toneGenerator.oscillator();
+    oscillator.setFrequency(0, m_noteTable.centerFrequency(m_toneNote));
+    oscillator.setFrequency(1, m_toneFifth ? m_noteTable.centerFrequency(m_toneNote + TONE_FIFTH) : 0.0);
+    emit toneChanged();
+}
 
-    // Take top peaks
-    QVector<Peak> topPeaks;
-    for (int i = 0; i < std::min(5, (int)peaks.size()); ++i) {
-        topPeaks.append(peaks[i]);
+void TunerEngine::startToneOutput()
+{
+    if (!m_openAudioInput) {
+        // Mono int16 at the analysis rate, what SyntheticSource::setGenerator() expects
+        if (m_toneGenerator.format().sampleRate() != m_sampleRate) {
+            QAudioFormat format;
+            format.setSampleRate(m_sampleRate);
+            format.setChannelCount(1);
+            format.setSampleFormat(QAudioFormat::Int16);
+            m_toneGenerator.setFormat(format);
+        }
+        return;
     }
+    if (m_toneSink) {
+        if (m_toneSink->state() == QAudio::StoppedState) m_toneSink->start(&m_toneGenerator);
+        return;
+    }
+    if (m_outputProbing) return;
+
+    // Enumerating devices is slow on some backends, like the input probe it stays off the GUI thread
+    m_outputProbing = true;
+    m_backgroundPool.start([this]() {
+        QAudioDevice device = QMediaDevices::defaultAudioOutput();
+        QMetaObject::invokeMethod(this, [this, device]() {
+            onAudioOutputProbed(device);
+        }, Qt::QueuedConnection);
+    });
+}
 
-    // Sort by frequency to analyze harmonics
-    std::sort(topPeaks.begin(), topPeaks.end(),
-              [](const Peak& a, const Peak& b) { return a.frequency < b.frequency; });
+void TunerEngine::onAudioOutputProbed(const QAudioDevice &device)
+{
+    m_outputProbing = false;
+    if (device.isNull()) {
+        qWarning() << "No audio output for the reference tone";
+        return;
+    }
 
-    // Analyze harmonics for each peak
-    for (Peak& fundamental : topPeaks) {
-        analyzeHarmonics(fundamental, topPeaks);
+    QAudioFormat format = device.preferredFormat();
+    format.setSampleFormat(QAudioFormat::Float);
+    if (!device.isFormatSupported(format)) format.setSampleFormat(QAudioFormat::Int16);
+    if (!device.isFormatSupported(format)) {
+        qWarning() << "Audio output supports neither float nor int16, no reference tone";
+        return;
     }
 
-    // Update peaks for visualization
-    updatePeaks(topPeaks);
+    // The sink does not exist yet, so nothing pulls while the tables are built
+    m_toneGenerator.setFormat(format);
+    m_toneSink = new QAudioSink(device, format, this);
+    m_toneSink->setBufferSize(format.bytesForDuration(TONE_BUFFER_USECS));
+    if (!m_toneGenerator.isOpen()) m_toneGenerator.open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    if (m_toneEnabled) m_toneSink->start(&m_toneGenerator);
+}
 
-    // Find the peak with the most harmonics
-    // If multiple peaks have the same number of harmonics, take the lowest frequency
-    Peak* bestPeak = nullptr;
-    for (Peak& peak : topPeaks) {
-        if (!bestPeak || 
-            peak.harmonicCount > bestPeak->harmonicCount || 
-            (peak.harmonicCount == bestPeak->harmonicCount && peak.frequency < bestPeak->frequency)) {
-            bestPeak = &peak;
-        }
+void TunerEngine::stopIdleToneOutput()
+{
+    // Re-enabled during the fade out, keep playing
+    if (!m_toneEnabled && m_toneSink) m_toneSink->stop();
+}
+
+void TunerEngine::setTemperament(const QString &temperament)
+{
+    if (m_temperament != temperament) {
+        m_temperament = temperament;
+        requestRebuild(RebuildNoteTable);
+        emit temperamentChanged();
     }
+}
 
-    return bestPeak ? bestPeak->frequency : 0;
+void TunerEngine::setTemperamentRoot(int pitchClass)
+{
+    pitchClass = ((pitchClass % 12) + 12) % 12;
+    if (m_temperamentRoot != pitchClass) {
+        m_temperamentRoot = pitchClass;
+        requestRebuild(RebuildNoteTable);
+        emit temperamentChanged();
+    }
 }
 
-void TunerEngine::analyzeHarmonics(Peak& fundamental, const QVector<Peak>& peaks) {
-    int harmonicCount = 0;
-    double harmonicStrength = 0;
-    
-    // Expected harmonic ratios for string instruments
-    const double expectedHarmonics[] = {2.0, 3.0, 4.0, 5.0, 6.0};
-    
-    for (const Peak& peak : peaks) {
-        if (peak.frequency > fundamental.frequency) {
-            double ratio = peak.frequency / fundamental.frequency;
-            
-            // Check against expected harmonics
-            for (double expected : expectedHarmonics) {
-                if (std::abs(ratio - expected) < 0.03) { // 3% tolerance
-                    harmonicCount++;
-                    // Higher harmonics contribute less
-                    harmonicStrength += peak.amplitude / expected;
-                    break;
-                }
-            }
-        }
+QVariantList TunerEngine::customCents() const
+{
+    QVariantList cents;
+    for (double offset : m_customCents) {
+        cents.append(offset);
     }
-    
-    fundamental.harmonicCount = harmonicCount;
-    fundamental.harmonicStrength = harmonicStrength;
+    return cents;
 }
 
-QString TunerEngine::frequencyToNote(double frequency, double& cents)
+void TunerEngine::setCustomCents(const QVariantList &cents)
 {
-    static const QStringList noteNames = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
-    
-    // Calculate number of half steps from A4 using the reference frequency
-    double halfSteps = 12 * log2(frequency / m_referenceA);
-    
-    // Round to nearest note
-    int roundedHalfSteps = qRound(halfSteps);
-    
-    // Calculate cents deviation
-    cents = 100 * (halfSteps - roundedHalfSteps);
-    
-    // Calculate note index and octave
-    int noteIndex = (roundedHalfSteps + 9) % 12; // +9 because A is at index 9
-    if (noteIndex < 0) noteIndex += 12;
-    
-    int octave = 4 + (roundedHalfSteps + 9) / 12;
-    
-    return noteNames[noteIndex] + QString::number(octave);
+    std::array<double, 12> offsets{};
+    for (int i = 0; i < std::min<int>(12, cents.size()); ++i) {
+        offsets[i] = cents[i].toDouble();
+    }
+    if (m_customCents != offsets) {
+        m_customCents = offsets;
+        requestRebuild(RebuildNoteTable);
+        emit temperamentChanged();
+    }
 }
 
 void TunerEngine::setDbThreshold(double threshold)
 {
     if (m_dbThreshold != threshold) {
         m_dbThreshold = threshold;
+        configureIdleMonitor();
         emit dbThresholdChanged();
     }
 }
@@ -366,10 +1146,7 @@ void TunerEngine::setSampleRate(int rate)
 {
     if (m_sampleRate != rate) {
         m_sampleRate = rate;
-        // Reconfigure audio input with new sample rate
-        stop();
-        setupAudioInput();
-        start();
+        requestRebuild(RebuildAudio);
         emit sampleRateChanged();
     }
 }
@@ -378,14 +1155,26 @@ void TunerEngine::setBufferSize(int size)
 {
     if (m_bufferSize != size) {
         m_bufferSize = size;
-        // Resize FFT buffer
-        m_fftBuffer.resize(size);
-        // Clear accumulation buffer to avoid processing with wrong size
-        m_accumulationBuffer.clear();
+        requestRebuild(RebuildAnalysis);
         emit bufferSizeChanged();
     }
 }
 
+void TunerEngine::setDeviceBufferSize(int samples)
+{
+    samples = std::clamp(samples, 0, MAX_DEVICE_BUFFER_SIZE);
+    if (m_deviceBufferSize != samples) {
+        m_deviceBufferSize = samples;
+        requestRebuild(RebuildAudio);
+        emit deviceBufferSizeChanged();
+    }
+}
+
+int TunerEngine::actualDeviceBufferSize() const
+{
+    return m_audioSource && m_audioDevice ? static_cast<int>(m_audioSource->bufferSize() / 2) : 0;
+}
+
 void TunerEngine::setMaxPeaks(int peaks)
 {
     if (m_maxPeaks != peaks) {
@@ -398,220 +1187,461 @@ void TunerEngine::setReferenceA(double freq)
 {
     if (m_referenceA != freq) {
         m_referenceA = freq;
+        requestRebuild(RebuildNoteTable);
         emit referenceAChanged();
     }
 }
 
-void TunerEngine::applyHannWindow(QVector<double>& samples)
+PitchDetector::Settings TunerEngine::detectorSettings() const
 {
-    for (int i = 0; i < samples.size(); i++) {
-        double window = 0.5 * (1 - cos(2 * M_PI * i / (samples.size() - 1)));
-        samples[i] *= window;
+    PitchDetector::Settings settings;
+    settings.sampleRate = m_sampleRate;
+    settings.fftPadding = m_fftPadding;
+    // Adaptive windows vary in length, those stay on power-of-two plans so few sizes get cached
+    settings.powerOfTwoPadding = m_adaptiveWindow || fixedPointActive();
+    settings.method = m_method;
+    settings.dbThreshold = m_dbThreshold;
+    settings.maxPeaks = m_maxPeaks;
+
+    // The profile is tuned to A4 = 440 Hz, bands follow the reference
+    const InstrumentProfile &profile = instrumentProfile();
+    const double scale = m_referenceA / 440.0;
+    settings.minFrequency = profile.minFrequency * scale;
+    settings.maxFrequency = profile.maxFrequency * scale;
+    if (m_targetString >= 0) {
+        double open = profile.strings[m_targetString].frequency * scale;
+        settings.minFrequency = InstrumentProfile::stringMinFrequency(open);
+        settings.maxFrequency = InstrumentProfile::stringMaxFrequency(open);
     }
+    settings.harmonicWeights = profile.harmonicWeights;
+
+    if (m_strobeMode) {
+        // The phase advance replaces zero padding for precision
+        settings.fftPadding = 1;
+        settings.phaseHop = STROBE_HOP;
+    }
+    return settings;
 }
 
-void TunerEngine::performFFT(QVector<std::complex<double>>& data)
+void TunerEngine::setPowerSave(bool enabled)
 {
-    int n = data.size();
-    if (n <= 1) return;
+    if (m_powerSave != enabled) {
+        m_powerSave = enabled;
+        if (!enabled && m_idleMonitor.isIdle()) {
+            m_idleMonitor.reset();
+            emit idleChanged();
+        }
+        emit powerSaveChanged();
+    }
+}
 
-    // Separate even and odd elements
-    QVector<std::complex<double>> even(n/2);
-    QVector<std::complex<double>> odd(n/2);
-    for (int i = 0; i < n/2; i++) {
-        even[i] = data[2*i];
-        odd[i] = data[2*i+1];
+void TunerEngine::setIdleDelay(double seconds)
+{
+    seconds = std::max(1.0, seconds);
+    if (m_idleDelay != seconds) {
+        m_idleDelay = seconds;
+        configureIdleMonitor();
+        emit powerSaveChanged();
     }
+}
 
-    // Recursive FFT on even and odd parts
-    performFFT(even);
-    performFFT(odd);
+QVariantMap TunerEngine::powerStats() const
+{
+    auto perSecond = [this](const PowerCounter &counter) {
+        return counter.samples > 0 ? counter.cpuNsecs / 1.0e6 * m_sampleRate / counter.samples : 0.0;
+    };
+    QVariantMap stats;
+    stats["activeCpuMsPerSecond"] = perSecond(m_activePower);
+    stats["idleCpuMsPerSecond"] = perSecond(m_idlePower);
+    stats["activeSeconds"] = static_cast<double>(m_activePower.samples) / m_sampleRate;
+    stats["idleSeconds"] = static_cast<double>(m_idlePower.samples) / m_sampleRate;
+    return stats;
+}
+
+void TunerEngine::resetPowerStats()
+{
+    m_activePower = PowerCounter();
+    m_idlePower = PowerCounter();
+}
 
-    // Combine results
-    for (int k = 0; k < n/2; k++) {
-        double angle = -2 * M_PI * k / n;
-        std::complex<double> t = std::polar(1.0, angle) * odd[k];
-        data[k] = even[k] + t;
-        data[k + n/2] = even[k] - t;
+void TunerEngine::pushChunkTime(qint64 endSample, qint64 captureUSecs)
+{
+    // Only writes under MIN_CHUNK_SAMPLES fill it up; the newest entry then
+    // takes this chunk too and its earlier samples are dated back from here
+    if (m_chunkTimeCount == CHUNK_TIME_CAPACITY) {
+        chunkTime(m_chunkTimeCount - 1) = {endSample, captureUSecs};
+        return;
     }
+    chunkTime(m_chunkTimeCount++) = {endSample, captureUSecs};
 }
 
-double TunerEngine::detectFrequencyFFT(const QVector<double>& samples)
+qint64 TunerEngine::captureTimeOf(qint64 sample) const
 {
-    // Create a copy for windowing
-    QVector<double> windowed = samples;
-    applyHannWindow(windowed);
+    for (int i = 0; i < m_chunkTimeCount; ++i) {
+        const ChunkTime &chunk = chunkTime(i);
+        if (chunk.endSample > sample) {
+            return chunk.captureUSecs - (chunk.endSample - 1 - sample) * 1000000 / m_sampleRate;
+        }
+    }
+    return monotonicUSecs();
+}
 
-    // Zero padding for better frequency resolution
-    int paddedSize = m_bufferSize * m_fftPadding;  // Use padding factor
-    m_fftBuffer.resize(paddedSize);
-    
-    // Copy samples and pad with zeros
-    for (int i = 0; i < paddedSize; i++) {
-        m_fftBuffer[i] = i < samples.size() ? 
-            std::complex<double>(windowed[i], 0) : 
-            std::complex<double>(0, 0);
+void TunerEngine::recordLatency(LatencyStage stage, qint64 usecs)
+{
+    m_latency[stage].add(usecs);
+}
+
+void TunerEngine::reportLatency(qint64 now)
+{
+    if (now - m_latencyReportUSecs < LATENCY_REPORT_INTERVAL_USECS) return;
+    m_latencyReportUSecs = now;
+    emit latencyStatsChanged();
+    emit backlogStatsChanged();
+
+    if (now - m_latencyLogUSecs >= LATENCY_LOG_INTERVAL_USECS) {
+        m_latencyLogUSecs = now;
+        for (int stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+            if (m_latency[stage].count() == 0) continue;
+            qInfo().noquote() << "Latency" << latencyStageNames[stage] << m_latency[stage].summary();
+        }
+        if (m_droppedBlocks > 0) {
+            qInfo() << "Backlog:" << m_droppedBlocks << "stale blocks dropped, watermark" << m_maxBacklogBlocks << "blocks";
+        }
     }
+}
 
-    // Perform FFT
-    performFFT(m_fftBuffer);
+void TunerEngine::frameRendered(qint64 usecs)
+{
+    // The first frame swapped after the properties changed is the one showing them
+    if (m_pendingFramePropertiesUSecs < 0 || usecs < m_pendingFramePropertiesUSecs) return;
+    recordLatency(RenderLatency, usecs - m_pendingFramePropertiesUSecs);
+    recordLatency(TotalLatency, usecs - m_pendingFrameCaptureUSecs);
+    m_pendingFrameCaptureUSecs = -1;
+    m_pendingFramePropertiesUSecs = -1;
+    reportLatency(usecs);
+}
 
-    // Calculate frequency step size
-    double freqStep = static_cast<double>(m_sampleRate) / paddedSize;
-    qDebug() << "FFT frequency resolution:" << freqStep << "Hz";
+QVariantMap TunerEngine::latencyStats() const
+{
+    QVariantMap stats;
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+        stats[latencyStageNames[stage]] = m_latency[stage].toVariantMap();
+    }
+    return stats;
+}
 
-    // Calculate magnitude spectrum and find peaks
-    QVector<Peak> peaks;
-    double maxMagnitude = 0;
-    
-    // Only look at the meaningful part of the spectrum
-    for (int i = 1; i < paddedSize/2 - 1; i++) {
-        double magnitude = std::abs(m_fftBuffer[i]);
-        double frequency = i * freqStep;
-        
-        // Only consider frequencies in our range of interest (50Hz to 1500Hz)
-        if (frequency >= 50 && frequency <= 1500) {
-            // Look for peaks in the spectrum
-            if (magnitude > std::abs(m_fftBuffer[i-1]) && 
-                magnitude > std::abs(m_fftBuffer[i+1])) {
-                
-                // Quadratic interpolation for better frequency precision
-                double alpha = std::abs(m_fftBuffer[i-1]);
-                double beta = magnitude;
-                double gamma = std::abs(m_fftBuffer[i+1]);
-                double p = 0.5 * (alpha - gamma) / (alpha - 2*beta + gamma);
-                
-                // Refined frequency
-                double refinedFreq = (i + p) * freqStep;
-                
-                peaks.append({refinedFreq, magnitude, 0, 0}); // Initialize harmonicStrength to 0
-                maxMagnitude = std::max(maxMagnitude, magnitude);
-            }
+void TunerEngine::resetLatencyStats()
+{
+    for (LatencyHistogram &histogram : m_latency) histogram.reset();
+    m_pendingFrameCaptureUSecs = -1;
+    m_pendingFramePropertiesUSecs = -1;
+    emit latencyStatsChanged();
+}
+
+void TunerEngine::setBacklogPolicy(const QString &policy)
+{
+    if (m_backlogPolicyName == policy) return;
+    for (const BacklogPolicyName &entry : BACKLOG_POLICIES) {
+        if (policy == QLatin1String(entry.name)) {
+            m_backlogPolicyName = policy;
+            m_backlogPolicy = entry.policy;
+            emit backlogPolicyChanged();
+            return;
         }
     }
+    qWarning() << "Unknown backlog policy" << policy;
+}
 
-    if (peaks.isEmpty()) {
-        updatePeaks(QVector<Peak>());
-        return 0;
+QStringList TunerEngine::backlogPolicies() const
+{
+    QStringList names;
+    for (const BacklogPolicyName &entry : BACKLOG_POLICIES) {
+        names.append(QString::fromLatin1(entry.name));
     }
+    return names;
+}
+
+QVariantMap TunerEngine::backlogStats() const
+{
+    QVariantMap stats;
+    stats["processedBlocks"] = m_processedBlocks;
+    stats["droppedBlocks"] = m_droppedBlocks;
+    stats["maxBacklogBlocks"] = m_maxBacklogBlocks;
+    stats["maxBacklogMs"] = m_maxBacklogSamples * 1000.0 / m_sampleRate;
+    return stats;
+}
+
+void TunerEngine::resetBacklogStats()
+{
+    m_processedBlocks = 0;
+    m_droppedBlocks = 0;
+    m_maxBacklogBlocks = 0;
+    m_maxBacklogSamples = 0;
+    emit backlogStatsChanged();
+}
+
+int TunerEngine::suggestedBufferSize(int bufferSize) const
+{
+    return FftPlan::nextFastSize(bufferSize);
+}
 
-    // Sort peaks by magnitude
-    std::sort(peaks.begin(), peaks.end(),
-              [](const Peak& a, const Peak& b) { return a.amplitude > b.amplitude; });
+void TunerEngine::updateStrobe(const PitchDetector::Result &detection)
+{
+    bool active = detection.phaseRefined;
+    if (active) {
+        // Integrated phase error against the nearest note, like a strobe disc
+        // lit at the note's frequency: still when in tune, turning when off
+        double target = m_noteTable.nearest(detection.frequency).centerFrequency;
+        m_strobePhase += m_detector.phaseError(target);
+        m_strobePhase -= std::floor(m_strobePhase);
+    }
+    if (active || m_strobeActive) {
+        m_strobeActive = active;
+        emit strobeChanged();
+    }
+}
 
-    // Take top peaks
-    QVector<Peak> topPeaks;
-    for (int i = 0; i < std::min(5, (int)peaks.size()); i++) {
-        Peak normalizedPeak = peaks[i];
-        normalizedPeak.amplitude /= maxMagnitude; // Normalize amplitude
-        topPeaks.append(normalizedPeak);
+void TunerEngine::publishSpectrum()
+{
+    double freqStep = m_detector.binWidth();
+
+    // Renderers only get snapshots through m_spectrum on this thread, one the
+    // pool alone holds stays free. When renderers hold them all, they keep
+    // theirs and the pool takes a new one in its place
+    std::shared_ptr<SpectrumSnapshot> *slot = nullptr;
+    for (auto &pooled : m_spectrumPool) {
+        if (pooled.use_count() == 1) {
+            slot = &pooled;
+            break;
+        }
+    }
+    if (!slot) {
+        slot = &m_spectrumPool[m_spectrumPoolNext];
+        m_spectrumPoolNext = (m_spectrumPoolNext + 1) % SPECTRUM_POOL_SIZE;
+        *slot = std::make_shared<SpectrumSnapshot>();
     }
+    SpectrumSnapshot *snapshot = slot->get();
+    int binCount = std::min(m_detector.spectrumSize() / 2, static_cast<int>(SPECTRUM_MAX_FREQUENCY / freqStep) + 1);
+    snapshot->magnitudes.resize(binCount);
+    m_detector.magnitudes(snapshot->magnitudes.data(), binCount);
+    snapshot->binWidth = freqStep;
+    snapshot->frameIndex = ++m_spectrumFrameIndex;
+
+    // Readers of result snapshots use the ring in place, so a copy here spares one per reader
+    const int ringBins = std::min(binCount, m_spectrumRing.capacity());
+    m_spectrumTicket = m_spectrumRing.write(snapshot->magnitudes.data(), ringBins);
+    m_spectrumTicketBinWidth = freqStep;
+
+    m_spectrum = *slot;
+    emit spectrumUpdated();
+}
 
-    // Sort by frequency to analyze harmonics
-    std::sort(topPeaks.begin(), topPeaks.end(),
-              [](const Peak& a, const Peak& b) { return a.frequency < b.frequency; });
+void TunerEngine::publishSnapshot(bool idle)
+{
+    ResultSnapshot snapshot;
+    snapshot.frameIndex = m_snapshot.version() + 1;
+    snapshot.timestampUSecs = m_result.timestampUSecs;
+    snapshot.frequency = m_result.frequency;
+    snapshot.cents = m_result.cents;
+    snapshot.levelDb = m_result.levelDb;
+    snapshot.confidence = m_result.confidence;
+    snapshot.midiNote = m_result.midiNote;
+    snapshot.locked = m_result.flags & ResultRecord::Locked;
+    snapshot.idle = idle;
+    snapshot.peakCount = m_result.peakCount;
+    snapshot.peaks = m_result.peaks;
+    snapshot.spectrum = m_spectrumTicket;
+    snapshot.binWidth = m_spectrumTicketBinWidth;
+    m_snapshot.store(snapshot);
+}
 
-    // Analyze harmonics for each peak
-    for (Peak& fundamental : topPeaks) {
-        analyzeHarmonics(fundamental, topPeaks);
+void TunerEngine::setPitchConfidence(double confidence)
+{
+    if (m_pitchConfidence != confidence) {
+        m_pitchConfidence = confidence;
+        emit pitchConfidenceChanged();
     }
+}
 
-    // Update peaks for visualization
-    updatePeaks(topPeaks);
+void TunerEngine::setDetectionMethod(const QString &method)
+{
+    if (m_detectionMethod == method) return;
+    for (const DetectionMethod &entry : DETECTION_METHODS) {
+        if (method == QLatin1String(entry.name)) {
+            m_detectionMethod = method;
+            m_method = entry.method;
+            // The lag domain methods pad further, see PitchDetector::paddedSize()
+            requestRebuild(RebuildAnalysis);
+            emit detectionMethodChanged();
+            return;
+        }
+    }
+    qWarning() << "Unknown detection method" << method << "expected one of" << detectionMethods();
+}
 
-    // Use the new peak selection method
-    Peak* bestPeak = selectBestPeak(topPeaks);
-    if (bestPeak) {
-        // Apply frequency stability check
-        return getStableFrequency(bestPeak->frequency, calculateNoteProbability(*bestPeak));
+QStringList TunerEngine::detectionMethods() const
+{
+    QStringList names;
+    for (const DetectionMethod &entry : DETECTION_METHODS) {
+        names.append(QString::fromLatin1(entry.name));
     }
+    return names;
+}
 
-    return 0;
+bool TunerEngine::fixedPointActive() const
+{
+    // The Q15 path only has spectral peaks and a time-domain autocorrelation
+    return m_fixedPoint && !m_strobeMode &&
+           (m_method == PitchDetector::Method::Fft || m_method == PitchDetector::Method::Autocorrelation);
 }
 
-double TunerEngine::getNearestNoteFrequency(double frequency) const {
-    // A4 = 440Hz is our reference
-    double halfSteps = 12 * std::log2(frequency / m_referenceA);
-    int roundedHalfSteps = qRound(halfSteps);
-    return m_referenceA * std::pow(2, roundedHalfSteps / 12.0);
+void TunerEngine::setAdaptiveWindow(bool enabled)
+{
+    if (m_adaptiveWindow != enabled) {
+        m_adaptiveWindow = enabled;
+        requestRebuild(RebuildAnalysis);
+        emit adaptiveWindowChanged();
+    }
 }
 
-double TunerEngine::calculateNoteProbability(const Peak& peak) const {
-    double probability = 0.0;
-    
-    // Base probability from harmonic count
-    probability += peak.harmonicCount * 0.2;
-    
-    // Add harmonic strength contribution
-    probability += std::min(peak.harmonicStrength, 0.3);
-    
-    // Check proximity to standard note frequencies
-    double noteFreq = getNearestNoteFrequency(peak.frequency);
-    double centsDiff = std::abs(1200 * std::log2(peak.frequency / noteFreq));
-    if (centsDiff < 50) { // Within 50 cents
-        probability += 0.3 * (1.0 - centsDiff / 50.0);
+const InstrumentProfile &TunerEngine::instrumentProfile() const
+{
+    return ::instrumentProfile(m_instrument.toStdString());
+}
+
+int TunerEngine::targetWindowSize() const
+{
+    if (m_targetString < 0) return m_bufferSize;
+
+    // Periods of the lowest pitch in the string's band, on a 2/3/5-smooth length so padding stays fast
+    double open = instrumentProfile().strings[m_targetString].frequency * m_referenceA / 440.0;
+    int periodsLength = qCeil(TARGET_STRING_PERIODS * m_sampleRate / InstrumentProfile::stringMinFrequency(open));
+    int windowSize = ((periodsLength + ADAPTIVE_WINDOW_STEP - 1) / ADAPTIVE_WINDOW_STEP) * ADAPTIVE_WINDOW_STEP;
+    while (FftPlan::nextFastSize(windowSize) != windowSize) {
+        windowSize += ADAPTIVE_WINDOW_STEP;
     }
-    
-    return std::min(probability, 1.0);
+    return std::clamp(windowSize, ADAPTIVE_MIN_WINDOW, ADAPTIVE_MAX_WINDOW);
 }
 
-Peak* TunerEngine::selectBestPeak(QVector<Peak>& peaks) {
-    Peak* bestPeak = nullptr;
-    double bestScore = 0;
-    
-    for (Peak& peak : peaks) {
-        // Calculate base score from harmonics
-        double score = peak.harmonicCount * 2.0;
-        
-        // Add probability score
-        score += calculateNoteProbability(peak) * 3.0;
-        
-        // Prefer lower frequencies (fundamental over harmonics)
-        score += 1.0 / (1.0 + peak.frequency / 440.0);
-        
-        // Amplitude contribution (smaller weight)
-        score += peak.amplitude * 0.5;
-        
-        if (!bestPeak || score > bestScore) {
-            bestPeak = &peak;
-            bestScore = score;
-        }
+QStringList TunerEngine::instruments() const
+{
+    QStringList names;
+    for (const InstrumentProfile &profile : INSTRUMENT_PROFILES) {
+        names.append(QString::fromUtf8(profile.name.data(), profile.name.size()));
     }
-    
-    // Only return if we're confident enough
-    return (bestScore > 2.0) ? bestPeak : nullptr;
+    return names;
 }
 
-double TunerEngine::getStableFrequency(double newFreq, double confidence) {
-    if (newFreq == 0) return 0;
-    
-    // Find if we have this frequency in history
-    for (FrequencyHistory& hist : m_frequencyHistory) {
-        double centsDiff = std::abs(1200 * std::log2(newFreq / hist.frequency));
-        if (centsDiff < 15) { // Within 15 cents
-            hist.count++;
-            hist.confidence = std::max(hist.confidence, confidence);
-            if (hist.count >= 3) { // Need 3 consecutive detections
-                return hist.frequency;
-            }
-            return 0;
-        }
+QStringList TunerEngine::stringNamesFor(const QString &instrument) const
+{
+    QStringList names;
+    for (const StringProfile &string : ::instrumentProfile(instrument.toStdString()).strings) {
+        names.append(QString::fromUtf8(string.name.data(), string.name.size()));
     }
-    
-    // Add new frequency to history
-    m_frequencyHistory.append({newFreq, 1, confidence});
-    if (m_frequencyHistory.size() > HISTORY_SIZE) {
-        m_frequencyHistory.removeFirst();
+    return names;
+}
+
+void TunerEngine::setInstrument(const QString &instrument)
+{
+    if (m_instrument != instrument && instruments().contains(instrument)) {
+        m_instrument = instrument;
+        requestRebuild(RebuildAnalysis);
+        emit instrumentChanged();
     }
-    return 0;
 }
 
-void TunerEngine::setDetectionMethod(const QString &method)
+void TunerEngine::setTargetString(int index)
 {
-    if (m_detectionMethod != method) {
-        m_detectionMethod = method;
-        emit detectionMethodChanged();
+    index = std::clamp(index, -1, InstrumentProfile::STRING_COUNT - 1);
+    if (m_targetString != index) {
+        m_targetString = index;
+        requestRebuild(RebuildAnalysis);
+        emit targetStringChanged();
+    }
+}
+
+void TunerEngine::setStrobeMode(bool enabled)
+{
+    if (m_strobeMode != enabled) {
+        m_strobeMode = enabled;
+        requestRebuild(RebuildAnalysis);
+        emit strobeModeChanged();
+    }
+}
+
+void TunerEngine::setFixedPoint(bool enabled)
+{
+    if (m_fixedPoint != enabled) {
+        m_fixedPoint = enabled;
+        requestRebuild(RebuildAnalysis);
+        emit fixedPointChanged();
+    }
+}
+
+void TunerEngine::setAutoConfigure(bool enabled)
+{
+    if (m_autoConfigure != enabled) {
+        m_autoConfigure = enabled;
+        emit autoConfigureChanged();
+        autoConfigureIfNeeded();
+    }
+}
+
+void TunerEngine::autoConfigureIfNeeded()
+{
+    // The input device decides which sample rates are candidates, wait for the probe
+    if (!m_autoConfigure || (m_openAudioInput && !m_inputProbed)) return;
+
+    QVariantMap profile = AutoConfig::cachedProfile(AutoConfig::deviceFingerprint(m_inputDevice.id()));
+    if (profile.isEmpty()) {
+        runAutoConfiguration();
+    } else {
+        applyAutoConfigProfile(profile);
+    }
+}
+
+void TunerEngine::runAutoConfiguration()
+{
+    if (m_autoConfiguring) return;
+    m_autoConfiguring = true;
+    emit autoConfigureChanged();
+
+    // Test tones span the instrument's band, shifted with the reference like the detector band
+    AutoConfig::Budget budget;
+    const double scale = m_referenceA / 440.0;
+    budget.maximumSampleRate = m_maximumSampleRate;
+    budget.minFrequency = instrumentProfile().minFrequency * scale;
+    budget.maxFrequency = instrumentProfile().maxFrequency * scale;
+    const QString fingerprint = AutoConfig::deviceFingerprint(m_inputDevice.id());
+
+    m_backgroundPool.start([this, budget, fingerprint]() {
+        QVariantMap profile = AutoConfig::toProfile(AutoConfig::run(budget));
+        QMetaObject::invokeMethod(this, [this, fingerprint, profile]() {
+            AutoConfig::storeProfile(fingerprint, profile);
+            m_autoConfiguring = false;
+            emit autoConfigureChanged();
+            qDebug() << "Auto-configuration:" << profile;
+            if (m_autoConfigure) {
+                applyAutoConfigProfile(profile);
+            } else {
+                m_autoConfigProfile = profile;
+                emit autoConfigProfileChanged();
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void TunerEngine::applyAutoConfigProfile(const QVariantMap &profile)
+{
+    if (profile.isEmpty()) return;
+    m_autoConfigProfile = profile;
+    emit autoConfigProfileChanged();
+
+    QVariantMap settings;
+    for (const char *key : {"sampleRate", "bufferSize", "fftPadding", "detectionMethod"}) {
+        settings[key] = profile.value(key);
     }
+    applySettings(settings);
 }
 
 void TunerEngine::setFftPadding(int padding)
@@ -621,8 +1651,7 @@ void TunerEngine::setFftPadding(int padding)
     
     if (m_fftPadding != padding) {
         m_fftPadding = padding;
-        // Resize FFT buffer
-        m_fftBuffer.resize(m_bufferSize * m_fftPadding);
+        requestRebuild(RebuildAnalysis);
         emit fftPaddingChanged();
         
         qDebug() << "FFT padding set to" << padding << "x";
@@ -9,22 +9,57 @@
 #include <QVector>
 #include <QQueue>
 #include <complex>
+#include <memory>
+#include <vector>
 #include <QVariantList>
+#include <QVariantMap>
+#include <QElapsedTimer>
+#include <QAudioDevice>
+#include <QThreadPool>
+#include <array>
+#include "audio/capturefile.h"
+#include "audio/samplering.h"
+#include "audio/tonegenerator.h"
+#include "dsp/idlemonitor.h"
+#include "dsp/instrumentprofile.h"
+#include "dsp/notetable.h"
+#include "dsp/pitchdetector.h"
+#include "dsp/pitchtracker.h"
+#include "dsp/seqlock.h"
+#include "net/resultserver.h"
+#include "session/sessionlog.h"
+#include "tools/latencyHistogram.h"
 
 class QAudioSource;
+class QAudioSink;
+class AudioInputSink;
 class QIODevice;
 
-struct FrequencyHistory {
-    double frequency;
-    int count;
-    double confidence;
+// Magnitude spectrum of the latest FFT frame, shared read-only with renderers
+struct SpectrumSnapshot {
+    std::vector<float> magnitudes;  // Linear magnitude per bin, starting at 0 Hz
+    double binWidth = 0.0;          // Hz per bin
+    qint64 frameIndex = 0;
 };
 
-struct Peak {
-    double frequency;
-    double amplitude;
-    int harmonicCount;
-    double harmonicStrength;
+// One analysis frame as a whole, for readers off the GUI thread. Taken from
+// TunerEngine::resultSnapshot() it never mixes two frames. The magnitudes are
+// read in place with spectrum.value() from a ring the engine owns; they belong
+// to this frame as long as TunerEngine::spectrumUnchanged() holds afterwards.
+struct ResultSnapshot {
+    quint64 frameIndex = 0;       // 0 before the first frame
+    qint64 timestampUSecs = 0;    // Capture time of the newest sample, engine monotonic clock
+    float frequency = 0.0f;       // Tracked, 0 when nothing was detected
+    float cents = 0.0f;
+    float levelDb = -90.0f;
+    float confidence = 0.0f;
+    qint16 midiNote = -1;
+    bool locked = false;
+    bool idle = false;            // Power save, only the level is measured
+    int peakCount = 0;
+    std::array<ResultRecord::PeakEntry, ResultRecord::MAX_PEAKS> peaks{};
+    SeqLockRing::Ticket spectrum;  // Magnitudes from 0 Hz, the latest frame that had a spectrum
+    double binWidth = 0.0;
 };
 
 class TunerEngine : public QObject
@@ -34,27 +69,148 @@ class TunerEngine : public QObject
     Q_PROPERTY(double frequency READ frequency NOTIFY frequencyChanged)
     Q_PROPERTY(double cents READ cents NOTIFY centsChanged)
     Q_PROPERTY(double signalLevel READ signalLevel NOTIFY signalLevelChanged)
+    Q_PROPERTY(double pitchConfidence READ pitchConfidence NOTIFY pitchConfidenceChanged)
     Q_PROPERTY(double dbThreshold READ dbThreshold WRITE setDbThreshold NOTIFY dbThresholdChanged)
     Q_PROPERTY(QVariantList peaks READ peaks NOTIFY peaksChanged)
+    Q_PROPERTY(QVariantList partials READ partials NOTIFY partialsChanged)
+    Q_PROPERTY(double inharmonicity READ inharmonicity NOTIFY partialsChanged)
+    Q_PROPERTY(bool wolfTone READ wolfTone NOTIFY partialsChanged)
     Q_PROPERTY(int sampleRate READ sampleRate WRITE setSampleRate NOTIFY sampleRateChanged)
     Q_PROPERTY(int bufferSize READ bufferSize WRITE setBufferSize NOTIFY bufferSizeChanged)
+    Q_PROPERTY(int deviceBufferSize READ deviceBufferSize WRITE setDeviceBufferSize NOTIFY deviceBufferSizeChanged)
+    Q_PROPERTY(int actualDeviceBufferSize READ actualDeviceBufferSize NOTIFY deviceBufferSizeChanged)
     Q_PROPERTY(int maximumSampleRate READ maximumSampleRate NOTIFY maximumSampleRateChanged)
     Q_PROPERTY(int maxPeaks READ maxPeaks WRITE setMaxPeaks NOTIFY maxPeaksChanged)
     Q_PROPERTY(double referenceA READ referenceA WRITE setReferenceA NOTIFY referenceAChanged)
     Q_PROPERTY(QString detectionMethod READ detectionMethod WRITE setDetectionMethod NOTIFY detectionMethodChanged)
+    Q_PROPERTY(QStringList detectionMethods READ detectionMethods CONSTANT)
     Q_PROPERTY(int fftPadding READ fftPadding WRITE setFftPadding NOTIFY fftPaddingChanged)
+    Q_PROPERTY(bool adaptiveWindow READ adaptiveWindow WRITE setAdaptiveWindow NOTIFY adaptiveWindowChanged)
+    Q_PROPERTY(QString instrument READ instrument WRITE setInstrument NOTIFY instrumentChanged)
+    Q_PROPERTY(QStringList instruments READ instruments CONSTANT)
+    Q_PROPERTY(QStringList stringNames READ stringNames NOTIFY instrumentChanged)
+    Q_PROPERTY(int targetString READ targetString WRITE setTargetString NOTIFY targetStringChanged)
+    Q_PROPERTY(bool strobeMode READ strobeMode WRITE setStrobeMode NOTIFY strobeModeChanged)
+    Q_PROPERTY(double strobePhase READ strobePhase NOTIFY strobeChanged)
+    Q_PROPERTY(bool strobeActive READ strobeActive NOTIFY strobeChanged)
+    Q_PROPERTY(bool fixedPoint READ fixedPoint WRITE setFixedPoint NOTIFY fixedPointChanged)
+    Q_PROPERTY(bool autoConfigure READ autoConfigure WRITE setAutoConfigure NOTIFY autoConfigureChanged)
+    Q_PROPERTY(bool autoConfiguring READ autoConfiguring NOTIFY autoConfigureChanged)
+    Q_PROPERTY(QVariantMap autoConfigProfile READ autoConfigProfile NOTIFY autoConfigProfileChanged)
+    Q_PROPERTY(double autoConfigHeadroom READ autoConfigHeadroom NOTIFY autoConfigProfileChanged)
+    Q_PROPERTY(int analysisWindowSize READ analysisWindowSize NOTIFY analysisWindowSizeChanged)
+    Q_PROPERTY(double lastLockTime READ lastLockTime NOTIFY lockTimeChanged)
+    Q_PROPERTY(QVariantMap lockTimes READ lockTimes NOTIFY lockTimeChanged)
+    Q_PROPERTY(QVariantMap latencyStats READ latencyStats NOTIFY latencyStatsChanged)
+    Q_PROPERTY(QString backlogPolicy READ backlogPolicy WRITE setBacklogPolicy NOTIFY backlogPolicyChanged)
+    Q_PROPERTY(QStringList backlogPolicies READ backlogPolicies CONSTANT)
+    Q_PROPERTY(QVariantMap backlogStats READ backlogStats NOTIFY backlogStatsChanged)
+    Q_PROPERTY(bool capturing READ capturing NOTIFY capturingChanged)
+    Q_PROPERTY(bool resultServerRunning READ resultServerRunning NOTIFY resultServerRunningChanged)
+    Q_PROPERTY(bool sessionRecording READ sessionRecording NOTIFY sessionRecordingChanged)
+    Q_PROPERTY(bool powerSave READ powerSave WRITE setPowerSave NOTIFY powerSaveChanged)
+    Q_PROPERTY(double idleDelay READ idleDelay WRITE setIdleDelay NOTIFY powerSaveChanged)
+    Q_PROPERTY(bool idle READ idle NOTIFY idleChanged)
+    Q_PROPERTY(QString temperament READ temperament WRITE setTemperament NOTIFY temperamentChanged)
+    Q_PROPERTY(int temperamentRoot READ temperamentRoot WRITE setTemperamentRoot NOTIFY temperamentChanged)
+    Q_PROPERTY(QVariantList customCents READ customCents WRITE setCustomCents NOTIFY temperamentChanged)
+    Q_PROPERTY(bool toneEnabled READ toneEnabled WRITE setToneEnabled NOTIFY toneChanged)
+    Q_PROPERTY(int toneNote READ toneNote WRITE setToneNote NOTIFY toneChanged)
+    Q_PROPERTY(QString toneNoteName READ toneNoteName NOTIFY toneChanged)
+    Q_PROPERTY(double toneFrequency READ toneFrequency NOTIFY toneChanged)
+    Q_PROPERTY(bool toneFifth READ toneFifth WRITE setToneFifth NOTIFY toneChanged)
+    Q_PROPERTY(QString toneTimbre READ toneTimbre WRITE setToneTimbre NOTIFY toneChanged)
+    Q_PROPERTY(QStringList toneTimbres READ toneTimbres CONSTANT)
+    Q_PROPERTY(double toneVolume READ toneVolume WRITE setToneVolume NOTIFY toneChanged)
 
 public:
-    explicit TunerEngine(QObject *parent = nullptr);
+    // openAudioInput = false keeps the engine off the audio stack, samples
+    // then only arrive through ingestAudio() (capture replay)
+    explicit TunerEngine(QObject *parent = nullptr, bool openAudioInput = true);
     ~TunerEngine();
 
+    // Opening the device waits for the background probe, a start() issued
+    // before it finished is remembered and honoured when it completes
     void start();
     void stop();
+    bool audioInputReady() const { return m_inputProbed; }
+
+    // Feed one chunk of int16 samples from a replay or synthetic source. deviceDelayUSecs
+    // is how long ago the newest sample of the chunk was captured, when known
+    void ingestAudio(const QByteArray &chunk, qint64 arrivalUSecs, qint64 deviceDelayUSecs = 0);
+    // Push-mode device input, called by AudioInputSink with the backend's buffer
+    void ingestDeviceAudio(const char *data, qint64 size);
+
+    // Raw input capture for field profiling, see audio/capturefile.h
+    Q_INVOKABLE bool startCapture(const QString &path = QString());
+    Q_INVOKABLE void stopCapture();
+    bool capturing() const { return m_captureWriter.isOpen(); }
+
+    // Streams every analysis result to companion displays, see net/resultserver.h
+    Q_INVOKABLE bool startResultServer(int port = ResultServer::DEFAULT_PORT);
+    Q_INVOKABLE void stopResultServer();
+    bool resultServerRunning() const { return m_resultServer.isRunning(); }
+
+    // Practice session log of every tracked pitch, see session/sessionlog.h
+    Q_INVOKABLE bool startSession(const QString &path = QString());
+    Q_INVOKABLE void stopSession();
+    bool sessionRecording() const { return m_sessionLog.isRecording(); }
+    // Per-note intonation of the current or last session between two session times
+    // (seconds, toSeconds < 0 for the end): durationSeconds, inTuneCents, droppedFrames,
+    // and notes, each with note, midiNote, frames, seconds, inTuneSeconds, inTuneFraction,
+    // meanCents, stddevCents, driftCentsPerMinute and timeline [{seconds, cents}]
+    Q_INVOKABLE QVariantMap sessionStatistics(double fromSeconds = 0.0, double toSeconds = -1.0);
+
+    // Configuration transactions: setters called between begin and end only
+    // mark what needs rebuilding, endConfiguration() rebuilds each part once
+    void beginConfiguration();
+    void endConfiguration();
+    // Applies every known key of the map (same names as the properties) at once
+    Q_INVOKABLE void applySettings(const QVariantMap &settings);
+
+    // CPU time spent on audio blocks per second of audio, split by active and
+    // idle state (activeCpuMsPerSecond, idleCpuMsPerSecond, activeSeconds, idleSeconds).
+    // Thread CPU time is only measured on Linux, elsewhere the CPU fields stay 0.
+    Q_INVOKABLE QVariantMap powerStats() const;
+    Q_INVOKABLE void resetPowerStats();
+
+    // Latency histograms per stage of the newest sample in each analyzed window:
+    // capture (device capture -> analysis start), analysis (-> tracked result),
+    // properties (-> note properties emitted), render (-> next frame swapped)
+    // and total (capture -> frame swapped). Each entry is a
+    // LatencyHistogram::toVariantMap(), render and total need frameRendered().
+    QVariantMap latencyStats() const;
+    Q_INVOKABLE void resetLatencyStats();
+    // Engine monotonic clock, safe to read from any thread
+    qint64 monotonicUSecs() const { return m_monotonicClock.nsecsElapsed() / 1000; }
+    // A frame showing the current properties was swapped at usecs (monotonicUSecs())
+    void frameRendered(qint64 usecs);
+
+    // What happens to blocks queued behind a stall (GUI pause, app resume, slow
+    // frame) once a newer complete window is buffered as well:
+    // ProcessAll analyzes every one of them, LatestOnly analyzes only the
+    // newest as if it were the next frame, SkipToNewest drops the stale ones
+    // too but ages the tracker and the lock clock by the skipped time
+    enum class BacklogPolicy {
+        ProcessAll,
+        LatestOnly,
+        SkipToNewest
+    };
+    QString backlogPolicy() const { return m_backlogPolicyName; }
+    void setBacklogPolicy(const QString &policy);
+    QStringList backlogPolicies() const;
+    // processedBlocks, droppedBlocks, maxBacklogBlocks (complete blocks queued
+    // at once, the watermark) and maxBacklogMs, since the last reset
+    QVariantMap backlogStats() const;
+    Q_INVOKABLE void resetBacklogStats();
+
+    // Smallest buffer size >= bufferSize whose FFT length factors into 2, 3 and 5
+    Q_INVOKABLE int suggestedBufferSize(int bufferSize) const;
 
     // Add reload function
     Q_INVOKABLE void reload() {
         stop();
-        setupAudioInput();
+        probeAudioInput();
         start();
     }
 
@@ -63,12 +219,24 @@ public:
     double frequency() const { return m_frequency; }
     double cents() const { return m_cents; }
     double signalLevel() const { return m_signalLevel; }
+    double pitchConfidence() const { return m_pitchConfidence; }
     double dbThreshold() const { return m_dbThreshold; }
     void setDbThreshold(double threshold);
     QVariantList peaks() const { return m_peaks; }
+    // Tracked partials of the current note: harmonic, frequency, amplitude,
+    // deviationCents (from the fitted stiff string series), unstable
+    QVariantList partials() const { return m_partials; }
+    double inharmonicity() const { return m_inharmonicity; }
+    bool wolfTone() const { return m_wolfTone; }
     int sampleRate() const { return m_sampleRate; }
     void setSampleRate(int rate);
     int bufferSize() const { return m_bufferSize; }
+    // Input device buffer in samples, 0 leaves it to the backend. Smaller
+    // buffers mean more callbacks per second and less capture latency
+    int deviceBufferSize() const { return m_deviceBufferSize; }
+    void setDeviceBufferSize(int samples);
+    // What the backend granted, known once the source has started
+    int actualDeviceBufferSize() const;
     void setBufferSize(int size);
     int maximumSampleRate() const { return m_maximumSampleRate; }
     int maxPeaks() const { return m_maxPeaks; }
@@ -77,28 +245,123 @@ public:
     void setReferenceA(double freq);
     QString detectionMethod() const { return m_detectionMethod; }
     void setDetectionMethod(const QString &method);
+    QStringList detectionMethods() const;
     int fftPadding() const { return m_fftPadding; }
     void setFftPadding(int padding);
+    bool adaptiveWindow() const { return m_adaptiveWindow; }
+    void setAdaptiveWindow(bool enabled);
+    QString instrument() const { return m_instrument; }
+    void setInstrument(const QString &instrument);
+    QStringList instruments() const;
+    QStringList stringNames() const { return stringNamesFor(m_instrument); }
+    Q_INVOKABLE QStringList stringNamesFor(const QString &instrument) const;
+    // Index into stringNames, lowest string first, -1 listens for any note
+    int targetString() const { return m_targetString; }
+    void setTargetString(int index);
+    bool strobeMode() const { return m_strobeMode; }
+    void setStrobeMode(bool enabled);
+    // Strobe angle in cycles [0, 1): advances with the phase error against the nearest note
+    double strobePhase() const { return m_strobePhase; }
+    bool strobeActive() const { return m_strobeActive; }
+    // Integer Q15 analysis for targets without a fast FPU, strobe mode stays on doubles
+    bool fixedPoint() const { return m_fixedPoint; }
+    void setFixedPoint(bool enabled);
+    // Sample rate, buffer size, padding and method from a per-device benchmark, see config/autoconfig.h
+    bool autoConfigure() const { return m_autoConfigure; }
+    void setAutoConfigure(bool enabled);
+    bool autoConfiguring() const { return m_autoConfiguring; }
+    QVariantMap autoConfigProfile() const { return m_autoConfigProfile; }
+    // Real-time factor of the chosen pipeline as measured, 0 before the first benchmark
+    double autoConfigHeadroom() const { return m_autoConfigProfile.value("headroom").toDouble(); }
+    // Benchmarks again even when this device already has a cached profile
+    Q_INVOKABLE void runAutoConfiguration();
+    int analysisWindowSize() const { return m_analysisWindowSize; }
+    double lastLockTime() const { return m_lastLockTime; }
+    QVariantMap lockTimes() const { return m_lockTimes; }
+    QString temperament() const { return m_temperament; }
+    void setTemperament(const QString &temperament);
+    int temperamentRoot() const { return m_temperamentRoot; }
+    void setTemperamentRoot(int pitchClass);
+    QVariantList customCents() const;
+    void setCustomCents(const QVariantList &cents);
+    bool powerSave() const { return m_powerSave; }
+    void setPowerSave(bool enabled);
+    double idleDelay() const { return m_idleDelay; }
+    void setIdleDelay(double seconds);
+    bool idle() const { return m_idleMonitor.isIdle(); }
+    // Reference tone or drone on the default output, pitched from the note table
+    // so it follows referenceA and the temperament
+    bool toneEnabled() const { return m_toneEnabled; }
+    void setToneEnabled(bool enabled);
+    int toneNote() const { return m_toneNote; }
+    void setToneNote(int midiNote);
+    QString toneNoteName() const;
+    double toneFrequency() const { return m_noteTable.centerFrequency(m_toneNote); }
+    // Adds the fifth above from the note table, a drone to tune the next string against
+    bool toneFifth() const { return m_toneFifth; }
+    void setToneFifth(bool enabled);
+    QString toneTimbre() const { return m_toneTimbre; }
+    void setToneTimbre(const QString &timbre);
+    QStringList toneTimbres() const;
+    double toneVolume() const { return m_toneVolume; }
+    void setToneVolume(double volume);
+    // Offline engines open no sink, a synthetic source renders the tone from here instead
+    ToneGenerator &toneGenerator() { return m_toneGenerator; }
+
+    CaptureSettings captureSettings() const;
+
+    // Consistent copy of the latest frame, lock-free from any thread
+    ResultSnapshot resultSnapshot() const { return m_snapshot.load(); }
+    // After reading snapshot.spectrum.data: true when it was not recycled meanwhile
+    bool spectrumUnchanged(const ResultSnapshot &snapshot) const { return m_spectrumRing.unchanged(snapshot.spectrum); }
+
+    // Latest spectrum frame, null until the FFT detector has run once
+    std::shared_ptr<const SpectrumSnapshot> latestSpectrum() const { return m_spectrum; }
 
 signals:
     void noteChanged();
     void frequencyChanged();
     void centsChanged();
     void signalLevelChanged();
+    void pitchConfidenceChanged();
     void dbThresholdChanged();
     void peaksChanged();
+    void partialsChanged();
     void noteDetected(const QString &note, double frequency, double cents);
     void signalLevel(double dbFS);
     void sampleRateChanged();
     void bufferSizeChanged();
+    void deviceBufferSizeChanged();
     void maximumSampleRateChanged();
     void maxPeaksChanged();
     void referenceAChanged();
     void detectionMethodChanged();
     void fftPaddingChanged();
+    void adaptiveWindowChanged();
+    void instrumentChanged();
+    void targetStringChanged();
+    void strobeModeChanged();
+    void strobeChanged();
+    void fixedPointChanged();
+    void autoConfigureChanged();
+    void autoConfigProfileChanged();
+    void analysisWindowSizeChanged();
+    void lockTimeChanged();
+    void latencyStatsChanged();
+    void backlogPolicyChanged();
+    void backlogStatsChanged();
+    void capturingChanged();
+    void resultServerRunningChanged();
+    void sessionRecordingChanged();
+    void spectrumUpdated();
+    void temperamentChanged();
+    void audioInputOpened();
+    void powerSaveChanged();
+    void idleChanged();
+    void toneChanged();
 
 private slots:
-    void processAudioInput();
+    void recordCaptureSettings();
 
 private:
     static constexpr int DEFAULT_SAMPLE_RATE = 48000;
@@ -107,48 +370,235 @@ private:
     static constexpr int DEFAULT_MAX_PEAKS = 10;
     static constexpr int DEFAULT_FFT_PADDING = 2;  // Default 2x padding
 
+    // Adaptive window: a short probe gives a coarse pitch, then the analysis
+    // window is sized to a fixed number of periods of that pitch
+    static constexpr int ADAPTIVE_PROBE_SIZE = 2048;
+    static constexpr int ADAPTIVE_PERIODS = 12;
+    static constexpr int ADAPTIVE_WINDOW_STEP = 256;  // Bounds the number of cached window tables
+    static constexpr int ADAPTIVE_MIN_WINDOW = 1024;
+    static constexpr int ADAPTIVE_MAX_WINDOW = 16384;
+
+    // Target string: the band already rules out octave errors, fewer periods do
+    static constexpr int TARGET_STRING_PERIODS = 8;
+
+    // Power save: after idleDelay seconds below threshold only the envelope is tracked
+    static constexpr double DEFAULT_IDLE_DELAY = 10.0;
+    static constexpr int IDLE_LEVEL_UPDATES_PER_SECOND = 4;
+
+    // Strobe mode: short unpadded frames overlapping by 3/4, precision comes
+    // from the phase advance between consecutive frames instead of padding
+    static constexpr int STROBE_WINDOW = 4096;
+    static constexpr int STROBE_HOP = 1024;
+
+    // Reference tone: fades keep the gate click-free, a short sink buffer keeps changes prompt
+    static constexpr int DEFAULT_TONE_NOTE = 57;  // A3, the cello's A string
+    static constexpr int TONE_FIFTH = 7;
+    static constexpr int TONE_FADE_MS = 150;
+    static constexpr qint64 TONE_BUFFER_USECS = 20000;
+
+    static constexpr double SPECTRUM_MAX_FREQUENCY = 2000.0;  // Upper bound of the published spectrum
+    // Snapshot spectra, a reader has SPECTRUM_SLOTS - 1 frames to finish with one.
+    // 8192 bins reach SPECTRUM_MAX_FREQUENCY up to 16384 x 8 points at 32 kHz
+    static constexpr int SPECTRUM_SLOTS = 4;
+    static constexpr int SPECTRUM_SLOT_BINS = 8192;
+    // Spectrum snapshots are reused once no renderer holds them; the spectrum
+    // item keeps the latest one and any waterfall rows it has not drawn yet
+    static constexpr int SPECTRUM_POOL_SIZE = 4;
+
+    // Samples the input ring holds, 2.7 s at 48 kHz, several of the largest windows
+    static constexpr int RING_CAPACITY = 1 << 17;
+    // Chunk times held for the ring; smaller device writes than this share an entry
+    static constexpr int MIN_CHUNK_SAMPLES = 64;
+    static constexpr int CHUNK_TIME_CAPACITY = RING_CAPACITY / MIN_CHUNK_SAMPLES;
+    static constexpr int MAX_DEVICE_BUFFER_SIZE = 16384;
+
+    // latencyStatsChanged is throttled, the log gets a summary less often
+    static constexpr qint64 LATENCY_REPORT_INTERVAL_USECS = 1000000;
+    static constexpr qint64 LATENCY_LOG_INTERVAL_USECS = 30000000;
+
+    bool m_openAudioInput;
     QAudioSource* m_audioSource;
-    QIODevice* m_audioDevice;
+    QIODevice* m_audioDevice;  // The push sink while the source is running
+    AudioInputSink* m_inputSink;
+
+    // Device enumeration and plan warm-up stay off the GUI thread at startup
+    QThreadPool m_backgroundPool;
+    QAudioDevice m_inputDevice;
+    bool m_inputProbed = false;
+    bool m_startPending = false;
+    void probeAudioInput();
+    void onAudioInputProbed(const QAudioDevice &device);
+    void warmUpAnalysis();
+
+    enum RebuildFlag {
+        RebuildAudio = 1 << 0,      // Audio source, sample rate
+        RebuildAnalysis = 1 << 1,   // Accumulation, FFT plans and window tables
+        RebuildNoteTable = 1 << 2   // Reference pitch and temperament
+    };
+    int m_configurationDepth = 0;
+    int m_pendingRebuild = 0;
+    void requestRebuild(int flags);
+    void rebuild(int flags);
+    QElapsedTimer m_monotonicClock;
+    CaptureWriter m_captureWriter;
+    ResultServer m_resultServer;
+    SessionLog m_sessionLog;
+    qint64 m_sessionStartUSecs = 0;
+    ResultRecord m_result;
+    quint32 m_resultSequence = 0;
     QByteArray m_buffer;
-    QByteArray m_accumulationBuffer;
+    SampleRing m_accumulationBuffer{RING_CAPACITY};
+    // Capture time of the last sample of each chunk still in the accumulation
+    // buffer, oldest first from m_firstChunkTime; preallocated like the ring
+    struct ChunkTime {
+        qint64 endSample = 0;  // Sample clock just past the chunk
+        qint64 captureUSecs = 0;
+    };
+    std::vector<ChunkTime> m_chunkTimes = std::vector<ChunkTime>(CHUNK_TIME_CAPACITY);
+    int m_firstChunkTime = 0;
+    int m_chunkTimeCount = 0;
+    ChunkTime &chunkTime(int index) { return m_chunkTimes[(m_firstChunkTime + index) % CHUNK_TIME_CAPACITY]; }
+    const ChunkTime &chunkTime(int index) const { return m_chunkTimes[(m_firstChunkTime + index) % CHUNK_TIME_CAPACITY]; }
+    void pushChunkTime(qint64 endSample, qint64 captureUSecs);
+    void ingestSamples(const qint16 *samples, int count, qint64 arrivalUSecs, qint64 deviceDelayUSecs);
 
     // Property storage
     QString m_currentNote;
     double m_frequency = 0.0;
     double m_cents = 0.0;
     double m_signalLevel = -90.0;
+    double m_pitchConfidence = 0.0;
     double m_dbThreshold = -70.0;
     QVariantList m_peaks;
+    QVariantList m_partials;
+    double m_inharmonicity = 0.0;
+    bool m_wolfTone = false;
     int m_sampleRate = DEFAULT_SAMPLE_RATE;
     int m_bufferSize = DEFAULT_BUFFER_SIZE;
+    int m_deviceBufferSize = 0;
     int m_maximumSampleRate = DEFAULT_SAMPLE_RATE;
     int m_maxPeaks = DEFAULT_MAX_PEAKS;
     double m_referenceA = DEFAULT_A4_FREQUENCY;
     QString m_detectionMethod = "FFT";
+    PitchDetector::Method m_method = PitchDetector::Method::Fft;  // Resolved from m_detectionMethod once
     int m_fftPadding = DEFAULT_FFT_PADDING;
+    bool m_adaptiveWindow = false;
+    int m_analysisWindowSize = DEFAULT_BUFFER_SIZE;
+    int m_pendingWindowSize = 0;
+    QString m_instrument = "Cello";
+    int m_targetString = -1;
+    int m_targetWindowSize = DEFAULT_BUFFER_SIZE;
+    const InstrumentProfile &instrumentProfile() const;
+    int targetWindowSize() const;
+    bool m_strobeMode = false;
+    double m_strobePhase = 0.0;
+    bool m_strobeActive = false;
+    void updateStrobe(const PitchDetector::Result &detection);
+    bool m_fixedPoint = false;
+    bool m_autoConfigure = false;
+    bool m_autoConfiguring = false;
+    QVariantMap m_autoConfigProfile;
+    void autoConfigureIfNeeded();
+    void applyAutoConfigProfile(const QVariantMap &profile);
+    bool fixedPointActive() const;
+
+    // Time-to-lock bookkeeping, counted in consumed samples
+    qint64 m_sampleClock = 0;
+    qint64 m_onsetSample = -1;
+    bool m_locked = false;
+    double m_lastLockTime = 0.0;
+    QVariantMap m_lockTimes;
+
+    // Note lookup, rebuilt when referenceA or the temperament changes
+    NoteTable m_noteTable;
+    QString m_temperament = "Equal";
+    int m_temperamentRoot = 9;  // A, the string cellists tune first
+    std::array<double, 12> m_customCents{};
+    void rebuildNoteTable();
+
+    bool m_toneEnabled = false;
+    int m_toneNote = DEFAULT_TONE_NOTE;
+    bool m_toneFifth = false;
+    QString m_toneTimbre = "Cello";
+    double m_toneVolume = 0.5;
+    ToneGenerator m_toneGenerator;
+    QAudioSink *m_toneSink = nullptr;
+    bool m_outputProbing = false;
+    void startToneOutput();
+    void onAudioOutputProbed(const QAudioDevice &device);
+    void stopIdleToneOutput();
+    void updateToneFrequencies();
 
-    double detectFrequencyAutocorrelation(const QVector<double>& samples);
-    double detectFrequencyFFT(const QVector<double>& samples);
     QString frequencyToNote(double frequency, double& cents);
     void setupAudioInput();
-    void processAccumulatedData();
-    double calculateDBFS(const QVector<double>& samples);
-    void updatePeaks(const QVector<Peak>& peaks);
+    void processAccumulatedData(int windowSize, int hopSize);
+    int selectAdaptiveWindowSize();
+    void updateLockTime(const QString& note, bool detected, bool aboveThreshold, int newSamples);
+    void updatePeaks(const std::vector<PitchDetector::Peak>& peaks);
+    void updatePartials(const PitchDetector::Result &detection);
 
-    QVector<std::complex<double>> m_fftBuffer;
-    void applyHannWindow(QVector<double>& samples);
-    void performFFT(QVector<std::complex<double>>& data);
+    // Detection runs in the Qt-free DSP core, the engine adapts it to properties
+    PitchDetector m_detector;
+    std::vector<double> m_samples;
+    PitchDetector::Settings detectorSettings() const;
+    std::shared_ptr<const SpectrumSnapshot> m_spectrum;
+    std::array<std::shared_ptr<SpectrumSnapshot>, SPECTRUM_POOL_SIZE> m_spectrumPool;
+    int m_spectrumPoolNext = 0;  // Replaced when every pooled snapshot is held
+    qint64 m_spectrumFrameIndex = 0;
+    void publishSpectrum();
+    SeqLockRing m_spectrumRing;
+    SeqLockRing::Ticket m_spectrumTicket;
+    double m_spectrumTicketBinWidth = 0.0;
+    SeqLock<ResultSnapshot> m_snapshot;
+    void publishSnapshot(bool idle);
 
     void updateMaximumSampleRate();
 
-    void analyzeHarmonics(Peak& fundamental, const QVector<Peak>& peaks);
-    double calculateNoteProbability(const Peak& peak) const;
-    Peak* selectBestPeak(QVector<Peak>& peaks);
-    double getStableFrequency(double newFreq, double confidence);
-    double getNearestNoteFrequency(double frequency) const;
-    
-    QVector<FrequencyHistory> m_frequencyHistory;
-    static constexpr int HISTORY_SIZE = 5;
+    void setPitchConfidence(double confidence);
+
+    PitchTracker m_pitchTracker;
+
+    bool m_powerSave = true;
+    double m_idleDelay = DEFAULT_IDLE_DELAY;
+    IdleMonitor m_idleMonitor;
+    qint64 m_idleLevelSamples = 0;  // Samples since the last idle level update
+    void configureIdleMonitor();
+    void enterIdle();
+    bool scanIdle();
+    void analyzeAccumulation();
+
+    struct PowerCounter {
+        qint64 cpuNsecs = 0;
+        qint64 samples = 0;
+    };
+    PowerCounter m_activePower;
+    PowerCounter m_idlePower;
+
+    enum LatencyStage {
+        CaptureLatency,
+        AnalysisLatency,
+        PropertiesLatency,
+        RenderLatency,
+        TotalLatency,
+        LATENCY_STAGE_COUNT
+    };
+    qint64 m_deviceReadSamples = 0;  // Read from the current QAudioSource since start()
+    std::array<LatencyHistogram, LATENCY_STAGE_COUNT> m_latency;
+    qint64 m_pendingFrameCaptureUSecs = -1;  // Properties changed, waiting for a frame
+    qint64 m_pendingFramePropertiesUSecs = -1;
+    qint64 m_latencyReportUSecs = 0;
+    qint64 m_latencyLogUSecs = 0;
+    qint64 captureTimeOf(qint64 sample) const;
+
+    QString m_backlogPolicyName = "Process all";
+    BacklogPolicy m_backlogPolicy = BacklogPolicy::ProcessAll;
+    qint64 m_processedBlocks = 0;
+    qint64 m_droppedBlocks = 0;
+    int m_maxBacklogBlocks = 0;
+    int m_maxBacklogSamples = 0;
+    void dropBacklog(int windowSize, int hopSize);
+    void recordLatency(LatencyStage stage, qint64 usecs);
+    void reportLatency(qint64 now);
 
 };
 
@@ -0,0 +1,282 @@
+#include "spectrumitem.h"
+
+#include <QQuickWindow>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGImageNode>
+#include <QSGRendererInterface>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Child nodes are kept as members so updatePaintNode can reuse them
+class SpectrumRootNode : public QSGNode
+{
+public:
+    QSGGeometryNode *line = nullptr;        // Hardware backends
+    QSGImageNode *spectrumImage = nullptr;  // Software backend
+    QSGImageNode *waterfall = nullptr;
+};
+
+}
+
+SpectrumItem::SpectrumItem(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+
+    // Dark blue -> purple -> orange -> yellow, matching the app palette
+    for (int i = 0; i < 256; ++i) {
+        double t = i / 255.0;
+        int r = static_cast<int>(255 * std::min(1.0, 1.6 * t));
+        int g = static_cast<int>(255 * std::max(0.0, 1.8 * t - 0.8));
+        int b = static_cast<int>(255 * std::max(0.0, 0.45 - std::abs(t - 0.3)) * 2.0);
+        m_palette[i] = qRgb(std::min(r, 255), std::min(g, 255), std::min(b + 0x1a, 255));
+    }
+}
+
+void SpectrumItem::setEngine(TunerEngine *engine)
+{
+    if (m_engine == engine) return;
+    if (m_engine) disconnect(m_engine, nullptr, this, nullptr);
+    m_engine = engine;
+    if (m_engine) {
+        connect(m_engine, &TunerEngine::spectrumUpdated, this, &SpectrumItem::onSpectrumUpdated);
+    }
+    emit engineChanged();
+}
+
+void SpectrumItem::setMinFrequency(double frequency)
+{
+    if (m_minFrequency == frequency) return;
+    m_minFrequency = frequency;
+    m_columnMapDirty = true;
+    emit scaleChanged();
+    update();
+}
+
+void SpectrumItem::setMaxFrequency(double frequency)
+{
+    if (m_maxFrequency == frequency) return;
+    m_maxFrequency = frequency;
+    m_columnMapDirty = true;
+    emit scaleChanged();
+    update();
+}
+
+void SpectrumItem::setLogarithmicScale(bool enabled)
+{
+    if (m_logarithmicScale == enabled) return;
+    m_logarithmicScale = enabled;
+    m_columnMapDirty = true;
+    emit scaleChanged();
+    update();
+}
+
+void SpectrumItem::setDynamicRange(double db)
+{
+    if (m_dynamicRange == db || db <= 0) return;
+    m_dynamicRange = db;
+    emit scaleChanged();
+    update();
+}
+
+void SpectrumItem::setWaterfallRows(int rows)
+{
+    rows = std::max(1, rows);
+    if (m_waterfallRows == rows) return;
+    m_waterfallRows = rows;
+    m_waterfallImage = QImage();
+    emit waterfallRowsChanged();
+    update();
+}
+
+void SpectrumItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    m_columnMapDirty = true;
+    update();
+}
+
+void SpectrumItem::onSpectrumUpdated()
+{
+    auto snapshot = m_engine->latestSpectrum();
+    if (!snapshot) return;
+
+    m_latest = snapshot;
+    // Frames that arrive between two renders still get their waterfall row
+    if (static_cast<int>(m_pendingRows.size()) < m_waterfallRows) {
+        m_pendingRows.push_back(std::move(snapshot));
+    }
+    update();
+}
+
+void SpectrumItem::updateColumnMap(int width, double binWidth)
+{
+    if (!m_columnMapDirty && m_mappedWidth == width && m_mappedBinWidth == binWidth) return;
+
+    // Column c covers bins [m_columnBins[c], m_columnBins[c + 1])
+    m_columnBins.resize(width + 1);
+    double logMin = std::log(m_minFrequency);
+    double logMax = std::log(m_maxFrequency);
+    for (int c = 0; c <= width; ++c) {
+        double t = static_cast<double>(c) / width;
+        double frequency = m_logarithmicScale ?
+                    std::exp(logMin + t * (logMax - logMin)) :
+                    m_minFrequency + t * (m_maxFrequency - m_minFrequency);
+        m_columnBins[c] = static_cast<int>(frequency / binWidth);
+    }
+    for (int c = 0; c < width; ++c) {
+        m_columnBins[c + 1] = std::max(m_columnBins[c + 1], m_columnBins[c] + 1);
+    }
+
+    m_mappedWidth = width;
+    m_mappedBinWidth = binWidth;
+    m_columnMapDirty = false;
+}
+
+void SpectrumItem::computeLevels(const SpectrumSnapshot &snapshot, std::vector<float> &levels) const
+{
+    const int width = m_mappedWidth;
+    const int binCount = static_cast<int>(snapshot.magnitudes.size());
+    levels.assign(width, 0.0f);
+
+    float reference = 0.0f;
+    for (float magnitude : snapshot.magnitudes) reference = std::max(reference, magnitude);
+    if (reference <= 0.0f) return;
+
+    // Peak-hold per column, then map dB below the frame maximum to [0, 1]
+    for (int c = 0; c < width; ++c) {
+        int first = std::min(m_columnBins[c], binCount);
+        int last = std::min(m_columnBins[c + 1], binCount);
+        float magnitude = 0.0f;
+        for (int bin = first; bin < last; ++bin) magnitude = std::max(magnitude, snapshot.magnitudes[bin]);
+        if (magnitude <= 0.0f) continue;
+        double db = 20.0 * std::log10(magnitude / reference);
+        levels[c] = static_cast<float>(std::clamp(1.0 + db / m_dynamicRange, 0.0, 1.0));
+    }
+}
+
+void SpectrumItem::rasterizeSpectrum(const std::vector<float> &levels, int height)
+{
+    const int width = static_cast<int>(levels.size());
+    if (m_spectrumImage.width() != width || m_spectrumImage.height() != height) {
+        m_spectrumImage = QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+    }
+    m_spectrumImage.fill(Qt::transparent);
+
+    const QRgb color = qRgb(0x4C, 0xAF, 0x50);
+    for (int c = 0; c < width; ++c) {
+        int top = height - static_cast<int>(levels[c] * height);
+        for (int y = std::max(top, 0); y < height; ++y) {
+            reinterpret_cast<QRgb*>(m_spectrumImage.scanLine(y))[c] = color;
+        }
+    }
+}
+
+void SpectrumItem::scrollWaterfall(const std::vector<float> &levels)
+{
+    const int width = static_cast<int>(levels.size());
+    if (m_waterfallImage.width() != width || m_waterfallImage.height() != m_waterfallRows) {
+        m_waterfallImage = QImage(width, m_waterfallRows, QImage::Format_RGB32);
+        m_waterfallImage.fill(m_palette[0]);
+    }
+
+    // Newest row on top, older rows move down by one
+    const qsizetype stride = m_waterfallImage.bytesPerLine();
+    uchar *bits = m_waterfallImage.scanLine(0);
+    std::memmove(bits + stride, bits, stride * (m_waterfallRows - 1));
+
+    QRgb *row = reinterpret_cast<QRgb*>(m_waterfallImage.scanLine(0));
+    for (int c = 0; c < width; ++c) {
+        row[c] = m_palette[static_cast<int>(levels[c] * 255.0f)];
+    }
+}
+
+QSGNode *SpectrumItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    m_paintTimer.start();
+
+    auto *root = static_cast<SpectrumRootNode*>(oldNode);
+    const int width = static_cast<int>(this->width());
+    const int spectrumHeight = static_cast<int>(height() * (1.0 - WATERFALL_FRACTION));
+    const int waterfallHeight = static_cast<int>(height()) - spectrumHeight;
+
+    if (width <= 0 || spectrumHeight <= 0 || !m_latest || !window()) {
+        m_pendingRows.clear();
+        delete root;
+        return nullptr;
+    }
+
+    if (!root) root = new SpectrumRootNode;
+    const bool software = window()->rendererInterface()->graphicsApi() == QSGRendererInterface::Software;
+
+    updateColumnMap(width, m_latest->binWidth);
+
+    for (const auto &snapshot : m_pendingRows) {
+        if (snapshot->binWidth != m_mappedBinWidth) continue;
+        computeLevels(*snapshot, m_levels);
+        scrollWaterfall(m_levels);
+    }
+    m_pendingRows.clear();
+    computeLevels(*m_latest, m_levels);
+
+    if (software) {
+        // The software renderer has no custom geometry support, draw the spectrum into an image
+        rasterizeSpectrum(m_levels, spectrumHeight);
+        if (!root->spectrumImage) {
+            root->spectrumImage = window()->createImageNode();
+            root->spectrumImage->setOwnsTexture(true);
+            root->appendChildNode(root->spectrumImage);
+        }
+        root->spectrumImage->setTexture(window()->createTextureFromImage(m_spectrumImage));
+        root->spectrumImage->setRect(QRectF(0, 0, width, spectrumHeight));
+    } else {
+        if (!root->line) {
+            root->line = new QSGGeometryNode;
+            auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), width);
+            geometry->setDrawingMode(QSGGeometry::DrawLineStrip);
+            geometry->setLineWidth(1.5f);
+            auto *material = new QSGFlatColorMaterial;
+            material->setColor(QColor(0x4C, 0xAF, 0x50));
+            root->line->setGeometry(geometry);
+            root->line->setMaterial(material);
+            root->line->setFlag(QSGNode::OwnsGeometry);
+            root->line->setFlag(QSGNode::OwnsMaterial);
+            root->appendChildNode(root->line);
+        }
+        QSGGeometry *geometry = root->line->geometry();
+        if (geometry->vertexCount() != width) geometry->allocate(width);
+        QSGGeometry::Point2D *vertices = geometry->vertexDataAsPoint2D();
+        for (int c = 0; c < width; ++c) {
+            vertices[c].set(c + 0.5f, spectrumHeight * (1.0f - m_levels[c]));
+        }
+        root->line->markDirty(QSGNode::DirtyGeometry);
+    }
+
+    if (waterfallHeight > 0 && !m_waterfallImage.isNull()) {
+        if (!root->waterfall) {
+            root->waterfall = window()->createImageNode();
+            root->waterfall->setOwnsTexture(true);
+            root->waterfall->setFiltering(QSGTexture::Linear);
+            root->appendChildNode(root->waterfall);
+        }
+        root->waterfall->setTexture(window()->createTextureFromImage(m_waterfallImage));
+        root->waterfall->setRect(QRectF(0, spectrumHeight, width, waterfallHeight));
+    }
+
+    setFrameTime(m_paintTimer.nsecsElapsed() / 1.0e6);
+    return root;
+}
+
+void SpectrumItem::setFrameTime(double ms)
+{
+    // Runs on the render thread, hand the smoothed value to the GUI thread
+    double smoothed = m_frameTime > 0 ? 0.9 * m_frameTime + 0.1 * ms : ms;
+    QMetaObject::invokeMethod(this, [this, smoothed]() {
+        m_frameTime = smoothed;
+        emit frameTimeChanged();
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,91 @@
+#ifndef SPECTRUMITEM_H
+#define SPECTRUMITEM_H
+
+#include <QQuickItem>
+#include <QImage>
+#include <QElapsedTimer>
+#include <memory>
+#include <vector>
+#include "../tunerengine.h"
+
+// Magnitude spectrum plus scrolling waterfall, drawn directly from the
+// engine's SpectrumSnapshot without going through QVariant.
+// The spectrum is a QSGGeometryNode line strip on hardware scene graph
+// backends and a rasterized image on the software backend, the waterfall
+// is a texture in both cases.
+class SpectrumItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(TunerEngine* engine READ engine WRITE setEngine NOTIFY engineChanged)
+    Q_PROPERTY(double minFrequency READ minFrequency WRITE setMinFrequency NOTIFY scaleChanged)
+    Q_PROPERTY(double maxFrequency READ maxFrequency WRITE setMaxFrequency NOTIFY scaleChanged)
+    Q_PROPERTY(bool logarithmicScale READ logarithmicScale WRITE setLogarithmicScale NOTIFY scaleChanged)
+    Q_PROPERTY(double dynamicRange READ dynamicRange WRITE setDynamicRange NOTIFY scaleChanged)
+    Q_PROPERTY(int waterfallRows READ waterfallRows WRITE setWaterfallRows NOTIFY waterfallRowsChanged)
+    Q_PROPERTY(double frameTime READ frameTime NOTIFY frameTimeChanged)
+
+public:
+    explicit SpectrumItem(QQuickItem *parent = nullptr);
+
+    TunerEngine* engine() const { return m_engine; }
+    void setEngine(TunerEngine *engine);
+    double minFrequency() const { return m_minFrequency; }
+    void setMinFrequency(double frequency);
+    double maxFrequency() const { return m_maxFrequency; }
+    void setMaxFrequency(double frequency);
+    bool logarithmicScale() const { return m_logarithmicScale; }
+    void setLogarithmicScale(bool enabled);
+    double dynamicRange() const { return m_dynamicRange; }
+    void setDynamicRange(double db);
+    int waterfallRows() const { return m_waterfallRows; }
+    void setWaterfallRows(int rows);
+
+    // Average time spent building the scene graph nodes, in ms
+    double frameTime() const { return m_frameTime; }
+
+signals:
+    void engineChanged();
+    void scaleChanged();
+    void waterfallRowsChanged();
+    void frameTimeChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+
+private slots:
+    void onSpectrumUpdated();
+
+private:
+    static constexpr double WATERFALL_FRACTION = 0.5;  // Share of the height used by the waterfall
+
+    void updateColumnMap(int width, double binWidth);
+    void computeLevels(const SpectrumSnapshot &snapshot, std::vector<float> &levels) const;
+    void rasterizeSpectrum(const std::vector<float> &levels, int height);
+    void scrollWaterfall(const std::vector<float> &levels);
+    void setFrameTime(double ms);
+
+    TunerEngine *m_engine = nullptr;
+    double m_minFrequency = 50.0;
+    double m_maxFrequency = 1100.0;
+    bool m_logarithmicScale = true;
+    double m_dynamicRange = 60.0;
+    int m_waterfallRows = 120;
+
+    // Render-thread state, only touched in updatePaintNode while the GUI thread is blocked
+    std::shared_ptr<const SpectrumSnapshot> m_latest;
+    std::vector<std::shared_ptr<const SpectrumSnapshot>> m_pendingRows;
+    std::vector<int> m_columnBins;
+    int m_mappedWidth = 0;
+    double m_mappedBinWidth = 0.0;
+    bool m_columnMapDirty = true;
+    std::vector<float> m_levels;
+    QImage m_spectrumImage;
+    QImage m_waterfallImage;
+    QRgb m_palette[256];
+
+    QElapsedTimer m_paintTimer;
+    double m_frameTime = 0.0;
+};
+
+#endif // SPECTRUMITEM_H